@@ -0,0 +1,105 @@
+// Per-request lifecycle benchmark: a map is built, queried and then thrown away
+// as a whole, many times over (the typical pattern of a server handling one
+// request or batch at a time).
+//
+//  - std alloc (new map) : a fresh flat_hash_map for each request
+//  - std alloc (reuse)   : one flat_hash_map, clear() between requests
+//  - arena               : arena_flat_hash_map, clear() + arena::reset() between requests
+// -------------------------------------------------------------------------------------------
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "parallel_hashmap/phmap.h"
+
+using phmap::flat_hash_map;
+using phmap::arena_flat_hash_map;
+
+class timer {
+    using clock = std::chrono::high_resolution_clock;
+
+public:
+    timer() : start_(clock::now()) {}
+    double elapsed_ms() const {
+        return std::chrono::duration<double, std::milli>(clock::now() - start_).count();
+    }
+
+private:
+    clock::time_point start_;
+};
+
+// simple xorshift, good enough to produce keys
+static uint64_t next_key(uint64_t& s) {
+    s ^= s << 13;
+    s ^= s >> 7;
+    s ^= s << 17;
+    return s;
+}
+
+template <class Map>
+static uint64_t handle_request(Map& m, size_t num_keys, uint64_t& seed) {
+    uint64_t checksum = 0;
+    uint64_t s = seed;
+    for (size_t i = 0; i < num_keys; ++i)
+        m[next_key(s) % (num_keys * 2)] += 1;
+    for (size_t i = 0; i < num_keys; ++i) {
+        auto it = m.find(next_key(s) % (num_keys * 2));
+        if (it != m.end())
+            checksum += it->second;
+    }
+    seed = s;
+    return checksum + m.size();
+}
+
+static void run(size_t num_keys, size_t num_requests) {
+    uint64_t checksum[3] = { 0, 0, 0 };
+    double   ms[3];
+
+    {
+        uint64_t seed = 0x9E3779B97F4A7C15ull;
+        timer t;
+        for (size_t r = 0; r < num_requests; ++r) {
+            flat_hash_map<uint64_t, uint64_t> m;
+            checksum[0] += handle_request(m, num_keys, seed);
+        }
+        ms[0] = t.elapsed_ms();
+    }
+
+    {
+        uint64_t seed = 0x9E3779B97F4A7C15ull;
+        timer t;
+        flat_hash_map<uint64_t, uint64_t> m;
+        for (size_t r = 0; r < num_requests; ++r) {
+            checksum[1] += handle_request(m, num_keys, seed);
+            m.clear();
+        }
+        ms[1] = t.elapsed_ms();
+    }
+
+    {
+        uint64_t seed = 0x9E3779B97F4A7C15ull;
+        timer t;
+        phmap::arena a;
+        arena_flat_hash_map<uint64_t, uint64_t> m(a);
+        for (size_t r = 0; r < num_requests; ++r) {
+            checksum[2] += handle_request(m, num_keys, seed);
+            m.clear();   // O(1), storage is dropped
+            a.reset();   // memory reused by the next request
+        }
+        ms[2] = t.elapsed_ms();
+    }
+
+    if (checksum[0] != checksum[1] || checksum[0] != checksum[2])
+        printf("checksum mismatch!\n");
+
+    printf("%8zu keys x %7zu requests: std alloc (new map) %8.1f ms, "
+           "std alloc (reuse) %8.1f ms, arena %8.1f ms\n",
+           num_keys, num_requests, ms[0], ms[1], ms[2]);
+}
+
+int main() {
+    const size_t total = 4000000;
+    for (size_t num_keys : { 16, 128, 1024, 16384, 262144 })
+        run(num_keys, total / num_keys);
+    return 0;
+}
@@ -0,0 +1,69 @@
+// Building a parallel_flat_hash_map from a vector of pairs: with the range
+// constructor (one thread, one insertion at a time), with threads inserting
+// concurrently, and with parallel_build().
+//
+// usage: ex_build_bench [num_threads] [num_entries]
+// ------------------------------------------------------------------------------
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "parallel_hashmap/phmap.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ms_since(clk::time_point start) {
+    return std::chrono::duration<double, std::milli>(clk::now() - start).count();
+}
+
+using Map = phmap::parallel_flat_hash_map<uint64_t, uint64_t,
+                                          phmap::priv::hash_default_hash<uint64_t>,
+                                          phmap::priv::hash_default_eq<uint64_t>,
+                                          phmap::priv::Allocator<std::pair<const uint64_t, uint64_t>>,
+                                          6, std::mutex>;
+
+int main(int argc, char** argv) {
+    size_t num_threads = argc > 1 ? (size_t)atoll(argv[1]) : std::thread::hardware_concurrency();
+    size_t num_entries = argc > 2 ? (size_t)atoll(argv[2]) : 10000000;
+    if (num_threads == 0)
+        num_threads = 1;
+
+    std::mt19937_64 gen(5);
+    std::vector<std::pair<uint64_t, uint64_t>> v(num_entries);
+    for (size_t i = 0; i < num_entries; ++i)
+        v[i] = { gen() % (num_entries * 2), i };
+
+    printf("%zu entries, %zu threads\n", num_entries, num_threads);
+
+    auto start = clk::now();
+    {
+        Map m(v.begin(), v.end());
+        printf("range constructor        %8.1f ms   size: %zu\n", ms_since(start), m.size());
+    }
+
+    start = clk::now();
+    {
+        Map m;
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&, t]() {
+                for (size_t i = num_entries * t / num_threads; i < num_entries * (t + 1) / num_threads; ++i)
+                    m.insert(v[i]);
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+        printf("concurrent insert        %8.1f ms   size: %zu\n", ms_since(start), m.size());
+    }
+
+    start = clk::now();
+    {
+        Map m(phmap::parallel_build, v.begin(), v.end(), num_threads);
+        printf("parallel_build           %8.1f ms   size: %zu\n", ms_since(start), m.size());
+    }
+    return 0;
+}
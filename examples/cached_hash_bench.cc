@@ -0,0 +1,77 @@
+// Compares maps caching the hash of their elements (cached_hash_flat_hash_map,
+// cached_hash_node_hash_map) with the regular ones, using long string keys
+// (over 64 bytes, sharing a common prefix so that equality is not cheap).
+//
+//  - insert: filling the map from empty (includes all the resizes)
+//  - hit:    find() of keys present in the map
+//  - miss:   find() of keys not in the map
+//  - copy:   copy construction
+// ------------------------------------------------------------------------------
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "parallel_hashmap/phmap.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ms_since(clk::time_point start) {
+    return std::chrono::duration<double, std::milli>(clk::now() - start).count();
+}
+
+static std::string make_key(size_t i) {
+    std::string s(72, 'k');
+    s += std::to_string(i * 2654435761u);
+    return s;
+}
+
+template <class Map>
+static void bench(const char* name, const std::vector<std::string>& keys,
+                  const std::vector<std::string>& misses) {
+    size_t checksum = 0;
+
+    auto start = clk::now();
+    Map m;
+    for (size_t i = 0; i < keys.size(); ++i)
+        m.emplace(keys[i], i);
+    double insert_ms = ms_since(start);
+
+    start = clk::now();
+    for (auto& k : keys) {
+        auto it = m.find(k);
+        if (it != m.end())
+            checksum += it->second;
+    }
+    double hit_ms = ms_since(start);
+
+    start = clk::now();
+    for (auto& k : misses)
+        checksum += m.count(k);
+    double miss_ms = ms_since(start);
+
+    start = clk::now();
+    Map m2(m);
+    double copy_ms = ms_since(start);
+    checksum += m2.size();
+
+    printf("%-28s insert %7.1f ms   hit %7.1f ms   miss %7.1f ms   copy %7.1f ms   (%zu)\n",
+           name, insert_ms, hit_ms, miss_ms, copy_ms, checksum);
+}
+
+int main() {
+    const size_t num_keys = 2000000;
+    std::vector<std::string> keys, misses;
+    keys.reserve(num_keys);
+    misses.reserve(num_keys);
+    for (size_t i = 0; i < num_keys; ++i) {
+        keys.push_back(make_key(i));
+        misses.push_back(make_key(i + num_keys));
+    }
+
+    bench<phmap::flat_hash_map<std::string, size_t>>("flat_hash_map", keys, misses);
+    bench<phmap::cached_hash_flat_hash_map<std::string, size_t>>("cached_hash_flat_hash_map", keys, misses);
+    bench<phmap::node_hash_map<std::string, size_t>>("node_hash_map", keys, misses);
+    bench<phmap::cached_hash_node_hash_map<std::string, size_t>>("cached_hash_node_hash_map", keys, misses);
+    return 0;
+}
@@ -0,0 +1,112 @@
+// Multi-threaded counting of zipf-distributed keys (a few very hot keys and a
+// long tail) in maps locked with a std::mutex, comparing:
+//
+//  - parallel_flat_hash_map_m::lazy_emplace_l (each thread takes the submap
+//    lock in turn)
+//  - parallel_combining_map::upsert (the thread holding the submap lock
+//    applies the increments posted by the others)
+//  - parallel_combining_map::upsert_async (same, without waiting for the
+//    increment when another thread is applying them)
+//
+// usage: ex_combining_bench [num_threads]
+// ------------------------------------------------------------------------------
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+#include "parallel_hashmap/phmap.h"
+#include "parallel_hashmap/phmap_combining.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ms_since(clk::time_point start) {
+    return std::chrono::duration<double, std::milli>(clk::now() - start).count();
+}
+
+// keys in [0, num_keys), key k drawn with probability proportional to 1/(k+1)
+static std::vector<uint64_t> zipf_keys(size_t count, size_t num_keys, unsigned seed) {
+    std::vector<double> weights(num_keys);
+    for (size_t k = 0; k < num_keys; ++k)
+        weights[k] = 1.0 / double(k + 1);
+    std::discrete_distribution<size_t> dist(weights.begin(), weights.end());
+    std::mt19937_64 gen(seed);
+
+    std::vector<uint64_t> keys(count);
+    for (auto& k : keys)
+        k = dist(gen) * 0x9E3779B97F4A7C15ull;  // spread keys over the submaps
+    return keys;
+}
+
+template <class F>
+static double run_threads(size_t num_threads, F&& f) {
+    auto start = clk::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; ++t)
+        threads.emplace_back(f, t);
+    for (auto& t : threads)
+        t.join();
+    return ms_since(start);
+}
+
+template <class Map>
+static size_t total(const Map& m) {
+    size_t n = 0;
+    for (const auto& p : m)
+        n += p.second;
+    return n;
+}
+
+int main(int argc, char** argv) {
+    size_t num_threads = std::thread::hardware_concurrency();
+    if (argc > 1)
+        num_threads = (size_t)std::atoi(argv[1]);
+    if (num_threads == 0)
+        num_threads = 1;
+
+    const size_t per_thread = 2000000;
+    const size_t num_keys   = 100000;
+
+    std::vector<std::vector<uint64_t>> input(num_threads);
+    for (size_t t = 0; t < num_threads; ++t)
+        input[t] = zipf_keys(per_thread, num_keys, (unsigned)t + 1);
+
+    printf("%zu threads, %zu increments each, %zu distinct keys (zipf)\n",
+           num_threads, per_thread, num_keys);
+
+    {
+        using Map = phmap::parallel_flat_hash_map_m<uint64_t, size_t>;
+        Map m;
+        double ms = run_threads(num_threads, [&](size_t t) {
+            for (auto k : input[t])
+                m.lazy_emplace_l(k,
+                                 [](Map::value_type& v) { ++v.second; },
+                                 [k](const Map::constructor& ctor) { ctor(k, 1); });
+        });
+        printf("%-44s %8.1f ms   size=%zu total=%zu\n", "parallel_flat_hash_map_m lazy_emplace_l", ms,
+               m.size(), total(m));
+    }
+
+    {
+        phmap::parallel_combining_map<uint64_t, size_t> m;
+        double ms = run_threads(num_threads, [&](size_t t) {
+            for (auto k : input[t])
+                m.upsert(k, [](size_t& v) { ++v; });
+        });
+        printf("%-44s %8.1f ms   size=%zu total=%zu\n", "parallel_combining_map upsert", ms,
+               m.size(), total(m));
+    }
+
+    {
+        phmap::parallel_combining_map<uint64_t, size_t> m;
+        double ms = run_threads(num_threads, [&](size_t t) {
+            for (auto k : input[t])
+                m.upsert_async(k, [](size_t& v) { ++v; });
+        });
+        printf("%-44s %8.1f ms   size=%zu total=%zu\n", "parallel_combining_map upsert_async", ms,
+               m.size(), total(m));
+    }
+    return 0;
+}
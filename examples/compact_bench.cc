@@ -0,0 +1,74 @@
+// A session table under random erase/insert churn at a constant size: the
+// tombstones left by erase() are reclaimed by the inserts which run out of
+// room (rehashing a whole submap, or doubling its capacity), or ahead of
+// them by compact_step(), called as a maintenance task once there are more
+// than num_entries / 8. Reports the slowest inserts, the total time and the
+// final capacity.
+//
+// usage: ex_compact_bench [num_entries] [compact: 0|1]
+// ------------------------------------------------------------------------------
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "parallel_hashmap/phmap.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ms_since(clk::time_point start) {
+    return std::chrono::duration<double, std::milli>(clk::now() - start).count();
+}
+
+using Map = phmap::parallel_flat_hash_map<uint64_t, uint64_t,
+                                          phmap::priv::hash_default_hash<uint64_t>,
+                                          phmap::priv::hash_default_eq<uint64_t>,
+                                          phmap::priv::Allocator<std::pair<const uint64_t, uint64_t>>,
+                                          4, std::mutex>;
+
+int main(int argc, char** argv) {
+    size_t num_entries = argc > 1 ? (size_t)atoll(argv[1]) : 1000000;
+    bool   compact     = argc > 2 ? atoi(argv[2]) != 0 : true;
+    const size_t num_ops = num_entries * 10;
+
+    Map m;
+    std::vector<uint64_t> keys(num_entries);
+    for (uint64_t i = 0; i < num_entries; ++i) {
+        m.emplace(i, i);
+        keys[i] = i;
+    }
+    size_t capacity = m.capacity();
+
+    std::mt19937_64 gen(11);
+    std::vector<float> insert_us;
+    insert_us.reserve(num_ops);
+    size_t pos = 0, max_tombstones = 0, num_slow = 0;
+    auto start = clk::now();
+    for (size_t i = 0; i < num_ops; ++i) {
+        uint64_t& k = keys[gen() % num_entries];
+        m.erase(k);
+        k = num_entries + i;
+
+        auto t = clk::now();
+        m.emplace(k, i);
+        insert_us.push_back(std::chrono::duration<float, std::micro>(clk::now() - t).count());
+        num_slow += insert_us.back() > 1000;
+
+        if (i % 4096 == 0) {
+            size_t tombstones = m.tombstones();
+            max_tombstones = (std::max)(max_tombstones, tombstones);
+            if (compact && (pos || tombstones > num_entries / 8))
+                pos = m.compact_step(1, pos);
+        }
+    }
+    double total_ms = ms_since(start);
+
+    std::sort(insert_us.begin(), insert_us.end());
+    printf("%zu entries, %zu ops, %s\n", num_entries, num_ops, compact ? "compact_step" : "no compact_step");
+    printf("insert p99.99: %8.1f us   max: %8.1f us   over 1 ms: %zu   total: %8.1f ms\n",
+           insert_us[insert_us.size() * 9999 / 10000], insert_us.back(), num_slow, total_ms);
+    printf("capacity: %zu -> %zu   max tombstones seen: %zu\n", capacity, m.capacity(), max_tombstones);
+    return 0;
+}
@@ -0,0 +1,107 @@
+// Multi-threaded counting of zipf-distributed keys (a few very hot keys and a
+// long tail), comparing:
+//
+//  - parallel_flat_hash_map_m::lazy_emplace_l (increment under the unique
+//    submap lock)
+//  - parallel_counter_map::add (atomic increment under the shared submap lock)
+//  - parallel_counter_map::add_all (batched per submap)
+//
+// usage: ex_counter_bench [num_threads]
+// ------------------------------------------------------------------------------
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+#include "parallel_hashmap/phmap.h"
+#include "parallel_hashmap/phmap_counter.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ms_since(clk::time_point start) {
+    return std::chrono::duration<double, std::milli>(clk::now() - start).count();
+}
+
+// keys in [0, num_keys), key k drawn with probability proportional to 1/(k+1)
+static std::vector<uint64_t> zipf_keys(size_t count, size_t num_keys, unsigned seed) {
+    std::vector<double> weights(num_keys);
+    for (size_t k = 0; k < num_keys; ++k)
+        weights[k] = 1.0 / double(k + 1);
+    std::discrete_distribution<size_t> dist(weights.begin(), weights.end());
+    std::mt19937_64 gen(seed);
+
+    std::vector<uint64_t> keys(count);
+    for (auto& k : keys)
+        k = dist(gen) * 0x9E3779B97F4A7C15ull;  // spread keys over the submaps
+    return keys;
+}
+
+template <class F>
+static double run_threads(size_t num_threads, F&& f) {
+    auto start = clk::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; ++t)
+        threads.emplace_back(f, t);
+    for (auto& t : threads)
+        t.join();
+    return ms_since(start);
+}
+
+int main(int argc, char** argv) {
+    size_t num_threads = std::thread::hardware_concurrency();
+    if (argc > 1)
+        num_threads = (size_t)std::atoi(argv[1]);
+    if (num_threads == 0)
+        num_threads = 1;
+
+    const size_t per_thread = 2000000;
+    const size_t num_keys   = 100000;
+
+    std::vector<std::vector<uint64_t>> input(num_threads);
+    for (size_t t = 0; t < num_threads; ++t)
+        input[t] = zipf_keys(per_thread, num_keys, (unsigned)t + 1);
+
+    printf("%zu threads, %zu increments each, %zu distinct keys (zipf)\n",
+           num_threads, per_thread, num_keys);
+
+    {
+        using Map = phmap::parallel_flat_hash_map_m<uint64_t, size_t>;
+        Map m;
+        double ms = run_threads(num_threads, [&](size_t t) {
+            for (auto k : input[t])
+                m.lazy_emplace_l(k,
+                                 [](Map::value_type& v) { ++v.second; },
+                                 [k](const Map::constructor& ctor) { ctor(k, 1); });
+        });
+        printf("%-40s %8.1f ms   size=%zu\n", "parallel_flat_hash_map_m lazy_emplace_l", ms, m.size());
+    }
+
+    {
+        phmap::parallel_counter_map<uint64_t, size_t> m;
+        double ms = run_threads(num_threads, [&](size_t t) {
+            for (auto k : input[t])
+                m.add(k);
+        });
+        printf("%-40s %8.1f ms   size=%zu\n", "parallel_counter_map add", ms, m.size());
+    }
+
+    {
+        phmap::parallel_counter_map<uint64_t, size_t> m;
+        const size_t batch = 4096;
+        double ms = run_threads(num_threads, [&](size_t t) {
+            auto& keys = input[t];
+            for (size_t i = 0; i < keys.size(); i += batch)
+                m.add_all(keys.begin() + i, keys.begin() + (std::min)(keys.size(), i + batch));
+        });
+        printf("%-40s %8.1f ms   size=%zu\n", "parallel_counter_map add_all", ms, m.size());
+
+        auto start = clk::now();
+        auto top   = m.top_k(10);
+        printf("%-40s %8.1f ms   top count=%zu\n", "parallel_counter_map top_k(10)", ms_since(start),
+               top.empty() ? size_t(0) : top[0].second);
+    }
+    return 0;
+}
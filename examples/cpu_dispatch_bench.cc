@@ -0,0 +1,81 @@
+// The cost of cleaning up the tombstones of a flat_hash_set<uint64_t>:
+// ConvertDeletedToEmptyAndFullToDeleted() alone on the control bytes of a
+// large table, then a mix of erase() and insert() at a constant size, which
+// calls drop_deletes_without_resize() whenever the table runs out of empty
+// slots.
+//
+// ex_cpu_dispatch_bench_dispatch is built with PHMAP_CPU_DISPATCH=1, and picks
+// the SSSE3 or AVX2 version of the conversion when the cpu has them, while
+// ex_cpu_dispatch_bench uses the SSE2 Group.
+//
+// usage: ex_cpu_dispatch_bench [log2 of the capacity]
+// ------------------------------------------------------------------------------
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "parallel_hashmap/phmap.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ms_since(clk::time_point start) {
+    return std::chrono::duration<double, std::milli>(clk::now() - start).count();
+}
+
+static const char* version() {
+#if PHMAP_HAVE_CPU_DISPATCH
+    using namespace phmap::priv::cpu_dispatch_internal;
+    switch (GetCpuLevel()) {
+    case kCpuAvx2:  return "dispatched, AVX2";
+    case kCpuSsse3: return "dispatched, SSSE3";
+    default:        return "dispatched, SSE2 Group";
+    }
+#elif PHMAP_HAVE_SSSE3
+    return "SSSE3 Group";
+#else
+    return "Group";
+#endif
+}
+
+int main(int argc, char** argv) {
+    using namespace phmap::priv;
+    size_t log2_capacity = argc > 1 ? (size_t)atoll(argv[1]) : 22;
+    size_t capacity      = (size_t(1) << log2_capacity) - 1;
+    printf("capacity: %zu, conversion: %s\n", capacity, version());
+
+    std::mt19937_64 rng(42);
+    {
+        std::vector<ctrl_t> ctrl(capacity + 1 + Group::kWidth);
+        for (size_t i = 0; i != capacity; ++i)
+            ctrl[i] = (rng() & 7) ? static_cast<ctrl_t>(rng() & 0x7f) : static_cast<ctrl_t>(kDeleted);
+        ctrl[capacity] = kSentinel;
+
+        const int rounds = 50;
+        auto start = clk::now();
+        for (int r = 0; r < rounds; ++r)
+            ConvertDeletedToEmptyAndFullToDeleted(ctrl.data(), capacity);
+        printf("ConvertDeletedToEmptyAndFullToDeleted: %7.3f ms\n", ms_since(start) / rounds);
+    }
+    {
+        phmap::flat_hash_set<uint64_t> s;
+        s.reserve(capacity / 2);
+        size_t n = s.capacity() / 2;        // below the 25/32 of drop_deletes
+        std::vector<uint64_t> keys(n);
+        for (auto& k : keys) {
+            k = rng();
+            s.insert(k);
+        }
+        auto start = clk::now();
+        for (size_t i = 0; i < 2 * n; ++i) {
+            uint64_t& k = keys[i % n];
+            s.erase(k);
+            k = rng();
+            s.insert(k);
+        }
+        printf("erase + insert churn:                  %7.1f ms (size %zu, capacity %zu)\n",
+               ms_since(start), s.size(), s.capacity());
+    }
+    return 0;
+}
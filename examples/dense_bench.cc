@@ -0,0 +1,133 @@
+// Compares flat_hash_map and dense_hash_map: memory use, insertion, lookup,
+// and iteration over a full table and over a sparse table (after erasing
+// most of the entries, which doesn't shrink either container).
+//
+// Memory is measured with a counting allocator.
+//
+// usage: ex_dense_bench [num_entries]
+// ------------------------------------------------------------------------------
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "parallel_hashmap/phmap.h"
+#include "parallel_hashmap/phmap_dense.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ms_since(clk::time_point start) {
+    return std::chrono::duration<double, std::milli>(clk::now() - start).count();
+}
+
+static std::atomic<size_t> g_bytes{0};
+
+template <class T>
+struct counting_allocator
+{
+    using value_type = T;
+
+    counting_allocator() {}
+    template <class U> counting_allocator(const counting_allocator<U>&) {}
+
+    T* allocate(size_t n) {
+        g_bytes += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n) {
+        g_bytes -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <class U> bool operator==(const counting_allocator<U>&) const { return true; }
+    template <class U> bool operator!=(const counting_allocator<U>&) const { return false; }
+};
+
+struct payload
+{
+    uint64_t v[4];     // 32 bytes
+};
+
+template <class V>
+static uint64_t sum_of(const V& v) { return v; }
+static uint64_t sum_of(const payload& p) { return p.v[0] + p.v[3]; }
+
+template <class V>
+static V make_value(uint64_t i) { return V(i); }
+template <>
+payload make_value<payload>(uint64_t i) { return payload{{i, 0, 0, i}}; }
+
+template <class Map>
+static void run(const char* name, const std::vector<uint64_t>& keys) {
+    using V = typename Map::mapped_type;
+    size_t base = g_bytes;
+    {
+        Map m;
+        auto start = clk::now();
+        for (auto k : keys)
+            m.emplace(k, make_value<V>(k));
+        double insert_ms = ms_since(start);
+        size_t bytes = g_bytes - base;
+
+        start = clk::now();
+        uint64_t found = 0;
+        for (auto k : keys)
+            found += sum_of(m.find(k)->second);
+        double find_ms = ms_since(start);
+
+        uint64_t sum = 0;
+        start = clk::now();
+        for (int rep = 0; rep < 10; ++rep)
+            for (auto& p : m)
+                sum += sum_of(p.second);
+        double iter_ms = ms_since(start) / 10;
+
+        // keep one entry out of 16
+        start = clk::now();
+        for (size_t i = 0; i < keys.size(); ++i)
+            if (i % 16)
+                m.erase(keys[i]);
+        double erase_ms = ms_since(start);
+
+        uint64_t sparse_sum = 0;
+        start = clk::now();
+        for (int rep = 0; rep < 10; ++rep)
+            for (auto& p : m)
+                sparse_sum += sum_of(p.second);
+        double sparse_ms = ms_since(start) / 10;
+
+        printf("%-36s %7.1f MB  insert %6.1f ms  find %6.1f ms  iterate %6.2f ms  "
+               "erase %6.1f ms  sparse iterate %6.2f ms  (%llu)\n",
+               name, (double)bytes / 1e6, insert_ms, find_ms, iter_ms, erase_ms, sparse_ms,
+               (unsigned long long)((found + sum + sparse_sum) & 0xffff));
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t num_entries = argc > 1 ? (size_t)atoll(argv[1]) : 4000000;
+
+    std::mt19937_64 gen(7);
+    std::vector<uint64_t> keys(num_entries);
+    for (auto& k : keys)
+        k = gen();
+
+    using H  = phmap::Hash<uint64_t>;
+    using Eq = phmap::EqualTo<uint64_t>;
+
+    printf("%zu entries\n", num_entries);
+    run<phmap::flat_hash_map<uint64_t, uint32_t, H, Eq,
+                             counting_allocator<std::pair<const uint64_t, uint32_t>>>>(
+        "flat_hash_map<u64, u32>", keys);
+    run<phmap::dense_hash_map<uint64_t, uint32_t, H, Eq,
+                              counting_allocator<std::pair<const uint64_t, uint32_t>>>>(
+        "dense_hash_map<u64, u32>", keys);
+    run<phmap::flat_hash_map<uint64_t, payload, H, Eq,
+                             counting_allocator<std::pair<const uint64_t, payload>>>>(
+        "flat_hash_map<u64, 32 bytes>", keys);
+    run<phmap::dense_hash_map<uint64_t, payload, H, Eq,
+                              counting_allocator<std::pair<const uint64_t, payload>>>>(
+        "dense_hash_map<u64, 32 bytes>", keys);
+    return 0;
+}
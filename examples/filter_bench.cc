@@ -0,0 +1,86 @@
+// Miss-heavy lookups (90% of the keys looked up are absent, as in a
+// deduplication pipeline) in a parallel_flat_hash_set and in a
+// parallel_filtered_flat_hash_set, both using std::shared_mutex when
+// available.
+//
+// usage: ex_filter_bench [num_threads] [num_keys]
+// ------------------------------------------------------------------------------
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+#include "parallel_hashmap/phmap.h"
+#include "parallel_hashmap/phmap_filter.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ms_since(clk::time_point start) {
+    return std::chrono::duration<double, std::milli>(clk::now() - start).count();
+}
+
+template <class F>
+static double run_threads(size_t num_threads, F&& f) {
+    auto start = clk::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; ++t)
+        threads.emplace_back(f, t);
+    for (auto& t : threads)
+        t.join();
+    return ms_since(start);
+}
+
+template <class Set>
+static void run(const char* name, size_t num_threads, const std::vector<uint64_t>& keys,
+                const std::vector<uint64_t>& queries) {
+    Set s;
+    double insert_ms = run_threads(num_threads, [&](size_t t) {
+        for (size_t i = t; i < keys.size(); i += num_threads)
+            s.insert(keys[i]);
+    });
+
+    std::vector<size_t> found(num_threads);
+    double query_ms = run_threads(num_threads, [&](size_t t) {
+        size_t n = 0;
+        for (size_t i = t; i < queries.size(); i += num_threads)
+            n += s.contains(queries[i]);
+        found[t] = n;
+    });
+    size_t total = 0;
+    for (auto n : found)
+        total += n;
+
+    printf("%-32s insert: %7.1f ms   query: %7.1f ms (%5.1f ns/lookup)   hits: %zu\n",
+           name, insert_ms, query_ms, query_ms * 1e6 / (double)queries.size(), total);
+}
+
+int main(int argc, char** argv) {
+    size_t num_threads = argc > 1 ? (size_t)atoll(argv[1]) : std::thread::hardware_concurrency();
+    size_t num_keys    = argc > 2 ? (size_t)atoll(argv[2]) : 4000000;
+    if (num_threads == 0)
+        num_threads = 1;
+
+    std::mt19937_64 gen(3);
+    std::vector<uint64_t> keys(num_keys);
+    for (auto& k : keys)
+        k = gen();
+
+    // 10% of hits
+    std::vector<uint64_t> queries(4 * num_keys);
+    for (size_t i = 0; i < queries.size(); ++i)
+        queries[i] = (i % 10 == 0) ? keys[gen() % num_keys] : gen();
+
+    using Mutex = phmap::priv::filtered_mutex;
+    using H     = phmap::priv::hash_default_hash<uint64_t>;
+    using Eq    = phmap::priv::hash_default_eq<uint64_t>;
+    using A     = phmap::priv::Allocator<uint64_t>;
+
+    printf("%zu keys, %zu lookups, %zu threads\n", num_keys, queries.size(), num_threads);
+    run<phmap::parallel_flat_hash_set<uint64_t, H, Eq, A, 4, Mutex>>(
+        "parallel_flat_hash_set", num_threads, keys, queries);
+    run<phmap::parallel_filtered_flat_hash_set<uint64_t, H, Eq, A, 4, Mutex>>(
+        "parallel_filtered_flat_hash_set", num_threads, keys, queries);
+    return 0;
+}
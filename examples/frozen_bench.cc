@@ -0,0 +1,74 @@
+// Compares a read-only flat_hash_map with the frozen_hash_map built from it:
+// build time, memory, and lookup time for keys present (hit) and absent (miss).
+//
+// usage: ex_frozen_bench [num_keys]
+// ------------------------------------------------------------------------------
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "parallel_hashmap/phmap.h"
+#include "parallel_hashmap/phmap_frozen.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ms_since(clk::time_point start) {
+    return std::chrono::duration<double, std::milli>(clk::now() - start).count();
+}
+
+template <class Map>
+static void lookups(const char* name, const Map& m, const std::vector<uint64_t>& hits,
+                    const std::vector<uint64_t>& misses) {
+    uint64_t checksum = 0;
+    auto start = clk::now();
+    for (auto k : hits) {
+        auto it = m.find(k);
+        if (it != m.end())
+            checksum += it->second;
+    }
+    double hit_ms = ms_since(start);
+
+    start = clk::now();
+    for (auto k : misses)
+        checksum += m.count(k);
+    double miss_ms = ms_since(start);
+
+    printf("%-16s hit: %7.1f ms   miss: %7.1f ms   (checksum %llu)\n", name, hit_ms, miss_ms,
+           (unsigned long long)checksum);
+}
+
+int main(int argc, char** argv) {
+    size_t n = 5000000;
+    if (argc > 1)
+        n = (size_t)std::atoll(argv[1]);
+
+    std::mt19937_64 gen(17);
+    std::vector<uint64_t> keys(n), misses(n);
+    for (auto& k : keys)
+        k = gen() | 1;
+    for (auto& k : misses)
+        k = gen() & ~uint64_t(1);
+    std::vector<uint64_t> hits = keys;
+    std::shuffle(hits.begin(), hits.end(), gen);
+
+    using Map = phmap::flat_hash_map<uint64_t, uint64_t>;
+    Map m;
+    for (size_t i = 0; i < n; ++i)
+        m.emplace(keys[i], i);
+
+    auto start = clk::now();
+    phmap::frozen_hash_map<uint64_t, uint64_t> f(m);
+    double build_ms = ms_since(start);
+
+    size_t map_bytes = m.capacity() * (sizeof(Map::value_type) + 1);
+    printf("%zu keys\n", n);
+    printf("flat_hash_map:   load factor %.2f, %6.1f MB\n", m.load_factor(), map_bytes / 1e6);
+    printf("frozen_hash_map: built in %.1f ms, %6.1f MB\n", build_ms, f.bytes_used() / 1e6);
+
+    lookups("flat_hash_map", m, hits, misses);
+    lookups("frozen_hash_map", f, hits, misses);
+    return 0;
+}
@@ -0,0 +1,74 @@
+// Lookups in a flat_hash_set<uint64_t> filled to different load factors, up
+// to the maximum of 7/8, with the Group selected at compile time: 16 wide
+// with SSE2 or NEON, 64 wide with AVX-512BW (ex_group_bench_avx512 is built
+// with -mavx512bw), or the 8 wide portable one (ex_group_bench_portable).
+//
+// For each load: the time of successful and unsuccessful finds, and the
+// average and maximum number of groups probed by the successful ones.
+//
+// usage: ex_group_bench [log2 of the capacity]
+// ------------------------------------------------------------------------------
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "parallel_hashmap/phmap.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ns_per(clk::time_point start, size_t n) {
+    return std::chrono::duration<double, std::nano>(clk::now() - start).count() / n;
+}
+
+using Set = phmap::flat_hash_set<uint64_t>;
+
+int main(int argc, char** argv) {
+    size_t log2_capacity = argc > 1 ? (size_t)atoll(argv[1]) : 21;
+    size_t capacity      = (size_t(1) << log2_capacity) - 1;
+    printf("Group::kWidth: %d, capacity: %zu\n", (int)phmap::priv::Group::kWidth, capacity);
+
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> keys(capacity), misses(1000000);
+    for (auto& k : keys)
+        k = rng() | 1;
+    for (auto& k : misses)
+        k = rng() & ~uint64_t(1);
+
+    for (double load : {0.5, 0.75, 0.85, 0.875}) {
+        size_t n = (std::min)((size_t)(capacity * load), capacity - capacity / 8);
+        Set s;
+        s.reserve(n);
+        for (size_t i = 0; i < n; ++i)
+            s.insert(keys[i]);
+        if (s.capacity() != capacity)
+            printf("unexpected capacity %zu\n", s.capacity());
+
+        std::vector<uint64_t> hits(keys.begin(), keys.begin() + n);
+        std::shuffle(hits.begin(), hits.end(), rng);
+
+        size_t found = 0;
+        auto start = clk::now();
+        for (auto k : hits)
+            found += s.contains(k);
+        double hit_ns = ns_per(start, n);
+
+        start = clk::now();
+        for (auto k : misses)
+            found += s.contains(k);
+        double miss_ns = ns_per(start, misses.size());
+
+        size_t total_probes = 0, max_probes = 0;
+        for (auto k : hits) {
+            size_t p = phmap::priv::hashtable_debug_internal::HashtableDebugAccess<Set>::GetNumProbes(s, k);
+            total_probes += p;
+            max_probes = (std::max)(max_probes, p);
+        }
+        printf("load %5.3f   find hit: %6.2f ns   miss: %6.2f ns   probes avg: %6.4f  max: %2zu %s\n",
+               (double)n / capacity, hit_ns, miss_ns, (double)total_probes / n, max_probes,
+               found == n ? "" : "error");
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+// hash_many() against hash() in a loop, on a batch of keys which stays in
+// the L1 cache, then insert(first, last) of a vector of keys, which hashes
+// them with hash_many() a block at a time, against emplace() in a loop.
+//
+// hash_many() is vectorized when AVX2 or AVX-512F is enabled at compile time:
+// ex_hash_many_bench_avx512 is built with -mavx2 -mavx512f.
+//
+// usage: ex_hash_many_bench [num_keys]
+// ------------------------------------------------------------------------------
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "parallel_hashmap/phmap.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ms_since(clk::time_point start) {
+    return std::chrono::duration<double, std::milli>(clk::now() - start).count();
+}
+
+template <class Set>
+static void bench_insert(const char* name, const std::vector<uint64_t>& keys) {
+    double loop_ms, range_ms;
+    {
+        Set s;
+        auto start = clk::now();
+        s.reserve(keys.size());
+        for (auto k : keys)
+            s.emplace(k);
+        loop_ms = ms_since(start);
+    }
+    {
+        Set s;
+        auto start = clk::now();
+        s.insert(keys.begin(), keys.end());
+        range_ms = ms_since(start);
+    }
+    printf("%-24s emplace loop: %7.1f ms   insert(first, last): %7.1f ms\n", name, loop_ms, range_ms);
+}
+
+int main(int argc, char** argv) {
+    size_t num_keys = argc > 1 ? (size_t)atoll(argv[1]) : 4000000;
+    printf("%s\n",
+#if PHMAP_HAVE_AVX512F
+           "hash_many: AVX-512F"
+#elif PHMAP_HAVE_AVX2
+           "hash_many: AVX2"
+#else
+           "hash_many: scalar"
+#endif
+        );
+
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> keys(num_keys);
+    for (auto& k : keys)
+        k = rng();
+
+    {
+        const size_t batch = 1024, rounds = 20000;
+        phmap::flat_hash_set<uint64_t> s;
+        std::vector<size_t> hashes(batch);
+        size_t x = 0;
+
+        auto start = clk::now();
+        for (size_t r = 0; r < rounds; ++r) {
+            for (size_t i = 0; i < batch; ++i)
+                hashes[i] = s.hash(keys[i] + r);
+            x += hashes[r % batch];
+        }
+        double loop_ns = ms_since(start) * 1e6 / (batch * rounds);
+
+        start = clk::now();
+        for (size_t r = 0; r < rounds; ++r) {
+            keys[0] += 1;          // so the compiler can't hoist the loop
+            s.hash_many(keys.data(), batch, hashes.data());
+            x += hashes[r % batch];
+        }
+        double many_ns = ms_since(start) * 1e6 / (batch * rounds);
+        printf("hash() loop: %5.3f ns/key   hash_many(): %5.3f ns/key   (%zx)\n", loop_ns, many_ns, x & 0xf);
+    }
+
+    bench_insert<phmap::flat_hash_set<uint64_t>>("flat_hash_set", keys);
+    bench_insert<phmap::parallel_flat_hash_set<uint64_t>>("parallel_flat_hash_set", keys);
+    return 0;
+}
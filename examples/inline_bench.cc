@@ -0,0 +1,107 @@
+// Compares phmap::inline_flat_hash_map with phmap::flat_hash_map for many
+// tiny maps (think per-object attribute bags), for sizes 0 to 32:
+//
+//  - memory: bytes per map, sizeof(map) + heap allocations
+//  - build:  ns to create and fill one map
+//  - lookup: ns per find() (half hits, half misses), over all the maps
+// ------------------------------------------------------------------------
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "parallel_hashmap/phmap.h"
+
+static size_t allocated_bytes = 0;
+
+// std::allocator which keeps track of the allocated bytes
+template <class T>
+struct CountingAlloc : std::allocator<T> {
+    template <class U> struct rebind { using other = CountingAlloc<U>; };
+
+    CountingAlloc() = default;
+    template <class U> CountingAlloc(const CountingAlloc<U>&) {}
+
+    T* allocate(size_t n) {
+        allocated_bytes += n * sizeof(T);
+        return std::allocator<T>::allocate(n);
+    }
+    void deallocate(T* p, size_t n) {
+        allocated_bytes -= n * sizeof(T);
+        std::allocator<T>::deallocate(p, n);
+    }
+};
+
+template <class U, class V>
+bool operator==(const CountingAlloc<U>&, const CountingAlloc<V>&) { return true; }
+template <class U, class V>
+bool operator!=(const CountingAlloc<U>&, const CountingAlloc<V>&) { return false; }
+
+using Hash  = phmap::Hash<uint32_t>;
+using Eq    = phmap::EqualTo<uint32_t>;
+using Alloc = CountingAlloc<std::pair<const uint32_t, uint32_t>>;
+
+using FlatMap     = phmap::flat_hash_map<uint32_t, uint32_t, Hash, Eq, Alloc>;
+using InlineMap8  = phmap::inline_flat_hash_map<uint32_t, uint32_t, 8, Hash, Eq, Alloc>;
+using InlineMap16 = phmap::inline_flat_hash_map<uint32_t, uint32_t, 16, Hash, Eq, Alloc>;
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ns_since(clk::time_point start, size_t ops) {
+    return std::chrono::duration<double, std::nano>(clk::now() - start).count() / (double)ops;
+}
+
+struct Result {
+    double bytes_per_map;
+    double build_ns;
+    double lookup_ns;
+};
+
+template <class Map>
+static Result bench(size_t size, size_t num_maps, uint64_t& checksum) {
+    Result res;
+    size_t before = allocated_bytes;
+
+    auto start = clk::now();
+    std::unique_ptr<std::vector<Map>> maps(new std::vector<Map>(num_maps));
+    for (size_t m = 0; m < num_maps; ++m) {
+        Map& map = (*maps)[m];
+        for (size_t i = 0; i < size; ++i)
+            map.emplace(static_cast<uint32_t>(m * 7 + i * 2), static_cast<uint32_t>(i));
+    }
+    res.build_ns = ns_since(start, num_maps);
+    res.bytes_per_map = sizeof(Map) + (double)(allocated_bytes - before) / (double)num_maps;
+
+    const size_t lookups = 8;
+    start = clk::now();
+    for (size_t m = 0; m < num_maps; ++m) {
+        const Map& map = (*maps)[m];
+        for (size_t i = 0; i < lookups; ++i) {
+            // even keys are present (when i < size), odd keys are misses
+            auto it = map.find(static_cast<uint32_t>(m * 7 + i));
+            if (it != map.end())
+                checksum += it->second;
+        }
+    }
+    res.lookup_ns = ns_since(start, num_maps * lookups);
+    return res;
+}
+
+int main() {
+    const size_t num_maps = 200000;
+    uint64_t checksum = 0;
+
+    printf("size | bytes/map: flat  inline8 inline16 | build ns: flat  inline8 inline16 | lookup ns: flat inline8 inline16\n");
+    for (size_t size = 0; size <= 32; size += (size < 8 ? 1 : 4)) {
+        Result f   = bench<FlatMap>(size, num_maps, checksum);
+        Result i8  = bench<InlineMap8>(size, num_maps, checksum);
+        Result i16 = bench<InlineMap16>(size, num_maps, checksum);
+        printf("%4zu |          %6.0f %6.0f %6.0f   |          %6.1f %6.1f %6.1f   |          %5.2f %5.2f %5.2f\n",
+               size,
+               f.bytes_per_map, i8.bytes_per_map, i16.bytes_per_map,
+               f.build_ns, i8.build_ns, i16.build_ns,
+               f.lookup_ns, i8.lookup_ns, i16.lookup_ns);
+    }
+    printf("checksum: %llu\n", (unsigned long long)checksum);
+    return 0;
+}
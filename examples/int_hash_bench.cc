@@ -0,0 +1,114 @@
+// Compares phmap::Hash and phmap::HwHash on integer keys with different
+// structures: insert and lookup times, and the average and maximum number of
+// probes needed to find a key.
+//
+// The last line times a map keyed by std::pair, which is hashed with
+// HashState::combine. Its hardware version is selected by PHMAP_USE_HW_HASH,
+// so compare ex_int_hash_bench against ex_int_hash_bench_hw.
+//
+// hw_mix64() uses AES-NI or SSE4.2 only when they are enabled at compile time
+// (e.g. -maes -msse4.2, or -march=native), otherwise a portable finalizer.
+//
+// usage: ex_int_hash_bench [num_keys]
+// ------------------------------------------------------------------------------
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+#include "parallel_hashmap/phmap.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ms_since(clk::time_point start) {
+    return std::chrono::duration<double, std::milli>(clk::now() - start).count();
+}
+
+static const char* hw_mix64_impl() {
+#if PHMAP_HAVE_AESNI
+    return "AES-NI";
+#elif PHMAP_HAVE_SSE42
+    return "SSE4.2 crc32";
+#else
+    return "portable";
+#endif
+}
+
+template <class Hash>
+static void run(const char* pattern, const char* hash_name, const std::vector<uint64_t>& keys) {
+    using Set = phmap::flat_hash_set<uint64_t, Hash>;
+    Set s;
+
+    auto start = clk::now();
+    for (auto k : keys)
+        s.insert(k);
+    double insert_ms = ms_since(start);
+
+    start = clk::now();
+    size_t found = 0;
+    for (int i = 0; i < 4; ++i)
+        for (auto k : keys)
+            found += s.contains(k);
+    double find_ms = ms_since(start) / 4;
+
+    size_t total_probes = 0, max_probes = 0;
+    for (auto k : keys) {
+        size_t n = phmap::priv::hashtable_debug_internal::HashtableDebugAccess<Set>::GetNumProbes(s, k);
+        total_probes += n;
+        max_probes = (std::max)(max_probes, n);
+    }
+    printf("%-10s %-7s insert: %7.1f ms   find: %7.1f ms   probes avg: %5.3f  max: %3zu %s\n",
+           pattern, hash_name, insert_ms, find_ms, (double)total_probes / keys.size(), max_probes,
+           found == 4 * keys.size() ? "" : "error");
+}
+
+int main(int argc, char** argv) {
+    size_t num_keys = argc > 1 ? (size_t)atoll(argv[1]) : 2000000;
+    printf("%zu keys, hw_mix64: %s, PHMAP_USE_HW_HASH: %s\n", num_keys, hw_mix64_impl(),
+#ifdef PHMAP_USE_HW_HASH
+           "yes"
+#else
+           "no"
+#endif
+        );
+
+    std::vector<uint64_t> keys(num_keys);
+    auto bench = [&](const char* pattern) {
+        run<phmap::Hash<uint64_t>>(pattern, "Hash", keys);
+        run<phmap::HwHash<uint64_t>>(pattern, "HwHash", keys);
+    };
+
+    for (size_t i = 0; i < num_keys; ++i)
+        keys[i] = i;
+    bench("sequential");
+
+    for (size_t i = 0; i < num_keys; ++i)
+        keys[i] = 0x7f0000000000ULL + i * 64;          // like pointers to 64 byte objects
+    bench("stride 64");
+
+    for (size_t i = 0; i < num_keys; ++i)
+        keys[i] = (uint64_t)i << 32;                   // only the high bits change
+    bench("high bits");
+
+    std::mt19937_64 rng(42);
+    for (auto& k : keys)
+        k = rng();
+    bench("random");
+
+    {
+        phmap::flat_hash_map<std::pair<uint32_t, uint32_t>, uint32_t> m;
+        auto start = clk::now();
+        for (uint32_t i = 0; i < num_keys; ++i)
+            m.emplace(std::make_pair(i >> 10, i & 1023), i);
+        double insert_ms = ms_since(start);
+        start = clk::now();
+        size_t found = 0;
+        for (uint32_t i = 0; i < num_keys; ++i)
+            found += m.contains(std::make_pair(i >> 10, i & 1023));
+        printf("pair<uint32_t, uint32_t>  insert: %7.1f ms   find: %7.1f ms %s\n",
+               insert_ms, ms_since(start), found == num_keys ? "" : "error");
+    }
+    return 0;
+}
@@ -0,0 +1,131 @@
+// Lookups of random keys, half of them missing, in a flat_hash_map<uint64_t,
+// uint64_t> much larger than the cache: a loop calling find(), the same loop
+// with prefetch() a few keys ahead, and for_each_lookup() with several group
+// sizes. Then for_each_lookup() on parallel_flat_hash_maps, with and without
+// a mutex, and the same lookups in a small table which fits in the cache.
+//
+// usage: ex_lookup_bench [log2 of the size]
+// ------------------------------------------------------------------------------
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <vector>
+#include "parallel_hashmap/phmap.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ms_since(clk::time_point start) {
+    return std::chrono::duration<double, std::milli>(clk::now() - start).count();
+}
+
+// keys[i] is in the map when i is even
+static std::vector<uint64_t> make_keys(size_t n) {
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> keys(2 * n);
+    for (auto& k : keys)
+        k = rng();
+    return keys;
+}
+
+template <class Map>
+static void fill(Map& m, const std::vector<uint64_t>& keys) {
+    m.reserve(keys.size() / 2);
+    for (size_t i = 0; i < keys.size(); i += 2)
+        m.emplace(keys[i], i);
+}
+
+static std::vector<uint64_t> shuffled(std::vector<uint64_t> keys) {
+    std::shuffle(keys.begin(), keys.end(), std::mt19937_64(7));
+    return keys;
+}
+
+static void report(const char* name, double ms, size_t n, uint64_t sum) {
+    printf("%-34s %8.1f ms  %6.1f ns/lookup  (%llu)\n", name, ms, ms * 1e6 / n,
+           (unsigned long long)sum);
+}
+
+template <class Map>
+static void run_find(const Map& m, const std::vector<uint64_t>& lookups) {
+    uint64_t sum   = 0;
+    auto     start = clk::now();
+    for (uint64_t k : lookups) {
+        auto it = m.find(k);
+        if (it != m.end())
+            sum += it->second;
+    }
+    report("find()", ms_since(start), lookups.size(), sum);
+
+    const size_t ahead = 8;
+    sum   = 0;
+    start = clk::now();
+    for (size_t i = 0; i < lookups.size(); ++i) {
+        if (i + ahead < lookups.size())
+            m.prefetch(lookups[i + ahead]);
+        auto it = m.find(lookups[i]);
+        if (it != m.end())
+            sum += it->second;
+    }
+    report("find() + prefetch() 8 ahead", ms_since(start), lookups.size(), sum);
+}
+
+template <class Map>
+static void run_for_each_lookup(const char* name, const Map& m, const std::vector<uint64_t>& lookups,
+                                size_t group_size) {
+    uint64_t sum   = 0;
+    auto     start = clk::now();
+    m.for_each_lookup(lookups, [&](const uint64_t&, const typename Map::value_type* p) {
+        if (p)
+            sum += p->second;
+    }, group_size);
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%s, group of %zu", name, group_size);
+    report(buf, ms_since(start), lookups.size(), sum);
+}
+
+int main(int argc, char** argv) {
+    size_t log2_size = argc > 1 ? (size_t)atoll(argv[1]) : 23;
+    size_t n         = size_t(1) << log2_size;
+
+    std::vector<uint64_t> keys    = make_keys(n);
+    std::vector<uint64_t> lookups = shuffled(keys);
+    {
+        phmap::flat_hash_map<uint64_t, uint64_t> m;
+        fill(m, keys);
+        printf("flat_hash_map, size %zu, %zu lookups\n", m.size(), lookups.size());
+        run_find(m, lookups);
+        for (size_t g : {4, 8, 16, 32, 64})
+            run_for_each_lookup("for_each_lookup()", m, lookups, g);
+    }
+    {
+        phmap::parallel_flat_hash_map<uint64_t, uint64_t> m;
+        fill(m, keys);
+        printf("\nparallel_flat_hash_map\n");
+        run_find(m, lookups);
+        run_for_each_lookup("for_each_lookup()", m, lookups, 32);
+    }
+    {
+        phmap::parallel_flat_hash_map<uint64_t, uint64_t, phmap::priv::hash_default_hash<uint64_t>,
+                                      phmap::priv::hash_default_eq<uint64_t>,
+                                      std::allocator<std::pair<const uint64_t, uint64_t>>, 4, std::mutex> m;
+        fill(m, keys);
+        printf("\nparallel_flat_hash_map with std::mutex\n");
+        run_find(m, lookups);
+        run_for_each_lookup("for_each_lookup()", m, lookups, 32);
+    }
+    {
+        std::vector<uint64_t> small_keys    = make_keys(4096);
+        std::vector<uint64_t> small_lookups = shuffled(small_keys);
+        for (int i = 0; i < 10; ++i)
+            small_lookups.insert(small_lookups.end(), small_lookups.begin(), small_lookups.begin() + 8192);
+        phmap::flat_hash_map<uint64_t, uint64_t> m;
+        fill(m, small_keys);
+        printf("\nflat_hash_map, size %zu, in the cache\n", m.size());
+        run_find(m, small_lookups);
+        run_for_each_lookup("for_each_lookup()", m, small_lookups, 32);
+    }
+    return 0;
+}
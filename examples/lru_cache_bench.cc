@@ -0,0 +1,138 @@
+// Multi-threaded cache lookups of zipf-distributed keys, comparing:
+//
+//  - a classic LRU cache: flat_hash_map + std::list, under one global mutex
+//  - phmap::parallel_lru_cache (CLOCK eviction, sharded, shared lock on hits)
+//
+// Each lookup which misses inserts the key (evicting when full). Both caches
+// hold the same number of entries, so the hit ratios are comparable.
+//
+// usage: ex_lru_cache_bench [num_threads]
+// ------------------------------------------------------------------------------
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "parallel_hashmap/phmap.h"
+#include "parallel_hashmap/phmap_lru_cache.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ms_since(clk::time_point start) {
+    return std::chrono::duration<double, std::milli>(clk::now() - start).count();
+}
+
+// keys in [0, num_keys), key k drawn with probability proportional to 1/(k+1)
+static std::vector<uint64_t> zipf_keys(size_t count, size_t num_keys, unsigned seed) {
+    std::vector<double> weights(num_keys);
+    for (size_t k = 0; k < num_keys; ++k)
+        weights[k] = 1.0 / double(k + 1);
+    std::discrete_distribution<size_t> dist(weights.begin(), weights.end());
+    std::mt19937_64 gen(seed);
+
+    std::vector<uint64_t> keys(count);
+    for (auto& k : keys)
+        k = dist(gen) * 0x9E3779B97F4A7C15ull;
+    return keys;
+}
+
+class locked_lru_cache
+{
+public:
+    explicit locked_lru_cache(size_t max_entries) : max_entries_(max_entries) {}
+
+    template <class F>
+    uint64_t get_or_compute(uint64_t key, F&& fn) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        auto it = map_.find(key);
+        if (it != map_.end()) {
+            ++hits_;
+            lru_.splice(lru_.begin(), lru_, it->second);
+            return it->second->second;
+        }
+        if (map_.size() >= max_entries_) {
+            map_.erase(lru_.back().first);
+            lru_.pop_back();
+        }
+        lru_.emplace_front(key, fn(key));
+        map_.emplace(key, lru_.begin());
+        return lru_.front().second;
+    }
+
+    size_t hits() const { return hits_; }
+
+private:
+    using entry_list = std::list<std::pair<uint64_t, uint64_t>>;
+
+    size_t     max_entries_;
+    size_t     hits_ = 0;
+    std::mutex mutex_;
+    entry_list lru_;
+    phmap::flat_hash_map<uint64_t, entry_list::iterator> map_;
+};
+
+template <class F>
+static double run_threads(size_t num_threads, F&& f) {
+    auto start = clk::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; ++t)
+        threads.emplace_back(f, t);
+    for (auto& t : threads)
+        t.join();
+    return ms_since(start);
+}
+
+int main(int argc, char** argv) {
+    size_t num_threads = std::thread::hardware_concurrency();
+    if (argc > 1)
+        num_threads = (size_t)std::atoi(argv[1]);
+    if (num_threads == 0)
+        num_threads = 1;
+
+    const size_t per_thread  = 2000000;
+    const size_t num_keys    = 1000000;
+    const size_t max_entries = 50000;
+    const size_t total       = num_threads * per_thread;
+
+    std::vector<std::vector<uint64_t>> input(num_threads);
+    for (size_t t = 0; t < num_threads; ++t)
+        input[t] = zipf_keys(per_thread, num_keys, (unsigned)t + 1);
+
+    printf("%zu threads, %zu lookups each, %zu distinct keys (zipf), %zu cache entries\n",
+           num_threads, per_thread, num_keys, max_entries);
+
+    auto compute = [](uint64_t k) { return k ^ (k >> 7); };
+    std::atomic<uint64_t> checksum{0};
+
+    {
+        locked_lru_cache c(max_entries);
+        double ms = run_threads(num_threads, [&](size_t t) {
+            uint64_t sum = 0;
+            for (auto k : input[t])
+                sum += c.get_or_compute(k, compute);
+            checksum += sum;
+        });
+        printf("%-36s %8.1f ms   hit ratio=%.3f\n", "flat_hash_map + std::list + mutex", ms,
+               double(c.hits()) / double(total));
+    }
+
+    {
+        phmap::parallel_lru_cache<uint64_t, uint64_t> c(max_entries);
+        double ms = run_threads(num_threads, [&](size_t t) {
+            uint64_t sum = 0;
+            for (auto k : input[t])
+                sum += c.get_or_compute(k, compute);
+            checksum += sum;
+        });
+        auto s = c.stats();
+        printf("%-36s %8.1f ms   hit ratio=%.3f  evictions=%zu\n", "parallel_lru_cache", ms,
+               double(s.hits) / double(total), s.evictions);
+    }
+
+    printf("checksum: %llu\n", (unsigned long long)checksum.load());
+    return 0;
+}
@@ -0,0 +1,203 @@
+// Inverted index workload (term -> ids of the documents containing it),
+// comparing the usual flat_hash_map<K, std::vector<V>> with
+// flat_hash_multimap<K, V>, and their parallel versions built from several
+// threads.
+//
+// Memory is measured with a counting allocator, used for the maps and for
+// the vectors of values. It does not include the malloc overhead of each
+// allocation, so it underestimates the cost of the vectors.
+//
+// usage: ex_multimap_bench [num_threads]
+// ------------------------------------------------------------------------------
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+#include "parallel_hashmap/phmap.h"
+#include "parallel_hashmap/phmap_multimap.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ms_since(clk::time_point start) {
+    return std::chrono::duration<double, std::milli>(clk::now() - start).count();
+}
+
+static std::atomic<size_t> g_bytes{0};
+
+template <class T>
+struct counting_allocator
+{
+    using value_type = T;
+
+    counting_allocator() {}
+    template <class U> counting_allocator(const counting_allocator<U>&) {}
+
+    T* allocate(size_t n) {
+        g_bytes += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n) {
+        g_bytes -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <class U> bool operator==(const counting_allocator<U>&) const { return true; }
+    template <class U> bool operator!=(const counting_allocator<U>&) const { return false; }
+};
+
+using term_t  = uint32_t;
+using doc_t   = uint32_t;
+using posting = std::pair<term_t, doc_t>;
+using Hash    = phmap::Hash<term_t>;
+using Eq      = phmap::EqualTo<term_t>;
+using Postings = std::vector<doc_t, counting_allocator<doc_t>>;
+
+// num_docs documents of terms_per_doc terms, drawn from a zipf distribution
+static std::vector<posting> make_corpus(size_t num_docs, size_t terms_per_doc, size_t vocabulary) {
+    std::vector<double> weights(vocabulary);
+    for (size_t k = 0; k < vocabulary; ++k)
+        weights[k] = 1.0 / double(k + 1);
+    std::discrete_distribution<term_t> dist(weights.begin(), weights.end());
+    std::mt19937 gen(5);
+
+    std::vector<posting> res;
+    res.reserve(num_docs * terms_per_doc);
+    for (doc_t d = 0; d < num_docs; ++d)
+        for (size_t t = 0; t < terms_per_doc; ++t)
+            res.emplace_back(dist(gen), d);
+    return res;
+}
+
+static void report(const char* name, double build_ms, size_t bytes, double query_ms, size_t checksum) {
+    printf("%-38s build: %7.1f ms   memory: %6.1f MB   query: %6.1f ms   (%zu)\n",
+           name, build_ms, (double)bytes / 1e6, query_ms, checksum);
+}
+
+template <class F>
+static double run_threads(size_t num_threads, F&& f) {
+    auto start = clk::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; ++t)
+        threads.emplace_back(f, t);
+    for (auto& t : threads)
+        t.join();
+    return ms_since(start);
+}
+
+int main(int argc, char** argv) {
+    size_t num_threads = std::thread::hardware_concurrency();
+    if (argc > 1)
+        num_threads = (size_t)std::atoi(argv[1]);
+    if (num_threads == 0)
+        num_threads = 1;
+
+    const size_t vocabulary = 500000;
+    auto corpus = make_corpus(200000, 50, vocabulary);
+
+    std::vector<term_t> queries(1000000);
+    std::mt19937 gen(11);
+    for (auto& q : queries)
+        q = term_t(gen() % vocabulary);
+
+    printf("%zu postings, %zu terms vocabulary, %zu queries\n", corpus.size(), vocabulary, queries.size());
+
+    {
+        using Map = phmap::flat_hash_map<term_t, Postings, Hash, Eq,
+                                         counting_allocator<std::pair<const term_t, Postings>>>;
+        size_t before = g_bytes;
+        auto start = clk::now();
+        Map m;
+        for (auto& p : corpus)
+            m[p.first].push_back(p.second);
+        double build_ms = ms_since(start);
+        size_t bytes = g_bytes - before;
+
+        size_t checksum = 0;
+        start = clk::now();
+        for (auto q : queries) {
+            auto it = m.find(q);
+            if (it != m.end())
+                for (auto d : it->second)
+                    checksum += d;
+        }
+        report("flat_hash_map<K, vector<V>>", build_ms, bytes, ms_since(start), checksum);
+    }
+
+    {
+        using Map = phmap::flat_hash_multimap<term_t, doc_t, Hash, Eq,
+                                              counting_allocator<std::pair<const term_t, doc_t>>>;
+        size_t before = g_bytes;
+        auto start = clk::now();
+        Map m;
+        for (auto& p : corpus)
+            m.insert(p.first, p.second);
+        double build_ms = ms_since(start);
+        size_t bytes = g_bytes - before;
+
+        size_t checksum = 0;
+        start = clk::now();
+        for (auto q : queries) {
+            auto r = m.equal_range(q);
+            for (auto it = r.first; it != r.second; ++it)
+                checksum += *it;
+        }
+        report("flat_hash_multimap<K, V>", build_ms, bytes, ms_since(start), checksum);
+    }
+
+    printf("--- parallel build, %zu threads\n", num_threads);
+    size_t per_thread = (corpus.size() + num_threads - 1) / num_threads;
+    auto slice = [&](size_t t) {
+        size_t b = (std::min)(corpus.size(), t * per_thread);
+        return std::make_pair(corpus.begin() + (ptrdiff_t)b,
+                              corpus.begin() + (ptrdiff_t)(std::min)(corpus.size(), b + per_thread));
+    };
+
+    {
+        using Map = phmap::parallel_flat_hash_map<term_t, Postings, Hash, Eq,
+                        counting_allocator<std::pair<const term_t, Postings>>, 4, std::mutex>;
+        size_t before = g_bytes;
+        Map m;
+        double build_ms = run_threads(num_threads, [&](size_t t) {
+            auto r = slice(t);
+            for (auto it = r.first; it != r.second; ++it) {
+                doc_t d = it->second;
+                m.lazy_emplace_l(it->first,
+                                 [d](Map::value_type& v) { v.second.push_back(d); },
+                                 [&](const Map::constructor& ctor) { ctor(it->first, Postings(1, d)); });
+            }
+        });
+        size_t bytes = g_bytes - before;
+
+        size_t checksum = 0;
+        auto start = clk::now();
+        for (auto q : queries)
+            m.if_contains(q, [&](const Map::value_type& v) {
+                for (auto d : v.second)
+                    checksum += d;
+            });
+        report("parallel_flat_hash_map<K, vector<V>>", build_ms, bytes, ms_since(start), checksum);
+    }
+
+    {
+        using Map = phmap::parallel_flat_hash_multimap<term_t, doc_t, Hash, Eq,
+                        counting_allocator<std::pair<const term_t, doc_t>>, 4, std::mutex>;
+        size_t before = g_bytes;
+        Map m;
+        double build_ms = run_threads(num_threads, [&](size_t t) {
+            auto r = slice(t);
+            for (auto it = r.first; it != r.second; ++it)
+                m.insert(it->first, it->second);
+        });
+        size_t bytes = g_bytes - before;
+
+        size_t checksum = 0;
+        auto start = clk::now();
+        for (auto q : queries)
+            m.for_each_of(q, [&](doc_t d) { checksum += d; });
+        report("parallel_flat_hash_multimap<K, V>", build_ms, bytes, ms_since(start), checksum);
+    }
+    return 0;
+}
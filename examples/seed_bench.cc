@@ -0,0 +1,70 @@
+// Insert, find and miss timings of a flat_hash_map<uint64_t, uint64_t> and a
+// flat_hash_map<std::string, uint64_t>. Built twice, as ex_seed_bench and as
+// ex_seed_bench_seeded with PHMAP_SEEDED_HASH defined, to measure the cost
+// of the per-process hash seed.
+//
+// usage: ex_seed_bench [num_keys]
+// ------------------------------------------------------------------------------
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "parallel_hashmap/phmap.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ms_since(clk::time_point start) {
+    return std::chrono::duration<double, std::milli>(clk::now() - start).count();
+}
+
+template <class Map, class Key>
+static void run(const char* name, const std::vector<Key>& keys, const std::vector<Key>& misses) {
+    double insert_ms = 1e9, find_ms = 1e9, miss_ms = 1e9;
+    size_t found = 0;
+    for (int rep = 0; rep < 3; ++rep) {   // keep the best of 3
+        Map m;
+        auto start = clk::now();
+        for (size_t i = 0; i < keys.size(); ++i)
+            m.emplace(keys[i], i);
+        insert_ms = (std::min)(insert_ms, ms_since(start));
+
+        start = clk::now();
+        for (const auto& k : keys)
+            found += m.count(k);
+        find_ms = (std::min)(find_ms, ms_since(start));
+
+        start = clk::now();
+        for (const auto& k : misses)
+            found += m.count(k);
+        miss_ms = (std::min)(miss_ms, ms_since(start));
+    }
+    printf("%-8s insert: %7.1f ms   find: %7.1f ms   miss: %7.1f ms   (%zu)\n",
+           name, insert_ms, find_ms, miss_ms, found);
+}
+
+int main(int argc, char** argv) {
+    size_t num_keys = argc > 1 ? (size_t)atoll(argv[1]) : 2000000;
+
+#ifdef PHMAP_SEEDED_HASH
+    printf("PHMAP_SEEDED_HASH, seed %zx\n", phmap::priv::ProcessHashSeed());
+#else
+    printf("no hash seed\n");
+#endif
+
+    std::mt19937_64 gen(3);
+    std::vector<uint64_t> ints(num_keys), int_misses(num_keys);
+    std::vector<std::string> strs(num_keys), str_misses(num_keys);
+    for (size_t i = 0; i < num_keys; ++i) {
+        ints[i]       = gen();
+        int_misses[i] = gen();
+        strs[i]       = "session-" + std::to_string(ints[i]);
+        str_misses[i] = "session-" + std::to_string(int_misses[i]);
+    }
+
+    run<phmap::flat_hash_map<uint64_t, uint64_t>>("uint64", ints, int_misses);
+    run<phmap::flat_hash_map<std::string, uint64_t>>("string", strs, str_misses);
+    return 0;
+}
@@ -0,0 +1,67 @@
+// merge() and set algebra between two parallel_flat_hash_sets of the same
+// type: merge() against parallel_merge(), and an intersection done with
+// erase_if() and contains() against set_intersection().
+//
+// usage: ex_set_ops_bench [num_threads] [num_keys]
+// ------------------------------------------------------------------------------
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include "parallel_hashmap/phmap.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ms_since(clk::time_point start) {
+    return std::chrono::duration<double, std::milli>(clk::now() - start).count();
+}
+
+using Set = phmap::parallel_flat_hash_set<uint64_t,
+                                          phmap::priv::hash_default_hash<uint64_t>,
+                                          phmap::priv::hash_default_eq<uint64_t>,
+                                          phmap::priv::Allocator<uint64_t>,
+                                          6, std::mutex>;
+
+int main(int argc, char** argv) {
+    size_t num_threads = argc > 1 ? (size_t)atoll(argv[1]) : std::thread::hardware_concurrency();
+    size_t num_keys    = argc > 2 ? (size_t)atoll(argv[2]) : 5000000;
+    if (num_threads == 0)
+        num_threads = 1;
+
+    // a = [0, num_keys), b = [num_keys / 2, num_keys * 3 / 2)
+    Set a, b;
+    a.reserve(num_keys);
+    b.reserve(num_keys);
+    for (uint64_t i = 0; i < num_keys; ++i) {
+        a.insert(i);
+        b.insert(i + num_keys / 2);
+    }
+    printf("%zu keys in each set, %zu threads\n", num_keys, num_threads);
+
+    {
+        Set x = a, y = b;
+        auto start = clk::now();
+        x.merge(y);
+        printf("merge               %8.1f ms   size: %zu\n", ms_since(start), x.size());
+    }
+    {
+        Set x = a, y = b;
+        auto start = clk::now();
+        x.parallel_merge(y, num_threads);
+        printf("parallel_merge      %8.1f ms   size: %zu\n", ms_since(start), x.size());
+    }
+    {
+        Set x = a;
+        auto start = clk::now();
+        phmap::erase_if(x, [&](uint64_t k) { return !b.contains(k); });
+        printf("erase_if/contains   %8.1f ms   size: %zu\n", ms_since(start), x.size());
+    }
+    {
+        Set x = a;
+        auto start = clk::now();
+        x.set_intersection(b, num_threads);
+        printf("set_intersection    %8.1f ms   size: %zu\n", ms_since(start), x.size());
+    }
+    return 0;
+}
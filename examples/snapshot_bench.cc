@@ -0,0 +1,71 @@
+// Cost of the snapshots of parallel_snapshot_flat_hash_map: the time to take
+// one, and the extra time of the writes following it (the first write to
+// each submap copies it), compared to copying a parallel_flat_hash_map.
+//
+// usage: ex_snapshot_bench [num_keys]
+// ------------------------------------------------------------------------------
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "parallel_hashmap/phmap.h"
+#include "parallel_hashmap/phmap_snapshot.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ms_since(clk::time_point start) {
+    return std::chrono::duration<double, std::milli>(clk::now() - start).count();
+}
+
+using Map = phmap::parallel_snapshot_flat_hash_map<uint64_t, uint64_t>;
+
+static double run_writes(Map& m, const std::vector<uint64_t>& keys) {
+    auto start = clk::now();
+    for (auto k : keys)
+        m.insert_or_assign(k, k + 1);
+    return ms_since(start);
+}
+
+int main(int argc, char** argv) {
+    size_t num_keys = argc > 1 ? (size_t)atoll(argv[1]) : 4000000;
+
+    Map m;
+    m.reserve(num_keys);
+    for (uint64_t i = 0; i < num_keys; ++i)
+        m.try_emplace(i, i);
+
+    std::mt19937_64 gen(7);
+    std::vector<uint64_t> keys(1000000);
+    for (auto& k : keys)
+        k = gen() % num_keys;
+
+    printf("%zu keys, %zu updates\n", num_keys, keys.size());
+
+    auto start = clk::now();
+    for (int i = 0; i < 100; ++i)
+        (void)m.snapshot();
+    printf("snapshot()                          %8.3f ms\n", ms_since(start) / 100);
+
+    printf("updates without snapshot            %8.1f ms\n", run_writes(m, keys));
+    {
+        auto s = m.snapshot();
+        printf("updates with a live snapshot        %8.1f ms\n", run_writes(m, keys));
+        size_t n = 0;
+        start = clk::now();
+        s.for_each([&](const Map::value_type& p) { n += (p.second == p.first); });
+        printf("iterate the snapshot                %8.1f ms   (%zu unchanged)\n", ms_since(start), n);
+    }
+
+    phmap::parallel_flat_hash_map<uint64_t, uint64_t> full;
+    full.reserve(num_keys);
+    for (uint64_t i = 0; i < num_keys; ++i)
+        full.try_emplace(i, i);
+    start = clk::now();
+    {
+        phmap::parallel_flat_hash_map<uint64_t, uint64_t> copy(full);
+        printf("copy of a parallel_flat_hash_map    %8.1f ms   (%zu)\n", ms_since(start), copy.size());
+    }
+    return 0;
+}
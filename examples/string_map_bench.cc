@@ -0,0 +1,113 @@
+// The llil4map.cc workload, without its files and threads: lines of
+// "word\tcount" as made by llil_utils/gen-llil.pl (26^3 three letter
+// prefixes followed by random letters), summed per word in a map, then
+// sorted by decreasing count and increasing word.
+//
+// Compares phmap::flat_hash_map<std::string, uint32_t>, looked up with a
+// std::string_view, and phmap::flat_string_map<uint32_t>, for short words
+// (6 chars, as gen-llil.pl 200 3) and long ones (12 to 28 chars).
+//
+// usage: ex_string_map_bench [words per prefix]
+// ------------------------------------------------------------------------------
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "parallel_hashmap/phmap.h"
+#include "parallel_hashmap/phmap_string.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ms_since(clk::time_point start) {
+    return std::chrono::duration<double, std::milli>(clk::now() - start).count();
+}
+
+// the contents of 3 input files
+static std::string make_lines(size_t per_prefix, size_t min_len, size_t max_len) {
+    std::mt19937 rng(42);
+    std::string lines;
+    for (int file = 0; file < 3; ++file) {
+        for (char a = 'a'; a <= 'z'; ++a)
+            for (char b = 'a'; b <= 'z'; ++b)
+                for (char c = 'a'; c <= 'z'; ++c)
+                    for (size_t i = 0; i < per_prefix; ++i) {
+                        lines += a;
+                        lines += b;
+                        lines += c;
+                        size_t len = min_len + rng() % (max_len - min_len + 1);
+                        for (size_t j = 3; j < len; ++j)
+                            lines += (char)('a' + rng() % 26);
+                        lines += "\t1\n";
+                    }
+    }
+    return lines;
+}
+
+template <class F>
+static size_t for_each_line(const std::string& lines, F&& f) {
+    size_t n = 0;
+    const char* p   = lines.data();
+    const char* end = p + lines.size();
+    while (p < end) {
+        const char* tab = static_cast<const char*>(memchr(p, '\t', end - p));
+        uint32_t count = 0;
+        const char* q = tab + 1;
+        for (; *q != '\n'; ++q)
+            count = count * 10 + (uint32_t)(*q - '0');
+        f(std::string_view(p, tab - p), count);
+        p = q + 1;
+        ++n;
+    }
+    return n;
+}
+
+template <class Map>
+static void run(const char* name, const std::string& lines) {
+    Map m;
+    auto start = clk::now();
+    size_t num_lines = for_each_line(lines, [&](std::string_view word, uint32_t count) {
+        m.try_emplace(word, 0).first->second += count;
+    });
+    double sum_ms = ms_since(start);
+
+    start = clk::now();
+    std::vector<std::pair<std::string_view, uint32_t>> v;
+    v.reserve(m.size());
+    for (const auto& p : m)
+        v.emplace_back(std::string_view(p.first), p.second);
+    std::sort(v.begin(), v.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    double sort_ms = ms_since(start);
+
+    start = clk::now();
+    size_t found = 0;
+    for_each_line(lines, [&](std::string_view word, uint32_t) { found += m.count(word); });
+    double find_ms = ms_since(start);
+
+    start = clk::now();
+    { Map tmp(std::move(m)); }
+    double destroy_ms = ms_since(start);
+
+    printf("%-30s sum: %7.1f ms   sort: %7.1f ms   find: %7.1f ms   destroy: %6.1f ms  (%zu words%s)\n",
+           name, sum_ms, sort_ms, find_ms, destroy_ms, v.size(), found == num_lines ? "" : ", error");
+}
+
+int main(int argc, char** argv) {
+    size_t per_prefix = argc > 1 ? (size_t)atoll(argv[1]) : 200;
+
+    for (auto lens : {std::make_pair(6, 6), std::make_pair(12, 28)}) {
+        std::string lines = make_lines(per_prefix, lens.first, lens.second);
+        printf("words of %d to %d chars, %.1f MB of lines\n", lens.first, lens.second, lines.size() / 1e6);
+        run<phmap::flat_hash_map<std::string, uint32_t>>("flat_hash_map<std::string>", lines);
+        run<phmap::flat_string_map<uint32_t>>("flat_string_map", lines);
+    }
+    return 0;
+}
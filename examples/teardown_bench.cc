@@ -0,0 +1,87 @@
+// Times reserve(), clear() and the destruction of a large
+// parallel_node_hash_map<uint64_t, std::string>, submap by submap on one
+// thread, and with parallel_reserve(), parallel_clear() and
+// parallel_release() on several threads.
+//
+// The second run starts with the heap left by the first one, and its nodes
+// are more scattered, which slows their destruction. For a fair comparison,
+// run the two modes in separate processes.
+//
+// usage: ex_teardown_bench [num_threads] [num_entries] [serial|parallel]
+// ------------------------------------------------------------------------------
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include "parallel_hashmap/phmap.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ms_since(clk::time_point start) {
+    return std::chrono::duration<double, std::milli>(clk::now() - start).count();
+}
+
+using Map = phmap::parallel_node_hash_map<uint64_t, std::string,
+                                          phmap::priv::hash_default_hash<uint64_t>,
+                                          phmap::priv::hash_default_eq<uint64_t>,
+                                          phmap::priv::Allocator<std::pair<const uint64_t, std::string>>,
+                                          6, std::mutex>;
+
+static void fill(Map& m, size_t num_entries) {
+    for (uint64_t i = 0; i < num_entries; ++i)
+        m.try_emplace(i, 40, 'x');     // not small enough for the SSO
+}
+
+int main(int argc, char** argv) {
+    size_t num_threads = argc > 1 ? (size_t)atoll(argv[1]) : std::thread::hardware_concurrency();
+    size_t num_entries = argc > 2 ? (size_t)atoll(argv[2]) : 5000000;
+    const char* mode   = argc > 3 ? argv[3] : "";
+    if (num_threads == 0)
+        num_threads = 1;
+
+    printf("%zu entries, %zu threads\n", num_entries, num_threads);
+
+    if (strcmp(mode, "parallel") != 0) {
+        std::unique_ptr<Map> m(new Map);
+        auto start = clk::now();
+        m->reserve(num_entries);
+        double reserve_ms = ms_since(start);
+        fill(*m, num_entries);
+
+        start = clk::now();
+        m->clear();
+        double clear_ms = ms_since(start);
+        fill(*m, num_entries);
+
+        start = clk::now();
+        m.reset();
+        double destroy_ms = ms_since(start);
+        printf("serial     reserve: %7.1f ms   clear: %7.1f ms   destroy: %7.1f ms\n",
+               reserve_ms, clear_ms, destroy_ms);
+    }
+
+    if (strcmp(mode, "serial") != 0) {
+        std::unique_ptr<Map> m(new Map);
+        auto start = clk::now();
+        m->parallel_reserve(num_entries, num_threads);
+        double reserve_ms = ms_since(start);
+        fill(*m, num_entries);
+
+        start = clk::now();
+        m->parallel_clear(num_threads);
+        double clear_ms = ms_since(start);
+        fill(*m, num_entries);
+
+        start = clk::now();
+        m->parallel_release(num_threads);
+        m.reset();
+        double destroy_ms = ms_since(start);
+        printf("parallel   reserve: %7.1f ms   clear: %7.1f ms   destroy: %7.1f ms\n",
+               reserve_ms, clear_ms, destroy_ms);
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Hashing of composite keys with phmap::Hash<std::tuple> / std::pair, which
+// use HashState's combiner: the hash throughput alone, then inserts and
+// lookups in a flat_hash_map keyed by the tuple.
+//
+// ex_tuple_hash_bench_legacy is built with PHMAP_LEGACY_COMBINER, for a
+// comparison with the previous combiner.
+//
+// usage: ex_tuple_hash_bench [num_keys]
+// ------------------------------------------------------------------------------
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "parallel_hashmap/phmap.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+static double ms_since(clk::time_point start) {
+    return std::chrono::duration<double, std::milli>(clk::now() - start).count();
+}
+
+template <class Key, class MakeKey>
+static void run(const char* name, size_t num_keys, MakeKey make_key) {
+    std::vector<Key> keys;
+    keys.reserve(num_keys);
+    for (size_t i = 0; i < num_keys; ++i)
+        keys.push_back(make_key(i));
+
+    phmap::Hash<Key> hasher;
+    size_t x = 0;
+    auto start = clk::now();
+    for (int i = 0; i < 10; ++i)
+        for (const auto& k : keys)
+            x += hasher(k);
+    double hash_ns = ms_since(start) * 1e6 / (10.0 * num_keys);
+
+    phmap::flat_hash_map<Key, uint32_t> m;
+    start = clk::now();
+    for (size_t i = 0; i < num_keys; ++i)
+        m.emplace(keys[i], (uint32_t)i);
+    double insert_ms = ms_since(start);
+
+    start = clk::now();
+    size_t found = 0;
+    for (const auto& k : keys)
+        found += m.contains(k);
+    double find_ms = ms_since(start);
+
+    printf("%-20s hash: %5.2f ns   insert: %7.1f ms   find: %7.1f ms %s(%zx)\n",
+           name, hash_ns, insert_ms, find_ms, found == m.size() ? "" : "error ", x & 0xf);
+}
+
+int main(int argc, char** argv) {
+    size_t num_keys = argc > 1 ? (size_t)atoll(argv[1]) : 2000000;
+    printf("%zu keys, %s combiner\n", num_keys,
+#if defined(PHMAP_WIDE_COMBINER)
+           "wide"
+#elif defined(PHMAP_USE_HW_HASH)
+           "hw_mix64"
+#else
+           "legacy"
+#endif
+        );
+
+    std::mt19937 rng(42);
+    auto r = [&]() { return (int)(rng() % 1000); };
+
+    run<std::pair<uint64_t, uint64_t>>("pair<u64, u64>", num_keys, [&](size_t i) {
+        return std::make_pair((uint64_t)i, (uint64_t)r());
+    });
+    run<std::tuple<int, int, int, int>>("tuple<int x 4>", num_keys, [&](size_t i) {
+        return std::make_tuple((int)i, r(), r(), r());
+    });
+    run<std::tuple<int, int, int, int, int, int>>("tuple<int x 6>", num_keys, [&](size_t i) {
+        return std::make_tuple((int)i, r(), r(), r(), r(), r());
+    });
+    return 0;
+}
@@ -115,6 +115,9 @@
 #include <array>
 #include <cassert>
 #include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
 
 #include "phmap_fwd_decl.h"
 #include "phmap_utils.h"
@@ -124,8 +127,19 @@
     #include <string_view>
 #endif
 
+#ifdef PHMAP_SEEDED_HASH
+    #include <chrono>
+    #include <random>
+#endif
+
 namespace phmap {
 
+// Tag selecting the parallel_hash_set constructor which builds the container
+// on several threads (see parallel_hash_set::parallel_build()).
+struct parallel_build_t {};
+
+PHMAP_INTERNAL_INLINE_CONSTEXPR(parallel_build_t, parallel_build, {});
+
 namespace priv {
 
 // --------------------------------------------------------------------------
@@ -140,6 +154,17 @@ template <typename AllocType>
 void SwapAlloc(AllocType& /*lhs*/, AllocType& /*rhs*/,
                std::false_type /* propagate_on_container_swap */) {}
 
+// --------------------------------------------------------------------------
+// Asks for the cache line at p, which is about to be read.
+inline void PrefetchForRead(const void* p) {
+    (void)p;
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#elif defined(__GNUC__)
+    __builtin_prefetch(p);
+#endif
+}
+
 // --------------------------------------------------------------------------
 template <size_t Width>
 class probe_seq 
@@ -230,17 +255,19 @@ uint32_t LeadingZeros(T x) {
 // indexes of the set bits of a bitmask.  When Shift=0 (platforms with SSE),
 // this is a true bitmask.  On non-SSE, platforms the arithematic used to
 // emulate the SSE behavior works in bytes (Shift=3) and leaves each bytes as
-// either 0x00 or 0x80.
+// either 0x00 or 0x80.  With NEON, there is one nibble per slot (Shift=2),
+// either 0x0 or 0x8.
 //
 // For example:
 //   for (int i : BitMask<uint32_t, 16>(0x5)) -> yields 0, 2
 //   for (int i : BitMask<uint64_t, 8, 3>(0x0000000080800000)) -> yields 2, 3
+//   for (int i : BitMask<uint64_t, 16, 2>(0x0000000000880000)) -> yields 4, 5
 // --------------------------------------------------------------------------
 template <class T, int SignificantBits, int Shift = 0>
 class BitMask 
 {
     static_assert(std::is_unsigned<T>::value, "");
-    static_assert(Shift == 0 || Shift == 3, "");
+    static_assert(Shift == 0 || Shift == 2 || Shift == 3, "");
 
 public:
     // These are useful for unit tests (gunit).
@@ -332,8 +359,15 @@ static_assert(kDeleted == -2,
 template <class std_alloc_t>
 inline ctrl_t* EmptyGroup() {
   PHMAP_IF_CONSTEXPR (std_alloc_t::value) {
-      alignas(16) static constexpr ctrl_t empty_group[] = {
+      // as large as the widest Group
+      alignas(64) static constexpr ctrl_t empty_group[] = {
           kSentinel, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty,
+          kEmpty,    kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty,
+          kEmpty,    kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty,
+          kEmpty,    kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty,
+          kEmpty,    kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty,
+          kEmpty,    kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty,
+          kEmpty,    kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty,
           kEmpty,    kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty};
 
       return const_cast<ctrl_t*>(empty_group);
@@ -366,6 +400,64 @@ inline size_t H1(size_t hashval, const ctrl_t* ) {
 
 #endif
 
+// --------------------------------------------------------------------------
+// With PHMAP_SEEDED_HASH defined, the values returned by the hasher are
+// xor-ed with a random seed, drawn once per process, before being mixed.
+// Where the keys land in the tables can then not be predicted from the keys,
+// which defeats inputs crafted to collide in H1/H2 (HashDoS). Keys for which
+// the hasher itself returns the same value still collide.
+//
+// Each table keeps a copy of the seed (8 more bytes), taken when it is
+// constructed, so ProcessHashSeed() may be assigned, e.g. for reproducible
+// tests, and applies to the containers created afterwards. The seed is
+// copied, moved and swapped along with the elements. The merge(), set
+// algebra and == of parallel containers having different seeds work one
+// element at a time instead of submap by submap. Containers dumped
+// with phmap_dump() record their seed, and phmap_load() rehashes them when
+// loaded by a container using another one.
+// --------------------------------------------------------------------------
+#ifdef PHMAP_SEEDED_HASH
+
+inline size_t RandomHashSeedBits(std::random_device& rd) {
+    size_t bits = static_cast<size_t>(rd());
+    PHMAP_IF_CONSTEXPR (sizeof(size_t) == 8)
+        bits = (bits << (sizeof(size_t) * 4)) ^ static_cast<size_t>(rd());
+    return bits;
+}
+
+inline size_t MakeProcessHashSeed() {
+    // address space layout randomization and the clock, in case
+    // std::random_device is not available
+    static const char anchor = 0;
+    size_t seed = static_cast<size_t>(reinterpret_cast<uintptr_t>(&anchor)) ^
+        static_cast<size_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+#ifdef PHMAP_HAVE_EXCEPTIONS
+    try {
+        std::random_device rd;
+        seed ^= RandomHashSeedBits(rd);
+    } catch (...) {
+    }
+#else
+    std::random_device rd;
+    seed ^= RandomHashSeedBits(rd);
+#endif
+    seed = phmap_mix<sizeof(size_t)>()(seed);
+    return seed ? seed : 1;   // 0 means unseeded in the dumps
+}
+
+inline size_t& ProcessHashSeed() {
+    static size_t seed = MakeProcessHashSeed();
+    return seed;
+}
+
+inline size_t GetHashSeed() { return ProcessHashSeed(); }
+
+#else
+
+inline size_t GetHashSeed() { return 0; }
+
+#endif
+
 
 inline ctrl_t H2(size_t hashval)       { return (ctrl_t)(hashval & 0x7F); }
 
@@ -473,6 +565,128 @@ struct GroupSse2Impl
 
 #endif  // PHMAP_HAVE_SSE2
 
+#if PHMAP_HAVE_AVX512BW
+
+// --------------------------------------------------------------------------
+// 64 control bytes per group, compared with a single instruction into a 64
+// bit mask. Longer groups mean that a probe sequence almost never goes past
+// its first group, even close to the maximum load factor.
+// --------------------------------------------------------------------------
+struct GroupAvx512Impl 
+{
+    enum { kWidth = 64 };  // the number of slots per group
+
+    explicit GroupAvx512Impl(const ctrl_t* pos) {
+        ctrl = _mm512_loadu_si512(reinterpret_cast<const void*>(pos));
+    }
+
+    // Returns a bitmask representing the positions of slots that match hash.
+    // ----------------------------------------------------------------------
+    BitMask<uint64_t, kWidth> Match(h2_t hash) const {
+        return BitMask<uint64_t, kWidth>(
+            _mm512_cmpeq_epi8_mask(_mm512_set1_epi8((char)hash), ctrl));
+    }
+
+    // Returns a bitmask representing the positions of empty slots.
+    // ------------------------------------------------------------
+    BitMask<uint64_t, kWidth> MatchEmpty() const {
+        return Match(static_cast<h2_t>(kEmpty));
+    }
+
+    // Returns a bitmask representing the positions of empty or deleted slots.
+    // -----------------------------------------------------------------------
+    BitMask<uint64_t, kWidth> MatchEmptyOrDeleted() const {
+        return BitMask<uint64_t, kWidth>(
+            _mm512_cmplt_epi8_mask(ctrl, _mm512_set1_epi8(static_cast<char>(kSentinel))));
+    }
+
+    // Returns the number of trailing empty or deleted elements in the group.
+    // ----------------------------------------------------------------------
+    uint32_t CountLeadingEmptyOrDeleted() const {
+        // unlike the 16 bit mask of GroupSse2Impl, this one can't be incremented
+        uint64_t others = ~static_cast<uint64_t>(
+            _mm512_cmplt_epi8_mask(ctrl, _mm512_set1_epi8(static_cast<char>(kSentinel))));
+        return others ? TrailingZeros(others) : static_cast<uint32_t>(kWidth);
+    }
+
+    // ----------------------------------------------------------------------
+    void ConvertSpecialToEmptyAndFullToDeleted(ctrl_t* dst) const {
+        __mmask64 special = _mm512_movepi8_mask(ctrl);   // the msb is set
+        __m512i res = _mm512_mask_blend_epi8(special,
+                                             _mm512_set1_epi8(static_cast<char>(kDeleted)),
+                                             _mm512_set1_epi8(static_cast<char>(kEmpty)));
+        _mm512_storeu_si512(reinterpret_cast<void*>(dst), res);
+    }
+
+    __m512i ctrl;
+};
+
+#endif  // PHMAP_HAVE_AVX512BW
+
+#if PHMAP_HAVE_NEON
+
+// --------------------------------------------------------------------------
+// 16 control bytes per group, as with SSE2. NEON has no movemask, so the
+// byte compare results are narrowed to one nibble per slot with a shift
+// (vshrn), and only the top bit of each nibble is kept for the BitMask.
+// Unlike GroupPortableImpl, the matches are exact.
+// --------------------------------------------------------------------------
+struct GroupNeonImpl 
+{
+    enum { kWidth = 16 };  // the number of slots per group
+
+    explicit GroupNeonImpl(const ctrl_t* pos) {
+        ctrl = vld1q_s8(reinterpret_cast<const int8_t*>(pos));
+    }
+
+    // Returns a bitmask representing the positions of slots that match hash.
+    // ----------------------------------------------------------------------
+    BitMask<uint64_t, kWidth, 2> Match(h2_t hash) const {
+        constexpr uint64_t msbs = 0x8888888888888888ULL;
+        return BitMask<uint64_t, kWidth, 2>(
+            NibbleMask(vceqq_u8(vreinterpretq_u8_s8(ctrl), vdupq_n_u8(hash))) & msbs);
+    }
+
+    // Returns a bitmask representing the positions of empty slots.
+    // ------------------------------------------------------------
+    BitMask<uint64_t, kWidth, 2> MatchEmpty() const {
+        constexpr uint64_t msbs = 0x8888888888888888ULL;
+        return BitMask<uint64_t, kWidth, 2>(
+            NibbleMask(vceqq_s8(ctrl, vdupq_n_s8(kEmpty))) & msbs);
+    }
+
+    // Returns a bitmask representing the positions of empty or deleted slots.
+    // -----------------------------------------------------------------------
+    BitMask<uint64_t, kWidth, 2> MatchEmptyOrDeleted() const {
+        constexpr uint64_t msbs = 0x8888888888888888ULL;
+        return BitMask<uint64_t, kWidth, 2>(
+            NibbleMask(vcltq_s8(ctrl, vdupq_n_s8(kSentinel))) & msbs);
+    }
+
+    // Returns the number of trailing empty or deleted elements in the group.
+    // ----------------------------------------------------------------------
+    uint32_t CountLeadingEmptyOrDeleted() const {
+        uint64_t others = ~NibbleMask(vcltq_s8(ctrl, vdupq_n_s8(kSentinel)));
+        return others ? (TrailingZeros(others) >> 2) : static_cast<uint32_t>(kWidth);
+    }
+
+    // ----------------------------------------------------------------------
+    void ConvertSpecialToEmptyAndFullToDeleted(ctrl_t* dst) const {
+        uint8x16_t special = vcltq_s8(ctrl, vdupq_n_s8(0));
+        int8x16_t res = vbslq_s8(special, vdupq_n_s8(kEmpty), vdupq_n_s8(kDeleted));
+        vst1q_s8(reinterpret_cast<int8_t*>(dst), res);
+    }
+
+    // 0x0 or 0xf in nibble i, from 0x00 or 0xff in byte i of cmp
+    static uint64_t NibbleMask(uint8x16_t cmp) {
+        return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4)), 0);
+    }
+
+    int8x16_t ctrl;
+};
+
+#endif  // PHMAP_HAVE_NEON
+
 // --------------------------------------------------------------------------
 // --------------------------------------------------------------------------
 struct GroupPortableImpl 
@@ -528,12 +742,91 @@ struct GroupPortableImpl
     uint64_t ctrl;
 };
 
-#if PHMAP_HAVE_SSE2  
+#if PHMAP_HAVE_AVX512BW
+    using Group = GroupAvx512Impl;
+#elif PHMAP_HAVE_SSE2  
     using Group = GroupSse2Impl;
+#elif PHMAP_HAVE_NEON
+    using Group = GroupNeonImpl;
 #else
     using Group = GroupPortableImpl;
 #endif
 
+#if PHMAP_HAVE_CPU_DISPATCH
+
+// --------------------------------------------------------------------------
+// With PHMAP_CPU_DISPATCH, the loops which rewrite the whole control byte
+// array are also compiled for SSSE3 and AVX2, using the target attribute, and
+// the version matching the cpu is picked on the first call. This is only done
+// for bulk operations: Group itself is fixed at compile time, because its
+// width determines the layout of the control bytes, and because dispatching
+// each probe in find() would prevent it from being inlined.
+// --------------------------------------------------------------------------
+namespace cpu_dispatch_internal {
+
+enum CpuLevel { kCpuSse2 = 0, kCpuSsse3 = 1, kCpuAvx2 = 2 };
+
+inline int DetectCpuLevel() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return kCpuAvx2;
+    if (__builtin_cpu_supports("ssse3"))
+        return kCpuSsse3;
+    return kCpuSse2;
+}
+
+inline int GetCpuLevel() {
+    static const int level = DetectCpuLevel();
+    return level;
+}
+
+// Same mapping as GroupSse2Impl::ConvertSpecialToEmptyAndFullToDeleted with
+// SSSE3, on n bytes (a multiple of 16).
+// --------------------------------------------------------------------------
+__attribute__((target("ssse3")))
+inline void ConvertSpecialToEmptyAndFullToDeletedSsse3(ctrl_t* ctrl, size_t n) {
+    const __m128i msbs = _mm_set1_epi8(static_cast<char>(-128));
+    const __m128i x126 = _mm_set1_epi8(126);
+    for (size_t i = 0; i != n; i += 16) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(ctrl + i),
+                         _mm_or_si128(_mm_shuffle_epi8(x126, c), msbs));
+    }
+}
+
+// The same, 32 bytes at a time (n is a multiple of 32).
+// --------------------------------------------------------------------------
+__attribute__((target("avx2")))
+inline void ConvertSpecialToEmptyAndFullToDeletedAvx2(ctrl_t* ctrl, size_t n) {
+    const __m256i msbs = _mm256_set1_epi8(static_cast<char>(-128));
+    const __m256i x126 = _mm256_set1_epi8(126);
+    for (size_t i = 0; i != n; i += 32) {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ctrl + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(ctrl + i),
+                            _mm256_or_si256(_mm256_shuffle_epi8(x126, c), msbs));
+    }
+}
+
+// Converts the first n control bytes (n = capacity + 1) with the best version
+// for this cpu. Returns false when the caller has to use Group instead.
+// --------------------------------------------------------------------------
+inline bool ConvertSpecialToEmptyAndFullToDeleted(ctrl_t* ctrl, size_t n) {
+    const int level = GetCpuLevel();
+    if (level >= kCpuAvx2 && n >= 32) {
+        ConvertSpecialToEmptyAndFullToDeletedAvx2(ctrl, n);
+        return true;
+    }
+    if (level >= kCpuSsse3 && n >= 16) {
+        ConvertSpecialToEmptyAndFullToDeletedSsse3(ctrl, n);
+        return true;
+    }
+    return false;
+}
+
+}  // namespace cpu_dispatch_internal
+
+#endif  // PHMAP_HAVE_CPU_DISPATCH
+
 // The number of cloned control bytes that we copy from the beginning to the
 // end of the control bytes array.
 // -------------------------------------------------------------------------
@@ -559,6 +852,9 @@ inline void ConvertDeletedToEmptyAndFullToDeleted(
 {
     assert(ctrl[capacity] == kSentinel);
     assert(IsValidCapacity(capacity));
+#if PHMAP_HAVE_CPU_DISPATCH
+    if (!cpu_dispatch_internal::ConvertSpecialToEmptyAndFullToDeleted(ctrl, capacity + 1))
+#endif
     for (ctrl_t* pos = ctrl; pos != ctrl + capacity + 1; pos += Group::kWidth) {
         Group{pos}.ConvertSpecialToEmptyAndFullToDeleted(pos);
     }
@@ -608,6 +904,60 @@ inline size_t GrowthToLowerboundCapacity(size_t growth)
     return growth + static_cast<size_t>((static_cast<int64_t>(growth) - 1) / 7);
 }
 
+// --------------------------------------------------------------------------
+// Inline storage (used by inline_flat_hash_set and inline_flat_hash_map)
+//
+// Wrapping a policy into InlinePolicy<Policy, N> makes raw_hash_set embed
+// ctrl bytes and slots for (at least) N elements, so small tables do not
+// allocate. Past that size, the table spills to the usual heap layout.
+// --------------------------------------------------------------------------
+template <class Policy, size_t N>
+struct InlinePolicy : Policy {};
+
+// smallest valid capacity whose growth can hold n elements (constexpr
+// equivalent of NormalizeCapacity(GrowthToLowerboundCapacity(n)))
+constexpr size_t InlineCapacityFor(size_t n, size_t capacity = 1) {
+    return ((Group::kWidth == 8 && capacity == 7) ? 6 : capacity - capacity / 8) >= n
+        ? capacity : InlineCapacityFor(n, capacity * 2 + 1);
+}
+
+template <class Policy>
+struct InlineCapacity : std::integral_constant<size_t, 0> {};
+
+template <class Policy, size_t N>
+struct InlineCapacity<InlinePolicy<Policy, N>>
+    : std::integral_constant<size_t, InlineCapacityFor(N)> {
+    static_assert(N > 0, "inline capacity must be positive");
+};
+
+template <class Slot, size_t Capacity>
+struct InlineStorage
+{
+    ctrl_t* inline_ctrl() { return inline_ctrl_; }
+    Slot* inline_slots() { return reinterpret_cast<Slot*>(inline_slots_); }
+
+    ctrl_t inline_ctrl_[Capacity + Group::kWidth + 1];
+    alignas(Slot) unsigned char inline_slots_[sizeof(Slot) * Capacity];
+};
+
+template <class Slot>
+struct InlineStorage<Slot, 0>
+{
+    ctrl_t* inline_ctrl() { return nullptr; }
+    Slot* inline_slots() { return nullptr; }
+};
+
+// --------------------------------------------------------------------------
+// Policies storing the hash of each element in its slot (see
+// HashCachingPolicy) define `caches_hash`.
+// --------------------------------------------------------------------------
+template <class Policy, class = void>
+struct IsHashCaching : std::false_type {};
+
+template <class Policy>
+struct IsHashCaching<Policy, phmap::void_t<typename Policy::caches_hash>>
+    : std::true_type {};
+
 namespace hashtable_debug_internal {
 
 // If it is a map, call get<0>().
@@ -761,6 +1111,21 @@ DecomposePairImpl(F&& f, std::pair<std::tuple<K>, V> p) {
 
 }  // namespace memory_internal
 
+// True when the hash of the keys K is phmap_mix<8>() of the key itself, so
+// hash_many() can hash them with phmap_mix_many(): H is phmap::Hash<K> for
+// a 32 or 64 bit integer (which returns the key), and the mixing is on.
+// ----------------------------------------------------------------------------
+template <class K, class H>
+struct CanMixMany : std::integral_constant<bool,
+#if defined(PHMAP_HAVE_MIX_MANY) && !PHMAP_DISABLE_MIX && !defined(PHMAP_USE_HW_HASH)
+    std::is_same<H, phmap::Hash<K>>::value &&
+    (std::is_same<K, int32_t>::value || std::is_same<K, uint32_t>::value ||
+     std::is_same<K, int64_t>::value || std::is_same<K, uint64_t>::value)
+#else
+    false
+#endif
+    > {};
+
 
 // ----------------------------------------------------------------------------
 //                     R A W _ H A S H _ S E T
@@ -843,8 +1208,11 @@ DecomposePairImpl(F&& f, std::pair<std::tuple<K>, V> p) {
 // ----------------------------------------------------------------------------
 template <class Policy, class Hash, class Eq, class Alloc>
 class raw_hash_set 
+    : private InlineStorage<typename Policy::slot_type, InlineCapacity<Policy>::value>
 {
     using PolicyTraits = hash_policy_traits<Policy>;
+    using InlineStorage = priv::InlineStorage<typename Policy::slot_type, InlineCapacity<Policy>::value>;
+    static constexpr size_t kInlineCapacity = InlineCapacity<Policy>::value;
     using KeyArgImpl =
         KeyArg<IsTransparent<Eq>::value && IsTransparent<Hash>::value>;
 
@@ -1067,6 +1435,8 @@ public:
                           const allocator_type& alloc = allocator_type())
         : ctrl_(EmptyGroup<std_alloc_t>()), settings_(0, hashfn, eq, alloc) {
         if (bucket_cnt) {
+            if (bucket_cnt < kInlineCapacity)
+                bucket_cnt = kInlineCapacity;
             size_t new_capacity = NormalizeCapacity(bucket_cnt);
             reset_growth_left(new_capacity);
             initialize_slots(new_capacity);
@@ -1170,14 +1540,19 @@ public:
 
     raw_hash_set(const raw_hash_set& that, const allocator_type& a)
         : raw_hash_set(0, that.hash_ref(), that.eq_ref(), a) {
+        copy_hash_seed(that);      // the slot hashes below are seeded with it
         rehash(that.capacity());   // operator=() should preserve load_factor
         // Because the table is guaranteed to be empty, we can do something faster
         // than a full `insert`.
-        for (const auto& v : that) {
-            const size_t hashval = PolicyTraits::apply(HashElement{hash_ref()}, v);
+        for (size_t i = 0; i != that.capacity_; ++i) {
+            if (!IsFull(that.ctrl_[i]))
+                continue;
+            slot_type* src = that.slots_ + i;
+            const size_t hashval = that.slot_hash(src);
             auto target = find_first_non_full(hashval);
             set_ctrl(target.offset, H2(hashval));
-            emplace_at(target.offset, v);
+            set_slot_hash(slots_ + target.offset, hashval);
+            emplace_at(target.offset, static_cast<const value_type&>(PolicyTraits::element(src)));
             infoz_.RecordInsert(hashval, target.probe_length);
         }
         size_ = that.size();
@@ -1199,6 +1574,9 @@ public:
         settings_(std::move(that.settings_)) {
         // growth_left was copied above, reset the one from `that`.
         that.growth_left() = 0;
+        copy_hash_seed(that);
+        if (is_inline())
+            relocate_inline(ctrl_, slots_, *this);
     }
 
     raw_hash_set(raw_hash_set&& that, const allocator_type& a)
@@ -1214,6 +1592,9 @@ public:
             std::swap(capacity_, that.capacity_);
             std::swap(growth_left(), that.growth_left());
             std::swap(infoz_, that.infoz_);
+            copy_hash_seed(that);
+            if (is_inline())
+                relocate_inline(ctrl_, slots_, *this);
         } else {
             reserve(that.size());
             // Note: this will copy elements of dense_set and unordered_set instead of
@@ -1274,6 +1655,15 @@ public:
     PHMAP_ATTRIBUTE_REINITIALIZES void clear() {
         if (empty())
             return;
+        PHMAP_IF_CONSTEXPR((priv::is_monotonic_allocator<allocator_type>::value &&
+                            std::is_trivially_destructible<typename PolicyTraits::value_type>::value &&
+                            std::is_same<typename Policy::is_flat, std::true_type>::value)) {
+            // memory comes from an arena and will be reclaimed by its reset(), so
+            // just drop the storage instead of resetting every ctrl byte => O(1)
+            destroy_slots();
+            infoz_.RecordStorageChanged(0, 0);
+            return;
+        }
         if (capacity_) {
            PHMAP_IF_CONSTEXPR((!std::is_trivially_destructible<typename PolicyTraits::value_type>::value ||
                                std::is_same<typename Policy::is_flat, std::false_type>::value)) {
@@ -1375,8 +1765,7 @@ public:
     template <class InputIt, typename phmap::enable_if_t<has_difference_operator<InputIt>::value, int> = 0>
     void insert(InputIt first, InputIt last) {
         this->reserve(this->size() + (last - first));
-        for (; first != last; ++first) 
-            emplace(*first);
+        insert_range(first, last, IsKeyArray<InputIt>());
     }
 
     template <class InputIt, typename phmap::enable_if_t<!has_difference_operator<InputIt>::value, int> = 0>
@@ -1685,7 +2074,27 @@ public:
         swap(hash_ref(), that.hash_ref());
         swap(eq_ref(), that.eq_ref());
         swap(infoz_, that.infoz_);
+        swap_hash_seed(that);
         SwapAlloc(alloc_ref(), that.alloc_ref(), typename AllocTraits::propagate_on_container_swap{});
+
+        PHMAP_IF_CONSTEXPR (kInlineCapacity != 0) {
+            // tables using their inline storage now point into the other object,
+            // move the elements back where they belong.
+            InlineStorage& mine = *this;
+            InlineStorage& theirs = that;
+            bool mine_moved = ctrl_ == theirs.inline_ctrl();
+            bool theirs_moved = that.ctrl_ == mine.inline_ctrl();
+            if (mine_moved && theirs_moved) {
+                InlineStorage tmp;
+                that.relocate_inline(that.ctrl_, that.slots_, tmp);
+                relocate_inline(ctrl_, slots_, mine);
+                that.relocate_inline(that.ctrl_, that.slots_, theirs);
+            } else if (mine_moved) {
+                relocate_inline(ctrl_, slots_, mine);
+            } else if (theirs_moved) {
+                that.relocate_inline(that.ctrl_, that.slots_, theirs);
+            }
+        }
     }
 
 #if !defined(PHMAP_NON_DETERMINISTIC)
@@ -1694,6 +2103,14 @@ public:
 
     template<typename InputArchive>
     bool  phmap_load(InputArchive&);
+
+private:
+    // loads the table as dumped, and sets `seed` to the hash seed it was
+    // laid out with
+    template<typename InputArchive>
+    bool  load_dump(InputArchive&, size_t& seed);
+
+public:
 #endif
 
     void rehash(size_t n) {
@@ -1714,6 +2131,27 @@ public:
 
     void reserve(size_t n) { rehash(GrowthToLowerboundCapacity(n)); }
 
+    // Extension API: number of slots left marked as deleted by erase().
+    // They count against the growth limit like the elements, and when it is
+    // reached the next insert rehashes the whole table, into a table twice
+    // larger if the elements use more than half of the limit.
+    size_t tombstones() const {
+        return capacity_ ? CapacityToGrowth(capacity_) - size_ - growth_left() : 0;
+    }
+
+    // Extension API: reclaims all the tombstones, in place. O(capacity()),
+    // and invalidates the iterators. Calling it when tombstones() gets large,
+    // at a time of the caller's choosing, spares the inserts that rehash, and
+    // keeps the capacity from doubling under erase/insert churn.
+    void compact() {
+        if (tombstones() == 0)
+            return;
+        if (is_small())
+            resize(capacity_);
+        else
+            drop_deletes_without_resize();
+    }
+
     // Extension API: support for heterogeneous keys.
     //
     //   std::unordered_set<std::string> s;
@@ -1752,6 +2190,23 @@ public:
             prefetch_hash(this->hash(key));
     }
 
+    // Extension API: slot positions, for containers resuming a scan of the
+    // table where they left it (ex: the CLOCK hand of parallel_lru_cache).
+    // iterator_from_index(i) returns the first element at slot i or after it
+    // (end() if none). PRECONDITION: i <= capacity().
+    // -----------------------------------------------------------------------
+    iterator iterator_from_index(size_t i) {
+        assert(i <= capacity_);
+        iterator it = iterator_at(i);
+        it.skip_empty_or_deleted();
+        return it;
+    }
+
+    // PRECONDITION: not an end() iterator.
+    size_t index_of(const_iterator it) const {
+        return static_cast<size_t>(it.inner_.slot_ - slots_);
+    }
+
     // The API of find() has two extensions.
     //
     // 1. The hash can be passed by the user. It must be equal to the hash of the
@@ -1801,6 +2256,47 @@ public:
         return find(key, hashval) != end();
     }
 
+    // Extension API: for each key of keys[0, n), calls f(key, p), where p
+    // points to the element with this key, or is nullptr if there is none.
+    // The keys can also be passed as a container with data() and size(),
+    // such as a std::vector.
+    //
+    // The keys are looked up group_size at a time (at most kMaxLookupGroup):
+    // the control bytes of all the keys of a group are prefetched, then the
+    // matching slots, before any of them is compared, so that up to
+    // group_size cache misses are pending at once instead of the few which
+    // the cpu overlaps in a loop calling find(). This only pays off for
+    // tables much larger than the cache, and costs a few ns per key on
+    // small ones. f is called in the order of the keys, as each one is
+    // compared (after the probes of the whole group are prefetched), and
+    // must not change the table.
+    // -----------------------------------------------------------------------
+    enum : size_t { kMaxLookupGroup = 64, kLookupGroup = 32 };
+
+    template <class K, class F>
+    void for_each_lookup(const K* keys, size_t n, F&& f, size_t group_size = kLookupGroup) {
+        lookup_grouped(keys, n, group_size,
+                           [this](const K* k, size_t cnt, size_t* out) { hash_many(k, cnt, out); },
+                           [this](size_t) -> raw_hash_set& { return *this; }, f);
+    }
+
+    template <class K, class F>
+    void for_each_lookup(const K* keys, size_t n, F&& f, size_t group_size = kLookupGroup) const {
+        const_cast<raw_hash_set*>(this)->for_each_lookup(keys, n,
+            [&f](const K& key, value_type* p) { f(key, static_cast<const value_type*>(p)); },
+            group_size);
+    }
+
+    template <class Keys, class F>
+    void for_each_lookup(const Keys& keys, F&& f, size_t group_size = kLookupGroup) {
+        for_each_lookup(keys.data(), keys.size(), std::forward<F>(f), group_size);
+    }
+
+    template <class Keys, class F>
+    void for_each_lookup(const Keys& keys, F&& f, size_t group_size = kLookupGroup) const {
+        for_each_lookup(keys.data(), keys.size(), std::forward<F>(f), group_size);
+    }
+
     template <class K = key_type>
     std::pair<iterator, iterator> equal_range(const key_arg<K>& key) {
         auto it = find(key);
@@ -1850,13 +2346,70 @@ public:
 
     template <class K>
     size_t hash(const K& key) const {
-        return HashElement{hash_ref()}(key);
+        return HashElement{hash_ref(), hash_seed()}(key);
+    }
+
+    // Extension API: out[i] = hash(keys[i]) for i in [0, n). The 32 and 64 bit
+    // integers hashed with phmap::Hash are hashed several at a time when AVX2
+    // or AVX-512F is enabled at compile time (see phmap_mix_many()).
+    // -----------------------------------------------------------------------
+    template <class K = key_type>
+    void hash_many(const K* keys, size_t n, size_t* out) const {
+        hash_many_impl(keys, n, out, CanMixMany<K, hasher>());
     }
 
 private:
     template <class Container, typename Enabler>
     friend struct phmap::priv::hashtable_debug_internal::HashtableDebugAccess;
 
+    template <class K>
+    void hash_many_impl(const K* keys, size_t n, size_t* out, std::true_type) const {
+        phmap_mix_many(keys, n, hash_seed(), out);
+    }
+
+    template <class K>
+    void hash_many_impl(const K* keys, size_t n, size_t* out, std::false_type) const {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = hash(keys[i]);
+    }
+
+    // true when [first, last) is an array of keys which hash_many() mixes
+    // several at a time (sets only).
+    template <class It, bool = CanMixMany<key_type, hasher>::value &&
+                               std::is_same<value_type, key_type>::value>
+    struct IsKeyArray : std::false_type {};
+
+    template <class It>
+    struct IsKeyArray<It, true> : std::integral_constant<bool,
+        std::is_same<It, key_type*>::value || std::is_same<It, const key_type*>::value ||
+        std::is_same<It, typename std::vector<key_type>::iterator>::value ||
+        std::is_same<It, typename std::vector<key_type>::const_iterator>::value> {};
+
+    template <class InputIt>
+    void insert_range(InputIt first, InputIt last, std::false_type) {
+        for (; first != last; ++first) 
+            emplace(*first);
+    }
+
+    // hashes the keys a block at a time, and prefetches the groups where they
+    // go a few keys ahead of the inserts.
+    template <class InputIt>
+    void insert_range(InputIt first, InputIt last, std::true_type) {
+        constexpr size_t kBlock = 64, kAhead = 8;
+        size_t hashes[kBlock];
+        const size_t n = static_cast<size_t>(last - first);
+        for (size_t i = 0; i < n; i += kBlock) {
+            const key_type* keys = &*(first + i);
+            const size_t    cnt  = (std::min)(kBlock, n - i);
+            hash_many(keys, cnt, hashes);
+            for (size_t j = 0; j < cnt; ++j) {
+                if (j + kAhead < cnt)
+                    prefetch_hash(hashes[j + kAhead]);
+                emplace_with_hash(hashes[j], keys[j]);
+            }
+        }
+    }
+
     template <class K = key_type>
     bool find_impl(const key_arg<K>& PHMAP_RESTRICT key, size_t hashval, size_t& PHMAP_RESTRICT offset) {
         PHMAP_IF_CONSTEXPR (!std_alloc_t::value) {
@@ -1869,9 +2422,10 @@ private:
             Group g{ ctrl_ + seq.offset() };
             for (uint32_t i : g.Match((h2_t)H2(hashval))) {
                 offset = seq.offset((size_t)i);
-                if (PHMAP_PREDICT_TRUE(PolicyTraits::apply(
-                    EqualElement<K>{key, eq_ref()},
-                    PolicyTraits::element(slots_ + offset))))
+                if (PHMAP_PREDICT_TRUE(slot_hash_matches(slots_ + offset, hashval) &&
+                                       PolicyTraits::apply(
+                                           EqualElement<K>{key, eq_ref()},
+                                           PolicyTraits::element(slots_ + offset))))
                     return true;
             }
             if (PHMAP_PREDICT_TRUE(g.MatchEmpty()))
@@ -1880,6 +2434,83 @@ private:
         }
     }
 
+    // A lookup of lookup_grouped(), between two of its stages.
+    struct lookup_state
+    {
+        using Mask = decltype(std::declval<const Group&>().Match(h2_t()));
+
+        raw_hash_set* set = nullptr;
+        size_t        offset = 0;              // of the first group probed
+        Mask          candidates = Mask(0);    // slots of this group with the same H2
+        bool          missing = false;         // no candidates, and an empty slot
+    };
+
+    // The engine of for_each_lookup(), also used by parallel_hash_set:
+    // hash_many(keys, cnt, out) hashes the keys, and set_of(hashval) returns
+    // the table where a hash is looked up. The lookups run a group at a
+    // time, in stages: each stage prefetches what the next one reads for
+    // all the keys of the group, so that the cache misses of one key overlap
+    // with the work on the others. The keys not settled by their first probe
+    // group, which are rare below the maximum load factor, finish with
+    // find_impl().
+    template <class K, class HashMany, class SetOf, class F>
+    static void lookup_grouped(const K* keys, size_t n, size_t group_size,
+                                   const HashMany& hash_many, const SetOf& set_of, F& f) {
+        size_t       hashes[kMaxLookupGroup];
+        lookup_state st[kMaxLookupGroup];
+        group_size = (std::max)(size_t(1), (std::min)(group_size, size_t(kMaxLookupGroup)));
+
+        for (size_t b = 0; b < n; b += group_size) {
+            const K*     k   = keys + b;
+            const size_t cnt = (std::min)(group_size, n - b);
+            hash_many(k, cnt, hashes);
+
+            for (size_t j = 0; j < cnt; ++j) {
+                raw_hash_set& s = set_of(hashes[j]);
+                st[j].set       = &s;
+                st[j].missing   = s.empty();   // ctrl_ could be nullptr
+                if (!st[j].missing) {
+                    st[j].offset = s.probe(hashes[j]).offset();
+                    PrefetchForRead(s.ctrl_ + st[j].offset);
+                }
+            }
+
+            for (size_t j = 0; j < cnt; ++j) {
+                if (st[j].missing)
+                    continue;
+                raw_hash_set& s = *st[j].set;
+                Group g{ s.ctrl_ + st[j].offset };
+                st[j].candidates = g.Match((h2_t)H2(hashes[j]));
+                if (st[j].candidates)
+                    PrefetchForRead(s.slots_ + ((st[j].offset + *st[j].candidates) & s.capacity_));
+                else
+                    st[j].missing = !!g.MatchEmpty();
+            }
+
+            for (size_t j = 0; j < cnt; ++j) {
+                value_type* p = nullptr;
+                if (!st[j].missing) {
+                    raw_hash_set& s = *st[j].set;
+                    for (uint32_t c : st[j].candidates) {
+                        slot_type* slot = s.slots_ + ((st[j].offset + c) & s.capacity_);
+                        if (PHMAP_PREDICT_TRUE(s.slot_hash_matches(slot, hashes[j]) &&
+                                               PolicyTraits::apply(
+                                                   EqualElement<K>{k[j], s.eq_ref()},
+                                                   PolicyTraits::element(slot)))) {
+                            p = &PolicyTraits::element(slot);
+                            break;
+                        }
+                    }
+                    size_t offset;
+                    if (!p && !Group{ s.ctrl_ + st[j].offset }.MatchEmpty() &&
+                        s.find_impl(k[j], hashes[j], offset))
+                        p = &PolicyTraits::element(s.slots_ + offset);
+                }
+                f(k[j], p);
+            }
+        }
+    }
+
     struct FindElement 
     {
         template <class K, class... Args>
@@ -1894,12 +2525,13 @@ private:
         template <class K, class... Args>
         size_t operator()(const K& key, Args&&...) const {
 #if PHMAP_DISABLE_MIX
-            return h(key);
+            return h(key) ^ seed;
 #else
-            return phmap_mix<sizeof(size_t)>()(h(key));
+            return phmap_mix<sizeof(size_t)>()(h(key) ^ seed);
 #endif
         }
         const hasher& h;
+        size_t seed;
     };
 
     template <class K1>
@@ -2017,11 +2649,16 @@ private:
             infoz_ = Sample();
         }
 
-        auto layout = MakeLayout(new_capacity);
-        char* mem = static_cast<char*>(
-            Allocate<Layout::Alignment()>(&alloc_ref(), layout.AllocSize()));
-        ctrl_ = reinterpret_cast<ctrl_t*>(layout.template Pointer<0>(mem));
-        slots_ = layout.template Pointer<1>(mem);
+        if (new_capacity == kInlineCapacity) {
+            ctrl_ = this->inline_ctrl();
+            slots_ = this->inline_slots();
+        } else {
+            auto layout = MakeLayout(new_capacity);
+            char* mem = static_cast<char*>(
+                Allocate<Layout::Alignment()>(&alloc_ref(), layout.AllocSize()));
+            ctrl_ = reinterpret_cast<ctrl_t*>(layout.template Pointer<0>(mem));
+            slots_ = layout.template Pointer<1>(mem);
+        }
         reset_ctrl(new_capacity);
         reset_growth_left(new_capacity);
         infoz_.RecordStorageChanged(size_, new_capacity);
@@ -2041,10 +2678,12 @@ private:
                 }
             }
         } 
-        auto layout = MakeLayout(capacity_);
         // Unpoison before returning the memory to the allocator.
         SanitizerUnpoisonMemoryRegion(slots_, sizeof(slot_type) * capacity_);
-        Deallocate<Layout::Alignment()>(&alloc_ref(), ctrl_, layout.AllocSize());
+        if (!is_inline()) {
+            auto layout = MakeLayout(capacity_);
+            Deallocate<Layout::Alignment()>(&alloc_ref(), ctrl_, layout.AllocSize());
+        }
         ctrl_ = EmptyGroup<std_alloc_t>();
         slots_ = nullptr;
         size_ = 0;
@@ -2054,6 +2693,15 @@ private:
 
     void resize(size_t new_capacity) {
         assert(IsValidCapacity(new_capacity));
+        if (new_capacity < kInlineCapacity)
+            new_capacity = kInlineCapacity;
+        const bool old_inline = is_inline();
+        if (old_inline && new_capacity == kInlineCapacity) {
+            // staying in the inline storage, only deleted slots need cleaning
+            if (!is_small())
+                drop_deletes_without_resize();
+            return;
+        }
         auto* old_ctrl = ctrl_;
         auto* old_slots = slots_;
         const size_t old_capacity = capacity_;
@@ -2062,15 +2710,14 @@ private:
 
         for (size_t i = 0; i != old_capacity; ++i) {
             if (IsFull(old_ctrl[i])) {
-                size_t hashval = PolicyTraits::apply(HashElement{hash_ref()},
-                                                     PolicyTraits::element(old_slots + i));
+                size_t hashval = slot_hash(old_slots + i);
                 auto target = find_first_non_full(hashval);
                 size_t new_i = target.offset;
                 set_ctrl(new_i, H2(hashval));
-                PolicyTraits::transfer(&alloc_ref(), slots_ + new_i, old_slots + i);
+                transfer_slot(slots_ + new_i, old_slots + i);
             }
         }
-        if (old_capacity) {
+        if (old_capacity && !old_inline) {
             SanitizerUnpoisonMemoryRegion(old_slots,
                                           sizeof(slot_type) * old_capacity);
             auto layout = MakeLayout(old_capacity);
@@ -2104,8 +2751,7 @@ private:
         slot_type* slot = reinterpret_cast<slot_type*>(&raw);
         for (size_t i = 0; i != capacity_; ++i) {
             if (!IsDeleted(ctrl_[i])) continue;
-            size_t hashval = PolicyTraits::apply(HashElement{hash_ref()},
-                                                 PolicyTraits::element(slots_ + i));
+            size_t hashval = slot_hash(slots_ + i);
             auto target = find_first_non_full(hashval);
             size_t new_i = target.offset;
 
@@ -2126,16 +2772,16 @@ private:
                 // set_ctrl poisons/unpoisons the slots so we have to call it at the
                 // right time.
                 set_ctrl(new_i, H2(hashval));
-                PolicyTraits::transfer(&alloc_ref(), slots_ + new_i, slots_ + i);
+                transfer_slot(slots_ + new_i, slots_ + i);
                 set_ctrl(i, kEmpty);
             } else {
                 assert(IsDeleted(ctrl_[new_i]));
                 set_ctrl(new_i, H2(hashval));
                 // Until we are done rehashing, DELETED marks previously FULL slots.
                 // Swap i and new_i elements.
-                PolicyTraits::transfer(&alloc_ref(), slot, slots_ + i);
-                PolicyTraits::transfer(&alloc_ref(), slots_ + i, slots_ + new_i);
-                PolicyTraits::transfer(&alloc_ref(), slots_ + new_i, slot);
+                transfer_slot(slot, slots_ + i);
+                transfer_slot(slots_ + i, slots_ + new_i);
+                transfer_slot(slots_ + new_i, slot);
                 --i;  // repeat
             }
         }
@@ -2164,8 +2810,9 @@ private:
         while (true) {
             Group g{ctrl_ + seq.offset()};
             for (uint32_t i : g.Match((h2_t)H2(hashval))) {
-                if (PHMAP_PREDICT_TRUE(PolicyTraits::element(slots_ + seq.offset((size_t)i)) ==
-                                      elem))
+                slot_type* slot = slots_ + seq.offset((size_t)i);
+                if (PHMAP_PREDICT_TRUE(slot_hash_matches(slot, hashval) &&
+                                       PolicyTraits::element(slot) == elem))
                     return true;
             }
             if (PHMAP_PREDICT_TRUE(g.MatchEmpty())) return false;
@@ -2176,7 +2823,7 @@ private:
     }
 
     bool has_element(const value_type& elem) const {
-        size_t hashval = PolicyTraits::apply(HashElement{hash_ref()}, elem);
+        size_t hashval = PolicyTraits::apply(HashElement{hash_ref(), hash_seed()}, elem);
         return has_element(elem, hashval);
     }
 
@@ -2231,9 +2878,11 @@ protected:
         while (true) {
             Group g{ctrl_ + seq.offset()};
             for (uint32_t i : g.Match((h2_t)H2(hashval))) {
-                if (PHMAP_PREDICT_TRUE(PolicyTraits::apply(
+                slot_type* slot = slots_ + seq.offset((size_t)i);
+                if (PHMAP_PREDICT_TRUE(slot_hash_matches(slot, hashval) &&
+                                       PolicyTraits::apply(
                                           EqualElement<K>{key, eq_ref()},
-                                          PolicyTraits::element(slots_ + seq.offset((size_t)i)))))
+                                          PolicyTraits::element(slot))))
                     return seq.offset((size_t)i);
             }
             if (PHMAP_PREDICT_TRUE(g.MatchEmpty())) break;
@@ -2265,6 +2914,7 @@ protected:
         ++size_;
         growth_left() -= IsEmpty(ctrl_[target.offset]);
         // set_ctrl(target.offset, H2(hashval));
+        set_slot_hash(slots_ + target.offset, hashval);
         infoz_.RecordInsert(hashval, target.probe_length);
         return target.offset;
     }
@@ -2358,8 +3008,79 @@ private:
     //  small tables.
     bool is_small() const { return capacity_ < Group::kWidth - 1; }
 
+    // Whether the elements are stored in the object itself (InlinePolicy only).
+    // Non-zero capacities are never below kInlineCapacity.
+    bool is_inline() const { return kInlineCapacity != 0 && capacity_ == kInlineCapacity; }
+
+    // Moves the ctrl bytes and elements of an inline table into `dst`, updating
+    // ctrl and slots. Positions are unchanged as the capacity is the same.
+    void relocate_inline(ctrl_t*& ctrl, slot_type*& slots, InlineStorage& dst) {
+        ctrl_t* new_ctrl = dst.inline_ctrl();
+        slot_type* new_slots = dst.inline_slots();
+        std::memcpy(new_ctrl, ctrl, kInlineCapacity + Group::kWidth + 1);
+        for (size_t i = 0; i != kInlineCapacity; ++i) {
+            if (IsFull(new_ctrl[i]))
+                transfer_slot(new_slots + i, slots + i);
+        }
+        ctrl = new_ctrl;
+        slots = new_slots;
+    }
+
+    // Hash of an element in the table. Hash caching policies return the value
+    // stored in the slot, saving a (possibly expensive) call to the hasher.
+    size_t slot_hash(slot_type* slot) const { return slot_hash(slot, IsHashCaching<Policy>()); }
+
+    size_t slot_hash(slot_type* slot, std::true_type) const { return Policy::cached_hash(slot); }
+
+    size_t slot_hash(slot_type* slot, std::false_type) const {
+        return PolicyTraits::apply(HashElement{hash_ref(), hash_seed()}, PolicyTraits::element(slot));
+    }
+
+    void set_slot_hash(slot_type* slot, size_t hashval) { set_slot_hash(slot, hashval, IsHashCaching<Policy>()); }
+
+    void set_slot_hash(slot_type* slot, size_t hashval, std::true_type) { Policy::cached_hash(slot) = hashval; }
+
+    void set_slot_hash(slot_type*, size_t, std::false_type) {}
+
+    // With hash caching, H2 matches whose full hash differ are rejected without calling Eq.
+    bool slot_hash_matches(slot_type* slot, size_t hashval) const {
+        return slot_hash_matches(slot, hashval, IsHashCaching<Policy>());
+    }
+
+    bool slot_hash_matches(slot_type* slot, size_t hashval, std::true_type) const {
+        return Policy::cached_hash(slot) == hashval;
+    }
+
+    bool slot_hash_matches(slot_type*, size_t, std::false_type) const { return true; }
+
+    // Moves an element within the table (or between tables having the same hasher),
+    // keeping its cached hash if any.
+    void transfer_slot(slot_type* new_slot, slot_type* old_slot) {
+        copy_slot_hash(new_slot, old_slot, IsHashCaching<Policy>());
+        PolicyTraits::transfer(&alloc_ref(), new_slot, old_slot);
+    }
+
+    void copy_slot_hash(slot_type* new_slot, slot_type* old_slot, std::true_type) {
+        Policy::cached_hash(new_slot) = Policy::cached_hash(old_slot);
+    }
+
+    void copy_slot_hash(slot_type*, slot_type*, std::false_type) {}
+
     hasher& hash_ref() { return std::get<1>(settings_); }
     const hasher& hash_ref() const { return std::get<1>(settings_); }
+#ifdef PHMAP_SEEDED_HASH
+    // read from the table rather than from ProcessHashSeed(), which would
+    // check that its static is initialized on every hash
+    size_t hash_seed() const { return seed_; }
+
+    // the seed goes with the slots, which were placed using it
+    void copy_hash_seed(const raw_hash_set& that) { seed_ = that.seed_; }
+    void swap_hash_seed(raw_hash_set& that) { std::swap(seed_, that.seed_); }
+#else
+    size_t hash_seed() const { return 0; }
+    void copy_hash_seed(const raw_hash_set&) {}
+    void swap_hash_seed(raw_hash_set&) {}
+#endif
     key_equal& eq_ref() { return std::get<2>(settings_); }
     const key_equal& eq_ref() const { return std::get<2>(settings_); }
     allocator_type& alloc_ref() { return std::get<3>(settings_); }
@@ -2377,6 +3098,9 @@ private:
     HashtablezInfoHandle infoz_;
     std::tuple<size_t /* growth_left */, hasher, key_equal, allocator_type>
         settings_{0, hasher{}, key_equal{}, allocator_type{}};
+#ifdef PHMAP_SEEDED_HASH
+    size_t seed_ = GetHashSeed();                 // copy of the process seed
+#endif
 };
 
 
@@ -2567,14 +3291,77 @@ inline size_t RandomSeed()
 }
 
 // ----------------------------------------------------------------------------
+// Calls `f(i)` for each `i` in [0, n), on up to `num_threads` threads (the
+// calling thread included). `num_threads == 0` means one per hardware thread.
+// If `f` throws, the remaining indices are skipped, and the first exception
+// is rethrown once all the threads are done.
 // ----------------------------------------------------------------------------
-template <size_t N,
-          template <class, class, class, class> class RefSet,
-          class Mtx_,
-          class Policy, class Hash, class Eq, class Alloc>
-class parallel_hash_set 
+inline size_t ResolveNumThreads(size_t num_threads)
 {
-    using PolicyTraits = hash_policy_traits<Policy>;
+    if (num_threads == 0)
+        num_threads = std::thread::hardware_concurrency();
+    return num_threads ? num_threads : 1;
+}
+
+template <class F>
+void ParallelForEachIndex(size_t num_threads, size_t n, F&& f)
+{
+    num_threads = (std::min)(ResolveNumThreads(num_threads), n);
+    if (num_threads <= 1) {
+        for (size_t i = 0; i < n; ++i)
+            f(i);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::atomic<bool>   failed(false);
+    std::vector<std::exception_ptr> errors(num_threads);
+
+    auto work = [&](size_t t) {
+#ifdef PHMAP_HAVE_EXCEPTIONS
+        try {
+#endif
+            for (size_t i; !failed.load(std::memory_order_relaxed) && (i = next++) < n; )
+                f(i);
+#ifdef PHMAP_HAVE_EXCEPTIONS
+        } catch (...) {
+            errors[t] = std::current_exception();
+            failed = true;
+        }
+#else
+        (void)t;
+#endif
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+#ifdef PHMAP_HAVE_EXCEPTIONS
+    try {
+#endif
+        for (size_t t = 1; t < num_threads; ++t)
+            threads.emplace_back(work, t);
+#ifdef PHMAP_HAVE_EXCEPTIONS
+    } catch (...) {
+        // could not start a thread: the ones started, and this one, do the work
+    }
+#endif
+    work(0);
+    for (auto& t : threads)
+        t.join();
+    for (auto& e : errors)
+        if (e)
+            std::rethrow_exception(e);
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+template <size_t N,
+          template <class, class, class, class> class RefSet,
+          class Mtx_,
+          class Policy, class Hash, class Eq, class Alloc>
+class parallel_hash_set 
+{
+    using PolicyTraits = hash_policy_traits<Policy>;
     using KeyArgImpl =
         KeyArg<IsTransparent<Eq>::value && IsTransparent<Hash>::value>;
 
@@ -2862,6 +3649,17 @@ public:
     parallel_hash_set(InputIter first, InputIter last, const allocator_type& alloc)
         : parallel_hash_set(first, last, 0, hasher(), key_equal(), alloc) {}
 
+    // Extension: builds the container from [first, last) on `num_threads`
+    // threads, see parallel_build().
+    //   phmap::parallel_flat_hash_map<K, V> m(phmap::parallel_build, v.begin(), v.end());
+    template <class InputIter>
+    parallel_hash_set(parallel_build_t, InputIter first, InputIter last, size_t num_threads = 0,
+                      const hasher& hash_param = hasher(), const key_equal& eq = key_equal(),
+                      const allocator_type& alloc = allocator_type())
+        : parallel_hash_set(0, hash_param, eq, alloc) {
+        parallel_build(first, last, num_threads);
+    }
+
     // Instead of accepting std::initializer_list<value_type> as the first
     // argument like std::unordered_set<value_type> does, we have two overloads
     // that accept std::initializer_list<T> and std::initializer_list<init_type>.
@@ -3076,7 +3874,24 @@ public:
 
     template <class InputIt>
     void insert(InputIt first, InputIt last) {
-        for (; first != last; ++first) insert(*first);
+        insert_range(first, last, IsKeyArray<InputIt>());
+    }
+
+    // Extension API: bulk insertion of [first, last) on `num_threads` threads
+    // (0 means one per hardware thread), with the same result as
+    // insert(first, last). When the keys are already present, or the input
+    // has duplicates, the first one inserted wins.
+    //
+    // The input is hashed once and partitioned by submap in parallel, then
+    // each submap is reserved to its final size and filled by a single
+    // thread, so there is no lock contention and no resize while filling.
+    // This needs random access iterators, with other iterators it is
+    // insert(first, last). The work memory is two size_t per element.
+    // --------------------------------------------------------------------
+    template <class InputIt>
+    void parallel_build(InputIt first, InputIt last, size_t num_threads = 0) {
+        parallel_build_impl(first, last, num_threads,
+                            typename std::iterator_traits<InputIt>::iterator_category());
     }
 
     template <class T, RequiresNotInit<T> = 0, RequiresInsertable<const T&> = 0>
@@ -3537,7 +4352,9 @@ public:
     template <typename E = Eq>
     void merge(parallel_hash_set<N, RefSet, Mtx_, Policy, Hash, E, Alloc>& src) {  // NOLINT
         assert(this != &src);
-        if (this != &src)
+        if (hash_seed() != src.hash_seed())
+            merge_reseeded(src);
+        else if (this != &src)
         {
             for (size_t i=0; i<num_tables; ++i)
             {
@@ -3552,6 +4369,76 @@ public:
         merge(src);
     }
 
+    // Extension API: parallel merge and set algebra.
+    //
+    // Containers with the same N, Hash and hash seed put a key in the same
+    // submap, so submap i of one only interacts with submap i of the other.
+    // These process the pairs of submaps on `num_threads` threads (0 means
+    // one per hardware thread), each pair under both unique locks. With
+    // PHMAP_SEEDED_HASH, containers created before and after a change of
+    // ProcessHashSeed() are instead combined one element at a time.
+    // --------------------------------------------------------------------
+
+    // same as merge(src)
+    template <typename E = Eq>
+    void parallel_merge(parallel_hash_set<N, RefSet, Mtx_, Policy, Hash, E, Alloc>& src,
+                        size_t num_threads = 0) {
+        if (static_cast<void*>(this) == static_cast<void*>(&src))
+            return;
+        if (hash_seed() != src.hash_seed())
+            return merge_reseeded(src);
+        priv::ParallelForEachIndex(num_threads, num_tables, [&](size_t i) {
+            typename Lockable::UniqueLocks l(sets_[i], src.sets_[i]);
+            sets_[i].set_.merge(src.sets_[i].set_);
+        });
+    }
+
+    // inserts a copy of the values of `other` whose key is not present
+    template <typename E = Eq>
+    void set_union(const parallel_hash_set<N, RefSet, Mtx_, Policy, Hash, E, Alloc>& other,
+                   size_t num_threads = 0) {
+        if (static_cast<const void*>(this) == static_cast<const void*>(&other))
+            return;
+        auto& src = const_cast<parallel_hash_set<N, RefSet, Mtx_, Policy, Hash, E, Alloc>&>(other);
+        if (hash_seed() != src.hash_seed()) {
+            for (auto& src_inner : src.sets_) {
+                SharedLock l(src_inner);
+                for (const auto& v : src_inner.set_) {
+                    size_t hashval = PolicyTraits::apply(HashElement{hash_ref(), hash_seed()}, v);
+                    Inner& inner = sets_[subidx(hashval)];
+                    UniqueLock m(inner);
+                    inner.set_.emplace_with_hash(hashval, v);
+                }
+            }
+            return;
+        }
+        priv::ParallelForEachIndex(num_threads, num_tables, [&](size_t i) {
+            typename Lockable::UniqueLocks l(sets_[i], src.sets_[i]);
+            auto& set = sets_[i].set_;
+            for (const auto& v : src.sets_[i].set_)
+                set.emplace_with_hash(PolicyTraits::apply(HashElement{hash_ref(), hash_seed()}, v), v);
+        });
+    }
+
+    // erases the values whose key is not in `other`
+    template <typename E = Eq>
+    void set_intersection(const parallel_hash_set<N, RefSet, Mtx_, Policy, Hash, E, Alloc>& other,
+                          size_t num_threads = 0) {
+        if (static_cast<const void*>(this) == static_cast<const void*>(&other))
+            return;
+        erase_by_membership(other, true, num_threads);
+    }
+
+    // erases the values whose key is in `other`
+    template <typename E = Eq>
+    void set_difference(const parallel_hash_set<N, RefSet, Mtx_, Policy, Hash, E, Alloc>& other,
+                        size_t num_threads = 0) {
+        if (static_cast<const void*>(this) == static_cast<const void*>(&other))
+            parallel_clear(num_threads);
+        else
+            erase_by_membership(other, false, num_threads);
+    }
+
     node_type extract(const_iterator position) {
         return position.iter_.inner_->set_.extract(EmbeddedConstIterator(position.iter_.it_));
     }
@@ -3598,6 +4485,87 @@ public:
         rehash(normalized > target ? normalized : target); 
     }
 
+    // Extension API: rehash(), reserve() and clear() processing the submaps
+    // on `num_threads` threads (0 means one per hardware thread).
+    // --------------------------------------------------------------------
+    void parallel_rehash(size_t n, size_t num_threads = 0) {
+        size_t nn = n / num_tables;
+        priv::ParallelForEachIndex(num_threads, num_tables, [&](size_t i) {
+            Inner& inner = sets_[i];
+            UniqueLock m(inner);
+            inner.set_.rehash(nn);
+        });
+    }
+
+    void parallel_reserve(size_t n, size_t num_threads = 0) {
+        size_t target = GrowthToLowerboundCapacity(n);
+        size_t normalized = num_tables * NormalizeCapacity(n / num_tables);
+        parallel_rehash(normalized > target ? normalized : target, num_threads);
+    }
+
+    void parallel_clear(size_t num_threads = 0) {
+        priv::ParallelForEachIndex(num_threads, num_tables, [&](size_t i) {
+            Inner& inner = sets_[i];
+            UniqueLock m(inner);
+            inner.set_.clear();
+        });
+    }
+
+    // Extension API: destroys all the values and frees the memory of the
+    // submaps on `num_threads` threads. Unlike clear(), which keeps the
+    // capacity, this leaves nothing for the destructor to do, so calling it
+    // first makes the destruction of a large container parallel.
+    // The values are destroyed after the submap's lock is released.
+    // --------------------------------------------------------------------
+    void parallel_release(size_t num_threads = 0) {
+        priv::ParallelForEachIndex(num_threads, num_tables, [&](size_t i) {
+            Inner& inner = sets_[i];
+            EmbeddedSet released(0, inner.set_.hash_function(), inner.set_.key_eq(),
+                                 inner.set_.get_allocator());
+            {
+                UniqueLock m(inner);
+                released.swap(inner.set_);
+            }
+        });
+    }
+
+    size_t tombstones() const {
+        size_t res = 0;
+        for (const auto& inner : sets_) {
+            SharedLock m(const_cast<Inner&>(inner));
+            res += inner.set_.tombstones();
+        }
+        return res;
+    }
+
+    // Extension API: compact() of at most `max_submaps` submaps which have
+    // tombstones, starting at submap `pos`. Returns the submap where the next
+    // call should start, or 0 after the last one. So
+    //
+    //   size_t pos = 0;
+    //   do { pos = m.compact_step(1, pos); } while (pos);
+    //
+    // compacts the whole container one submap at a time. Each submap is
+    // compacted whole, in O(its capacity), under its own unique lock, which
+    // blocks its writers as long as the rehash an insert would do once it
+    // runs out of room, but at a time chosen by the caller (e.g. a
+    // maintenance thread). The pause is shortened by using more submaps.
+    // --------------------------------------------------------------------
+    size_t compact_step(size_t max_submaps = 1, size_t pos = 0) {
+        max_submaps = (std::max)(max_submaps, size_t(1));
+        for (size_t i = pos; i < num_tables; ++i) {
+            if (max_submaps == 0)
+                return i;
+            Inner& inner = sets_[i];
+            UniqueLock m(inner);
+            if (inner.set_.tombstones() == 0)
+                continue;
+            inner.set_.compact();
+            --max_submaps;
+        }
+        return 0;
+    }
+
     // Extension API: support for heterogeneous keys.
     //
     //   std::unordered_set<std::string> s;
@@ -3670,6 +4638,57 @@ public:
         return find(key, hashval) != end();
     }
 
+    // Extension API: batched lookups, see raw_hash_set::for_each_lookup().
+    // The keys of a group can be in different submaps. With a mutex, the keys
+    // are looked up kLookupChunk at a time, while holding a shared lock on
+    // all the submaps, and f is called for the chunk once the locks are
+    // released, so it may use the map. As with find(), the pointers passed
+    // to f are then not protected from other threads changing the map.
+    // --------------------------------------------------------------------
+    enum : size_t { kLookupGroup = EmbeddedSet::kLookupGroup, kLookupChunk = 256 };
+
+    template <class K, class F>
+    void for_each_lookup(const K* keys, size_t n, F&& f, size_t group_size = kLookupGroup) {
+        auto hash_keys = [this](const K* k, size_t cnt, size_t* out) { hash_many(k, cnt, out); };
+        auto set_of    = [this](size_t hashval) -> EmbeddedSet& { return sets_[subidx(hashval)].set_; };
+        constexpr bool lockless = std::is_same<Mtx_, phmap::NullMutex>::value;
+        PHMAP_IF_CONSTEXPR (lockless) {
+            EmbeddedSet::lookup_grouped(keys, n, group_size, hash_keys, set_of, f);
+            return;
+        }
+        value_type* found[kLookupChunk];
+        for (size_t i = 0; i < n; i += kLookupChunk) {
+            const size_t cnt = (std::min)(size_t(kLookupChunk), n - i);
+            {
+                SharedLock locks[num_tables];
+                for (size_t j = 0; j < num_tables; ++j)
+                    locks[j] = SharedLock(sets_[j]);
+                size_t j = 0;
+                auto collect = [&found, &j](const K&, value_type* p) { found[j++] = p; };
+                EmbeddedSet::lookup_grouped(keys + i, cnt, group_size, hash_keys, set_of, collect);
+            }
+            for (size_t j = 0; j < cnt; ++j)
+                f(keys[i + j], found[j]);
+        }
+    }
+
+    template <class K, class F>
+    void for_each_lookup(const K* keys, size_t n, F&& f, size_t group_size = kLookupGroup) const {
+        const_cast<parallel_hash_set*>(this)->for_each_lookup(keys, n,
+            [&f](const K& key, value_type* p) { f(key, static_cast<const value_type*>(p)); },
+            group_size);
+    }
+
+    template <class Keys, class F>
+    void for_each_lookup(const Keys& keys, F&& f, size_t group_size = kLookupGroup) {
+        for_each_lookup(keys.data(), keys.size(), std::forward<F>(f), group_size);
+    }
+
+    template <class Keys, class F>
+    void for_each_lookup(const Keys& keys, F&& f, size_t group_size = kLookupGroup) const {
+        for_each_lookup(keys.data(), keys.size(), std::forward<F>(f), group_size);
+    }
+
     template <class K = key_type>
     std::pair<iterator, iterator> equal_range(const key_arg<K>& key) {
         auto it = find(key);
@@ -3710,6 +4729,18 @@ public:
     allocator_type get_allocator() const { return alloc_ref(); }
 
     friend bool operator==(const parallel_hash_set& a, const parallel_hash_set& b) {
+        if (a.hash_seed() != b.hash_seed()) {
+            // the elements are not in the same submaps
+            if (a.size() != b.size())
+                return false;
+            for (const auto& inner : a.sets_) {
+                SharedLock m(const_cast<Inner&>(inner));
+                for (const auto& elem : inner.set_)
+                    if (!b.has_element(elem))
+                        return false;
+            }
+            return true;
+        }
         return std::equal(a.sets_.begin(), a.sets_.end(), b.sets_.begin());
     }
 
@@ -3727,7 +4758,15 @@ public:
 
     template <class K>
     size_t hash(const K& key) const {
-        return HashElement{hash_ref()}(key);
+        return HashElement{hash_ref(), hash_seed()}(key);
+    }
+
+    // Extension API: out[i] = hash(keys[i]) for i in [0, n), see
+    // raw_hash_set::hash_many().
+    // --------------------------------------------------------------------
+    template <class K = key_type>
+    void hash_many(const K* keys, size_t n, size_t* out) const {
+        hash_many_impl(keys, n, out, CanMixMany<K, hasher>());
     }
 
 #if !defined(PHMAP_NON_DETERMINISTIC)
@@ -3742,6 +4781,56 @@ private:
     template <class Container, typename Enabler>
     friend struct phmap::priv::hashtable_debug_internal::HashtableDebugAccess;
 
+    template <class K>
+    void hash_many_impl(const K* keys, size_t n, size_t* out, std::true_type) const {
+        phmap_mix_many(keys, n, hash_seed(), out);
+    }
+
+    template <class K>
+    void hash_many_impl(const K* keys, size_t n, size_t* out, std::false_type) const {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = hash(keys[i]);
+    }
+
+    template <class It, bool = CanMixMany<key_type, hasher>::value &&
+                               std::is_same<value_type, key_type>::value>
+    struct IsKeyArray : std::false_type {};
+
+    template <class It>
+    struct IsKeyArray<It, true> : std::integral_constant<bool,
+        std::is_same<It, key_type*>::value || std::is_same<It, const key_type*>::value ||
+        std::is_same<It, typename std::vector<key_type>::iterator>::value ||
+        std::is_same<It, typename std::vector<key_type>::const_iterator>::value> {};
+
+    template <class InputIt>
+    void insert_range(InputIt first, InputIt last, std::false_type) {
+        for (; first != last; ++first) insert(*first);
+    }
+
+    // reserves room for the keys and hashes them a block at a time. Without
+    // locks, also prefetches the groups where they go, as
+    // raw_hash_set::insert_range() does.
+    template <class InputIt>
+    void insert_range(InputIt first, InputIt last, std::true_type) {
+        constexpr size_t kBlock = 64, kAhead = 8;
+        constexpr bool   lockless = std::is_same<Mtx_, phmap::NullMutex>::value;
+        size_t hashes[kBlock];
+        const size_t n = static_cast<size_t>(last - first);
+        this->reserve(this->size() + n);
+        for (size_t i = 0; i < n; i += kBlock) {
+            const key_type* keys = &*(first + i);
+            const size_t    cnt  = (std::min)(kBlock, n - i);
+            hash_many(keys, cnt, hashes);
+            for (size_t j = 0; j < cnt; ++j) {
+                PHMAP_IF_CONSTEXPR (lockless) {
+                    if (j + kAhead < cnt)
+                        prefetch_hash(hashes[j + kAhead]);
+                }
+                emplace_with_hash(hashes[j], keys[j]);
+            }
+        }
+    }
+
     struct FindElement 
     {
         template <class K, class... Args>
@@ -3756,12 +4845,13 @@ private:
         template <class K, class... Args>
         size_t operator()(const K& key, Args&&...) const {
 #if PHMAP_DISABLE_MIX
-            return h(key);
+            return h(key) ^ seed;
 #else
-            return phmap_mix<sizeof(size_t)>()(h(key));
+            return phmap_mix<sizeof(size_t)>()(h(key) ^ seed);
 #endif
         }
         const hasher& h;
+        size_t seed;
     };
 
     template <class K1>
@@ -3795,11 +4885,10 @@ private:
     }
 
     bool has_element(const value_type& elem) const {
-        size_t hashval = PolicyTraits::apply(HashElement{hash_ref()}, elem);
-        Inner& inner   = sets_[subidx(hashval)];
-        auto&  set     = inner.set_;
+        size_t hashval = PolicyTraits::apply(HashElement{hash_ref(), hash_seed()}, elem);
+        const Inner& inner = sets_[subidx(hashval)];
         SharedLock m(const_cast<Inner&>(inner));
-        return set.has_element(elem, hashval);
+        return inner.set_.has_element(elem, hashval);
     }
 
     // TODO(alkis): Optimize this assuming *this and that don't overlap.
@@ -3874,6 +4963,149 @@ protected:
     }
 
 private:
+    template <class Set>
+    struct ContainsElement
+    {
+        template <class K, class... Args>
+        bool operator()(const K& key, Args&&...) const {
+            return s.contains(key, hashval);
+        }
+        const Set& s;
+        size_t hashval;
+    };
+
+    // erases the values whose key is absent from `other` (keep_common), or
+    // present in `other` (!keep_common).
+    template <typename E>
+    void erase_by_membership(const parallel_hash_set<N, RefSet, Mtx_, Policy, Hash, E, Alloc>& other,
+                             bool keep_common, size_t num_threads) {
+        auto& src = const_cast<parallel_hash_set<N, RefSet, Mtx_, Policy, Hash, E, Alloc>&>(other);
+        using OtherSet = typename parallel_hash_set<N, RefSet, Mtx_, Policy, Hash, E, Alloc>::EmbeddedSet;
+        if (hash_seed() != src.hash_seed()) {
+            // the keys are looked up in `other` with its own hash seed
+            priv::ParallelForEachIndex(num_threads, num_tables, [&](size_t i) {
+                UniqueLock l(sets_[i]);
+                auto& set = sets_[i].set_;
+                for (auto it = set.begin(), last = set.end(); it != last; ) {
+                    auto cur = it++;
+                    size_t hashval = PolicyTraits::apply(HashElement{src.hash_ref(), src.hash_seed()}, *cur);
+                    auto& other_inner = src.sets_[src.subidx(hashval)];
+                    SharedLock m(other_inner);
+                    if (PolicyTraits::apply(ContainsElement<OtherSet>{other_inner.set_, hashval}, *cur) != keep_common)
+                        set._erase(cur);
+                }
+            });
+            return;
+        }
+        priv::ParallelForEachIndex(num_threads, num_tables, [&](size_t i) {
+            typename Lockable::UniqueLocks l(sets_[i], src.sets_[i]);
+            auto& set = sets_[i].set_;
+            const OtherSet& other_set = src.sets_[i].set_;
+            for (auto it = set.begin(), last = set.end(); it != last; ) {
+                auto cur = it++;
+                size_t hashval = PolicyTraits::apply(HashElement{hash_ref(), hash_seed()}, *cur);
+                if (PolicyTraits::apply(ContainsElement<OtherSet>{other_set, hashval}, *cur) != keep_common)
+                    set._erase(cur);
+            }
+        });
+    }
+
+    // merge() from a container using another hash seed, whose elements are
+    // not in the same submaps: moves them one at a time.
+    template <typename E>
+    void merge_reseeded(parallel_hash_set<N, RefSet, Mtx_, Policy, Hash, E, Alloc>& src) {
+        for (auto& src_inner : src.sets_) {
+            UniqueLock l(src_inner);
+            auto& s = src_inner.set_;
+            for (auto it = s.begin(), last = s.end(); it != last; ) {
+                auto cur = it++;
+                size_t hashval = PolicyTraits::apply(HashElement{hash_ref(), hash_seed()}, *cur);
+                Inner& inner = sets_[subidx(hashval)];
+                UniqueLock m(inner);
+                if (!PolicyTraits::apply(ContainsElement<EmbeddedSet>{inner.set_, hashval}, *cur))
+                    inner.set_.insert(s.extract(cur), hashval);
+            }
+        }
+    }
+
+    template <class InputIt>
+    void parallel_build_impl(InputIt first, InputIt last, size_t, std::input_iterator_tag) {
+        insert(first, last);
+    }
+
+    // hashes[i] = hash of the element at first + i, for i in [b, e)
+    template <class RandomIt>
+    void hash_chunk(RandomIt first, size_t b, size_t e, size_t* hashes, std::false_type) const {
+        for (size_t i = b; i < e; ++i)
+            hashes[i] = PolicyTraits::apply(HashElement{hash_ref(), hash_seed()}, *(first + i));
+    }
+
+    template <class RandomIt>
+    void hash_chunk(RandomIt first, size_t b, size_t e, size_t* hashes, std::true_type) const {
+        if (b < e)
+            hash_many(&*(first + b), e - b, hashes + b);
+    }
+
+    template <class RandomIt>
+    void parallel_build_impl(RandomIt first, RandomIt last, size_t num_threads,
+                             std::random_access_iterator_tag) {
+        const size_t n = static_cast<size_t>(last - first);
+        if (n == 0)
+            return;
+
+        // the input is split in one chunk per thread, but small inputs don't
+        // get more threads than they can keep busy.
+        const size_t min_chunk  = 4096;
+        const size_t num_chunks = (std::max)(size_t(1),
+            (std::min)(priv::ResolveNumThreads(num_threads), n / min_chunk));
+        auto chunk_start = [&](size_t c) { return c == num_chunks ? n : n / num_chunks * c; };
+
+        // pass 1: hash each element, and count the elements of each chunk
+        // going to each submap.
+        std::vector<size_t> hashes(n);
+        std::vector<size_t> pos(num_chunks * num_tables, 0);   // [chunk * num_tables + submap]
+        priv::ParallelForEachIndex(num_chunks, num_chunks, [&](size_t c) {
+            size_t* cnt = &pos[c * num_tables];
+            const size_t b = chunk_start(c), e = chunk_start(c + 1);
+            hash_chunk(first, b, e, &hashes[0], IsKeyArray<RandomIt>());
+            for (size_t i = b; i < e; ++i)
+                ++cnt[subidx(hashes[i])];
+        });
+
+        // each submap gets a contiguous range of `order`, in which the chunks
+        // keep the input order. The counts become start positions.
+        std::array<size_t, num_tables + 1> submap_start;
+        size_t start = 0;
+        for (size_t s = 0; s < num_tables; ++s) {
+            submap_start[s] = start;
+            for (size_t c = 0; c < num_chunks; ++c) {
+                size_t cnt = pos[c * num_tables + s];
+                pos[c * num_tables + s] = start;
+                start += cnt;
+            }
+        }
+        submap_start[num_tables] = n;
+
+        std::vector<size_t> order(n);
+        priv::ParallelForEachIndex(num_chunks, num_chunks, [&](size_t c) {
+            size_t* next = &pos[c * num_tables];
+            for (size_t i = chunk_start(c), e = chunk_start(c + 1); i < e; ++i)
+                order[next[subidx(hashes[i])]++] = i;
+        });
+
+        // pass 2: fill the submaps independently.
+        priv::ParallelForEachIndex(num_threads, num_tables, [&](size_t s) {
+            Inner& inner = sets_[s];
+            UniqueLock m(inner);
+            auto& set = inner.set_;
+            set.reserve(set.size() + (submap_start[s + 1] - submap_start[s]));
+            for (size_t j = submap_start[s]; j < submap_start[s + 1]; ++j) {
+                size_t i = order[j];
+                set.emplace_with_hash(hashes[i], *(first + i));
+            }
+        });
+    }
+
     friend struct RawHashSetTestOnlyAccess;
 
     size_t growth_left() { 
@@ -3885,6 +5117,7 @@ private:
 
     hasher&       hash_ref()        { return sets_[0].set_.hash_ref(); }
     const hasher& hash_ref() const  { return sets_[0].set_.hash_ref(); }
+    size_t        hash_seed() const { return sets_[0].set_.hash_seed(); }
     key_equal&       eq_ref()       { return sets_[0].set_.eq_ref(); }
     const key_equal& eq_ref() const { return sets_[0].set_.eq_ref(); }
     allocator_type&  alloc_ref()    { return sets_[0].set_.alloc_ref(); }
@@ -4483,6 +5716,50 @@ public:
     static const Value& value(const value_type* elem) { return elem->second; }
 };
 
+// --------------------------------------------------------------------------
+// Wraps a flat or node policy, storing the (mixed) hash of each element next
+// to it in the slot. The table then never calls the hasher on elements it
+// already contains (resize, drop_deletes, copy), and H2 matches whose full hash
+// differ are rejected before calling Eq. Worth it for keys whose hash or
+// equality is expensive, such as long strings.
+// --------------------------------------------------------------------------
+template <class Policy>
+struct HashCachingPolicy : Policy
+{
+    using caches_hash = std::true_type;
+
+    struct slot_type {
+        size_t hashval;
+        typename Policy::slot_type slot;
+    };
+
+    static size_t& cached_hash(slot_type* slot) { return slot->hashval; }
+
+    template <class Allocator, class... Args>
+    static void construct(Allocator* alloc, slot_type* slot, Args&&... args) {
+        Policy::construct(alloc, &slot->slot, std::forward<Args>(args)...);
+    }
+
+    template <class Allocator>
+    static void destroy(Allocator* alloc, slot_type* slot) {
+        Policy::destroy(alloc, &slot->slot);
+    }
+
+    // the hash is maintained by raw_hash_set, which knows whether it is valid
+    template <class Allocator>
+    static void transfer(Allocator* alloc, slot_type* new_slot, slot_type* old_slot) {
+        hash_policy_traits<Policy>::transfer(alloc, &new_slot->slot, &old_slot->slot);
+    }
+
+    static auto element(slot_type* slot) -> decltype(Policy::element(&slot->slot)) {
+        return Policy::element(&slot->slot);
+    }
+
+    static size_t space_used(const slot_type* slot) {
+        return Policy::space_used(slot ? &slot->slot : nullptr);
+    }
+};
+
 
 // --------------------------------------------------------------------------
 //  hash_default
@@ -4625,7 +5902,7 @@ struct HashtableDebugAccess<Set, typename std::enable_if<has_member_type_raw_has
         size_t capacity = c.capacity_;
         if (capacity == 0) return 0;
         auto layout = Set::MakeLayout(capacity);
-        size_t m = layout.AllocSize();
+        size_t m = c.is_inline() ? 0 : layout.AllocSize();
 
         size_t per_slot = Traits::space_used(static_cast<const Slot*>(nullptr));
         if (per_slot != ~size_t{}) {
@@ -4727,6 +6004,8 @@ public:
     using Base::swap;
     using Base::rehash;
     using Base::reserve;
+    using Base::compact;
+    using Base::tombstones;
     using Base::contains;
     using Base::count;
     using Base::equal_range;
@@ -4791,6 +6070,123 @@ public:
     using Base::swap;
     using Base::rehash;
     using Base::reserve;
+    using Base::compact;
+    using Base::tombstones;
+    using Base::at;
+    using Base::contains;
+    using Base::count;
+    using Base::equal_range;
+    using Base::find;
+    using Base::operator[];
+    using Base::bucket_count;
+    using Base::load_factor;
+    using Base::max_load_factor;
+    using Base::get_allocator;
+    using Base::hash_function;
+    using Base::hash;
+    using Base::key_eq;
+};
+
+// -----------------------------------------------------------------------------
+// phmap::inline_flat_hash_set
+// -----------------------------------------------------------------------------
+// A `phmap::flat_hash_set<T>` which stores up to `N` elements (and their
+// control bytes) inside the object itself, so that small sets do not allocate.
+// Lookups in the inline storage use the same SIMD group scans as the heap
+// layout, which is used as soon as the set grows past its inline capacity.
+//
+// In addition to the flat_hash_set invalidation rules, moving or swapping an
+// inline set invalidates iterators, references and pointers to its elements.
+// -----------------------------------------------------------------------------
+template <class T, size_t N, class Hash, class Eq, class Alloc> // default values in phmap_fwd_decl.h
+class inline_flat_hash_set
+    : public phmap::priv::raw_hash_set<
+          phmap::priv::InlinePolicy<phmap::priv::FlatHashSetPolicy<T>, N>, Hash, Eq, Alloc> 
+{
+    using Base = typename inline_flat_hash_set::raw_hash_set;
+
+public:
+    inline_flat_hash_set() {}
+#ifdef __INTEL_COMPILER
+    using Base::raw_hash_set;
+#else
+    using Base::Base;
+#endif
+    using Base::begin;
+    using Base::cbegin;
+    using Base::cend;
+    using Base::end;
+    using Base::capacity;
+    using Base::empty;
+    using Base::max_size;
+    using Base::size;
+    using Base::clear;
+    using Base::erase;
+    using Base::insert;
+    using Base::emplace;
+    using Base::emplace_hint; 
+    using Base::extract;
+    using Base::merge;
+    using Base::swap;
+    using Base::rehash;
+    using Base::reserve;
+    using Base::compact;
+    using Base::tombstones;
+    using Base::contains;
+    using Base::count;
+    using Base::equal_range;
+    using Base::find;
+    using Base::bucket_count;
+    using Base::load_factor;
+    using Base::max_load_factor;
+    using Base::get_allocator;
+    using Base::hash_function;
+    using Base::hash;
+    using Base::key_eq;
+};
+
+// -----------------------------------------------------------------------------
+// phmap::inline_flat_hash_map
+// -----------------------------------------------------------------------------
+// A `phmap::flat_hash_map<K, V>` which stores up to `N` elements (and their
+// control bytes) inside the object itself, see inline_flat_hash_set.
+// Meant for the many tiny maps case (e.g. per-object attribute bags).
+// -----------------------------------------------------------------------------
+template <class K, class V, size_t N, class Hash, class Eq, class Alloc> // default values in phmap_fwd_decl.h
+class inline_flat_hash_map : public phmap::priv::raw_hash_map<
+                                 phmap::priv::InlinePolicy<phmap::priv::FlatHashMapPolicy<K, V>, N>,
+                                 Hash, Eq, Alloc> {
+    using Base = typename inline_flat_hash_map::raw_hash_map;
+
+public:
+    inline_flat_hash_map() {}
+#ifdef __INTEL_COMPILER
+    using Base::raw_hash_map;
+#else
+    using Base::Base;
+#endif
+    using Base::begin;
+    using Base::cbegin;
+    using Base::cend;
+    using Base::end;
+    using Base::capacity;
+    using Base::empty;
+    using Base::max_size;
+    using Base::size;
+    using Base::clear;
+    using Base::erase;
+    using Base::insert;
+    using Base::insert_or_assign;
+    using Base::emplace;
+    using Base::emplace_hint;
+    using Base::try_emplace;
+    using Base::extract;
+    using Base::merge;
+    using Base::swap;
+    using Base::rehash;
+    using Base::reserve;
+    using Base::compact;
+    using Base::tombstones;
     using Base::at;
     using Base::contains;
     using Base::count;
@@ -4855,6 +6251,8 @@ public:
     using Base::swap;
     using Base::rehash;
     using Base::reserve;
+    using Base::compact;
+    using Base::tombstones;
     using Base::contains;
     using Base::count;
     using Base::equal_range;
@@ -4921,6 +6319,237 @@ public:
     using Base::swap;
     using Base::rehash;
     using Base::reserve;
+    using Base::compact;
+    using Base::tombstones;
+    using Base::at;
+    using Base::contains;
+    using Base::count;
+    using Base::equal_range;
+    using Base::find;
+    using Base::operator[];
+    using Base::bucket_count;
+    using Base::load_factor;
+    using Base::max_load_factor;
+    using Base::get_allocator;
+    using Base::hash_function;
+    using Base::hash;
+    using Base::key_eq;
+    typename Base::hasher hash_funct() { return this->hash_function(); }
+    void resize(typename Base::size_type hint) { this->rehash(hint); }
+};
+
+// -----------------------------------------------------------------------------
+// phmap::cached_hash_flat_hash_set
+// -----------------------------------------------------------------------------
+// Same as `phmap::flat_hash_set`, but the hash of each element is stored next to it
+// (see priv::HashCachingPolicy). Growing the table never calls the hasher, and
+// lookups only call Eq on elements whose full hash matches. This costs an
+// extra size_t per slot, and pays off for keys with expensive hash or
+// equality (e.g. long strings).
+// -----------------------------------------------------------------------------
+template <class T, class Hash, class Eq, class Alloc> // default values in phmap_fwd_decl.h
+class cached_hash_flat_hash_set
+    : public phmap::priv::raw_hash_set<
+          phmap::priv::HashCachingPolicy<phmap::priv::FlatHashSetPolicy<T>>, Hash, Eq, Alloc> 
+{
+    using Base = typename cached_hash_flat_hash_set::raw_hash_set;
+
+public:
+    cached_hash_flat_hash_set() {}
+#ifdef __INTEL_COMPILER
+    using Base::raw_hash_set;
+#else
+    using Base::Base;
+#endif
+    using Base::begin;
+    using Base::cbegin;
+    using Base::cend;
+    using Base::end;
+    using Base::capacity;
+    using Base::empty;
+    using Base::max_size;
+    using Base::size;
+    using Base::clear; // may shrink - To avoid shrinking `erase(begin(), end())`
+    using Base::erase;
+    using Base::insert;
+    using Base::emplace;
+    using Base::emplace_hint; 
+    using Base::extract;
+    using Base::merge;
+    using Base::swap;
+    using Base::rehash;
+    using Base::reserve;
+    using Base::compact;
+    using Base::tombstones;
+    using Base::contains;
+    using Base::count;
+    using Base::equal_range;
+    using Base::find;
+    using Base::bucket_count;
+    using Base::load_factor;
+    using Base::max_load_factor;
+    using Base::get_allocator;
+    using Base::hash_function;
+    using Base::hash;
+    using Base::key_eq;
+};
+
+// -----------------------------------------------------------------------------
+// phmap::cached_hash_flat_hash_map
+// -----------------------------------------------------------------------------
+// Same as `phmap::flat_hash_map`, with the hash of each element cached in its slot
+// (see cached_hash_flat_hash_set).
+// -----------------------------------------------------------------------------
+template <class K, class V, class Hash, class Eq, class Alloc> // default values in phmap_fwd_decl.h
+class cached_hash_flat_hash_map : public phmap::priv::raw_hash_map<
+                          phmap::priv::HashCachingPolicy<phmap::priv::FlatHashMapPolicy<K, V>>,
+                          Hash, Eq, Alloc> {
+    using Base = typename cached_hash_flat_hash_map::raw_hash_map;
+
+public:
+    cached_hash_flat_hash_map() {}
+#ifdef __INTEL_COMPILER
+    using Base::raw_hash_map;
+#else
+    using Base::Base;
+#endif
+    using Base::begin;
+    using Base::cbegin;
+    using Base::cend;
+    using Base::end;
+    using Base::capacity;
+    using Base::empty;
+    using Base::max_size;
+    using Base::size;
+    using Base::clear;
+    using Base::erase;
+    using Base::insert;
+    using Base::insert_or_assign;
+    using Base::emplace;
+    using Base::emplace_hint;
+    using Base::try_emplace;
+    using Base::extract;
+    using Base::merge;
+    using Base::swap;
+    using Base::rehash;
+    using Base::reserve;
+    using Base::compact;
+    using Base::tombstones;
+    using Base::at;
+    using Base::contains;
+    using Base::count;
+    using Base::equal_range;
+    using Base::find;
+    using Base::operator[];
+    using Base::bucket_count;
+    using Base::load_factor;
+    using Base::max_load_factor;
+    using Base::get_allocator;
+    using Base::hash_function;
+    using Base::hash;
+    using Base::key_eq;
+};
+
+// -----------------------------------------------------------------------------
+// phmap::cached_hash_node_hash_set
+// -----------------------------------------------------------------------------
+// Same as `phmap::node_hash_set`, with the hash of each element cached in its slot
+// (see cached_hash_flat_hash_set).
+// -----------------------------------------------------------------------------
+template <class T, class Hash, class Eq, class Alloc> // default values in phmap_fwd_decl.h
+class cached_hash_node_hash_set
+    : public phmap::priv::raw_hash_set<
+          phmap::priv::HashCachingPolicy<phmap::priv::NodeHashSetPolicy<T>>, Hash, Eq, Alloc> 
+{
+    using Base = typename cached_hash_node_hash_set::raw_hash_set;
+
+public:
+    cached_hash_node_hash_set() {}
+#ifdef __INTEL_COMPILER
+    using Base::raw_hash_set;
+#else
+    using Base::Base;
+#endif
+    using Base::begin;
+    using Base::cbegin;
+    using Base::cend;
+    using Base::end;
+    using Base::capacity;
+    using Base::empty;
+    using Base::max_size;
+    using Base::size;
+    using Base::clear;
+    using Base::erase;
+    using Base::insert;
+    using Base::emplace;
+    using Base::emplace_hint;
+    using Base::emplace_with_hash;
+    using Base::emplace_hint_with_hash;
+    using Base::extract;
+    using Base::merge;
+    using Base::swap;
+    using Base::rehash;
+    using Base::reserve;
+    using Base::compact;
+    using Base::tombstones;
+    using Base::contains;
+    using Base::count;
+    using Base::equal_range;
+    using Base::find;
+    using Base::bucket_count;
+    using Base::load_factor;
+    using Base::max_load_factor;
+    using Base::get_allocator;
+    using Base::hash_function;
+    using Base::hash;
+    using Base::key_eq;
+    typename Base::hasher hash_funct() { return this->hash_function(); }
+    void resize(typename Base::size_type hint) { this->rehash(hint); }
+};
+
+// -----------------------------------------------------------------------------
+// phmap::cached_hash_node_hash_map
+// -----------------------------------------------------------------------------
+// Same as `phmap::node_hash_map`, with the hash of each element cached in its slot
+// (see cached_hash_flat_hash_set).
+// -----------------------------------------------------------------------------
+template <class Key, class Value, class Hash, class Eq, class Alloc>  // default values in phmap_fwd_decl.h
+class cached_hash_node_hash_map
+    : public phmap::priv::raw_hash_map<
+          phmap::priv::HashCachingPolicy<phmap::priv::NodeHashMapPolicy<Key, Value>>, Hash, Eq,
+          Alloc> 
+{
+    using Base = typename cached_hash_node_hash_map::raw_hash_map;
+
+public:
+    cached_hash_node_hash_map() {}
+#ifdef __INTEL_COMPILER
+    using Base::raw_hash_map;
+#else
+    using Base::Base;
+#endif
+    using Base::begin;
+    using Base::cbegin;
+    using Base::cend;
+    using Base::end;
+    using Base::capacity;
+    using Base::empty;
+    using Base::max_size;
+    using Base::size;
+    using Base::clear;
+    using Base::erase;
+    using Base::insert;
+    using Base::insert_or_assign;
+    using Base::emplace;
+    using Base::emplace_hint;
+    using Base::try_emplace;
+    using Base::extract;
+    using Base::merge;
+    using Base::swap;
+    using Base::rehash;
+    using Base::reserve;
+    using Base::compact;
+    using Base::tombstones;
     using Base::at;
     using Base::contains;
     using Base::count;
@@ -4971,15 +6600,26 @@ public:
     using Base::clear;
     using Base::erase;
     using Base::insert;
+    using Base::parallel_build;
     using Base::emplace;
     using Base::emplace_hint;
     using Base::emplace_with_hash;
     using Base::emplace_hint_with_hash;
     using Base::extract;
     using Base::merge;
+    using Base::parallel_merge;
+    using Base::set_union;
+    using Base::set_intersection;
+    using Base::set_difference;
     using Base::swap;
     using Base::rehash;
     using Base::reserve;
+    using Base::compact_step;
+    using Base::tombstones;
+    using Base::parallel_rehash;
+    using Base::parallel_reserve;
+    using Base::parallel_clear;
+    using Base::parallel_release;
     using Base::contains;
     using Base::count;
     using Base::equal_range;
@@ -5024,6 +6664,7 @@ public:
     using Base::clear;
     using Base::erase;
     using Base::insert;
+    using Base::parallel_build;
     using Base::insert_or_assign;
     using Base::emplace;
     using Base::emplace_hint;
@@ -5033,9 +6674,19 @@ public:
     using Base::try_emplace_with_hash;
     using Base::extract;
     using Base::merge;
+    using Base::parallel_merge;
+    using Base::set_union;
+    using Base::set_intersection;
+    using Base::set_difference;
     using Base::swap;
     using Base::rehash;
     using Base::reserve;
+    using Base::compact_step;
+    using Base::tombstones;
+    using Base::parallel_rehash;
+    using Base::parallel_reserve;
+    using Base::parallel_clear;
+    using Base::parallel_release;
     using Base::at;
     using Base::contains;
     using Base::count;
@@ -5082,15 +6733,26 @@ public:
     using Base::clear;
     using Base::erase;
     using Base::insert;
+    using Base::parallel_build;
     using Base::emplace;
     using Base::emplace_hint;
     using Base::emplace_with_hash;
     using Base::emplace_hint_with_hash;
     using Base::extract;
     using Base::merge;
+    using Base::parallel_merge;
+    using Base::set_union;
+    using Base::set_intersection;
+    using Base::set_difference;
     using Base::swap;
     using Base::rehash;
     using Base::reserve;
+    using Base::compact_step;
+    using Base::tombstones;
+    using Base::parallel_rehash;
+    using Base::parallel_reserve;
+    using Base::parallel_clear;
+    using Base::parallel_release;
     using Base::contains;
     using Base::count;
     using Base::equal_range;
@@ -5138,6 +6800,7 @@ public:
     using Base::clear;
     using Base::erase;
     using Base::insert;
+    using Base::parallel_build;
     using Base::insert_or_assign;
     using Base::emplace;
     using Base::emplace_hint;
@@ -5147,9 +6810,19 @@ public:
     using Base::try_emplace_with_hash;
     using Base::extract;
     using Base::merge;
+    using Base::parallel_merge;
+    using Base::set_union;
+    using Base::set_intersection;
+    using Base::set_difference;
     using Base::swap;
     using Base::rehash;
     using Base::reserve;
+    using Base::compact_step;
+    using Base::tombstones;
+    using Base::parallel_rehash;
+    using Base::parallel_reserve;
+    using Base::parallel_clear;
+    using Base::parallel_release;
     using Base::at;
     using Base::contains;
     using Base::count;
@@ -4592,6 +4592,168 @@ public:
 }  // phmap
 
 
+namespace phmap {
+
+// -----------------------------------------------------------------------------
+// arena
+// -----------------------------------------------------------------------------
+// A monotonic (bump) memory region, meant for tables which are built once per
+// request or batch and then thrown away as a whole.
+//
+// allocate() carves memory out of the current chunk, and deallocate() does
+// nothing, so the ctrl/slot arrays left behind when a table grows are only
+// reclaimed by reset() or release(). Because growth is geometric, this wastes
+// at most the size of the final table (less if you reserve() upfront).
+//
+// reset() rewinds the arena and keeps its memory for the next cycle, so that
+// after a warm-up, building a table no longer hits the system allocator at all.
+// All tables using the arena must be cleared or destroyed before reset().
+//
+// Not thread safe: share an arena across threads only with external locking.
+// -----------------------------------------------------------------------------
+class arena
+{
+public:
+    explicit arena(size_t initial_size = 4096) :
+        next_size_(initial_size < 256 ? 256 : initial_size)
+    {}
+
+    arena(const arena&) = delete;
+    arena& operator=(const arena&) = delete;
+
+    ~arena() { release(); }
+
+    void* allocate(size_t n, size_t align = alignof(std::max_align_t)) {
+        assert(align && (align & (align - 1)) == 0 && "alignment must be a power of 2");
+        uintptr_t p   = align_up(reinterpret_cast<uintptr_t>(cur_), align);
+        uintptr_t end = reinterpret_cast<uintptr_t>(end_);
+        if (cur_ == nullptr || p > end || n > end - p) {   // the padding may overshoot end_
+            add_chunk(n + align);
+            p = align_up(reinterpret_cast<uintptr_t>(cur_), align);
+        }
+        cur_ = reinterpret_cast<char*>(p + n);
+        used_ += n;
+        return reinterpret_cast<void*>(p);
+    }
+
+    // memory is only given back by reset() or release()
+    void deallocate(void*, size_t) noexcept {}
+
+    // Make all the memory available again. If the last cycle needed more than
+    // one chunk, they are coalesced so the next cycle fits in a single one.
+    void reset() {
+        if (head_ && head_->next) {
+            size_t total = reserved_;
+            release();
+            next_size_ = total;
+            add_chunk(total - sizeof(chunk));
+        }
+        if (head_)
+            cur_ = reinterpret_cast<char*>(head_ + 1);
+        used_ = 0;
+    }
+
+    // give all the memory back to the system
+    void release() noexcept {
+        while (head_) {
+            chunk* next = head_->next;
+            ::operator delete(head_);
+            head_ = next;
+        }
+        cur_ = end_ = nullptr;
+        used_ = reserved_ = 0;
+    }
+
+    size_t bytes_used() const     { return used_; }     // handed out since last reset()
+    size_t bytes_reserved() const { return reserved_; } // obtained from the system
+
+private:
+    struct chunk {
+        chunk* next;
+        size_t size;
+    };
+
+    static uintptr_t align_up(uintptr_t p, size_t align) {
+        return (p + align - 1) & ~static_cast<uintptr_t>(align - 1);
+    }
+
+    void add_chunk(size_t min_size) {
+        size_t sz = (std::max)(next_size_, min_size + sizeof(chunk));
+        chunk* c = static_cast<chunk*>(::operator new(sz));
+        c->next = head_;
+        c->size = sz;
+        head_ = c;
+        cur_  = reinterpret_cast<char*>(c + 1);
+        end_  = reinterpret_cast<char*>(c) + sz;
+        reserved_ += sz;
+        next_size_ = sz * 2;
+    }
+
+    chunk* head_      = nullptr;
+    char*  cur_       = nullptr;
+    char*  end_       = nullptr;
+    size_t used_      = 0;
+    size_t reserved_  = 0;
+    size_t next_size_;
+};
+
+// -----------------------------------------------------------------------------
+// arena_allocator
+// -----------------------------------------------------------------------------
+// Allocator handing out memory from a phmap::arena, see arena_flat_hash_map
+// and arena_flat_hash_set in phmap_fwd_decl.h.
+//
+//     phmap::arena a;
+//     phmap::arena_flat_hash_map<int, int> m(a);
+//     ... fill and use m ...
+//     m.clear();   // O(1) when values are trivially destructible
+//     a.reset();   // memory is reused for the next request
+// -----------------------------------------------------------------------------
+template <class T>
+class arena_allocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_swap = std::true_type;
+
+    arena_allocator(arena& a) noexcept : arena_(&a) {}
+
+    template <class U>
+    arena_allocator(const arena_allocator<U>& o) noexcept : arena_(o.get_arena()) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) noexcept {}
+
+    arena* get_arena() const noexcept { return arena_; }
+
+    template <class U>
+    bool operator==(const arena_allocator<U>& o) const noexcept { return arena_ == o.get_arena(); }
+
+    template <class U>
+    bool operator!=(const arena_allocator<U>& o) const noexcept { return arena_ != o.get_arena(); }
+
+private:
+    arena* arena_;
+};
+
+namespace priv {
+
+// Allocators whose deallocate() is a no-op, so that the hash tables can
+// drop their storage on clear() without giving it back.
+// Specialize for your own monotonic allocators.
+template <class Alloc>
+struct is_monotonic_allocator : std::false_type {};
+
+template <class T>
+struct is_monotonic_allocator<arena_allocator<T>> : std::true_type {};
+
+}  // namespace priv
+}  // phmap
+
+
 namespace phmap {
 
 #ifdef BOOST_THREAD_LOCK_OPTIONS_HPP
@@ -0,0 +1,323 @@
+#if !defined(phmap_combining_h_guard_)
+#define phmap_combining_h_guard_
+
+// ---------------------------------------------------------------------------
+// Copyright (c) 2019, Gregory Popovitch - greg7mdp@gmail.com
+//
+//       providing parallel_combining_map
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ---------------------------------------------------------------------------
+
+#include <array>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "phmap.h"
+
+namespace phmap {
+
+// tag for the upsert_async() which returns a std::future
+struct with_future_t {};
+PHMAP_INTERNAL_INLINE_CONSTEXPR(with_future_t, with_future, {});
+
+namespace priv {
+
+// ---------------------------------------------------------------------------
+// An upsert waiting to be applied by the thread which holds the lock of its
+// submap. apply() may destroy the operation (upsert_async) or let its owner
+// return (upsert), so the combiner reads next before calling it.
+// ---------------------------------------------------------------------------
+template <class K, class V>
+struct combining_op
+{
+    combining_op(size_t h) : hashval(h) {}
+    virtual ~combining_op() {}
+
+    virtual const K& key() const = 0;
+    virtual void     apply(V& v, bool inserted) = 0;
+
+    combining_op* next = nullptr;
+    size_t        hashval;
+};
+
+// ---------------------------------------------------------------------------
+// Per submap publication list: a stack of the pending operations, pushed
+// with a CAS by any thread, and emptied with an exchange by the combiner.
+// combining is set while a combiner is draining the list, so that
+// upsert_async() can return as soon as its operation is pushed. Aligned on a
+// cache line, as each one is hammered by the threads using its submap.
+// ---------------------------------------------------------------------------
+template <class K, class V>
+struct alignas(PHMAP_CACHELINE_SIZE) combining_slot
+{
+    combining_slot() {}
+    combining_slot(const combining_slot&) {}   // the copies start empty
+    combining_slot& operator=(const combining_slot&) { return *this; }
+
+    void push(combining_op<K, V>* op) {
+        op->next = head.load(std::memory_order_relaxed);
+        while (!head.compare_exchange_weak(op->next, op))
+            ;
+    }
+
+    std::atomic<combining_op<K, V>*> head{nullptr};
+    std::atomic<bool>                combining{false};
+};
+
+}  // namespace priv
+
+// -----------------------------------------------------------------------------
+// phmap::parallel_combining_map
+// -----------------------------------------------------------------------------
+// A parallel_flat_hash_map with a mutex, with upserts which are delegated to
+// the thread holding the submap lock (flat combining), for workloads where
+// many threads update a few hot keys:
+//
+//     phmap::parallel_combining_map<std::string, size_t> counts;
+//     counts.upsert(word, [](size_t& n) { ++n; });           // in many threads
+//
+// upsert() pushes the operation on a list of its submap, then whichever
+// thread gets the lock applies all the operations of the list in one go
+// while the others wait for theirs to be done, instead of each one taking
+// the lock (and moving its cache line) in turn.
+//
+// upsert_async() does not wait when another thread is applying the
+// operations of the submap. The operation is then copied to the heap, and
+// with with_future the returned std::future<bool> is ready once it is
+// applied. Without it, the update is visible to the other operations of the
+// map once the combiner releases the lock.
+//
+// fn receives the mapped value, value initialized for a new key, and the
+// upserts of a submap are applied in the order in which they are posted. fn
+// runs on another thread than the caller, with the submap locked, so it must
+// not access the map, and neither fn nor the constructor of V may throw.
+// The other member functions of parallel_flat_hash_map lock the submaps as
+// usual.
+// -----------------------------------------------------------------------------
+template <class K, class V,
+          class Hash  = phmap::priv::hash_default_hash<K>,
+          class Eq    = phmap::priv::hash_default_eq<K>,
+          class Alloc = phmap::priv::Allocator<phmap::priv::Pair<const K, V>>,
+          size_t N    = 4,                          // 2**N submaps
+          class Mutex = std::mutex>
+class parallel_combining_map
+    : public phmap::parallel_flat_hash_map<K, V, Hash, Eq, Alloc, N, Mutex>
+{
+    using Base        = typename parallel_combining_map::parallel_flat_hash_map;
+    using Inner       = typename Base::Inner;
+    using Lockable    = phmap::LockableImpl<Mutex>;
+    using UniqueLock  = typename Lockable::UniqueLock;
+    using EmbeddedSet = typename Base::EmbeddedSet;
+    using op_base     = priv::combining_op<K, V>;
+    using slot        = priv::combining_slot<K, V>;
+
+    static_assert(!std::is_same<Mutex, phmap::NullMutex>::value,
+                  "parallel_combining_map needs a mutex");
+
+    // upsert(): on the stack of the waiting thread
+    template <class F>
+    struct sync_op : op_base
+    {
+        sync_op(const K& k, size_t h, F& f) : op_base(h), k_(k), f_(f) {}
+
+        const K& key() const override { return k_; }
+        void apply(V& v, bool inserted) override {
+            f_(v);
+            inserted_ = inserted;
+            done_.store(true, std::memory_order_release);
+        }
+
+        const K&          k_;
+        F&                f_;
+        bool              inserted_ = false;
+        std::atomic<bool> done_{false};
+    };
+
+    // upsert_async(): owned by the list until applied
+    template <class F, bool WithFuture>
+    struct async_op : op_base
+    {
+        async_op(const K& k, size_t h, F&& f) : op_base(h), k_(k), f_(std::forward<F>(f)) {}
+
+        const K& key() const override { return k_; }
+        void apply(V& v, bool inserted) override {
+            f_(v);
+            fulfill(promise_, inserted);
+            delete this;
+        }
+
+        static void fulfill(std::promise<bool>& p, bool inserted) { p.set_value(inserted); }
+        static void fulfill(char&, bool) {}
+
+        K                                                                k_;
+        typename std::decay<F>::type                                     f_;
+        typename std::conditional<WithFuture, std::promise<bool>, char>::type promise_;
+    };
+
+public:
+    parallel_combining_map() {}
+#ifdef __INTEL_COMPILER
+    using Base::parallel_flat_hash_map;
+#else
+    using Base::Base;
+#endif
+
+    // Applies fn to the value of key, inserted if missing, and returns once
+    // it is done. Returns true if key was inserted.
+    // -----------------------------------------------------------------
+    template <class F>
+    bool upsert(const K& key, F&& fn) {
+        size_t hashval  = this->hash(key);
+        size_t idx      = this->subidx(hashval);
+        bool   inserted = false;
+        if (try_apply_now(idx, key, hashval, fn, inserted))
+            return inserted;
+        sync_op<F> op(key, hashval, fn);
+        slots_[idx].push(&op);
+        for (unsigned spins = 0; !op.done_.load(std::memory_order_acquire); ++spins) {
+            if (try_combine(idx))
+                break;                  // applied by us, or by the previous combiner
+            backoff(spins);
+        }
+        return op.inserted_;
+    }
+
+    // Same as upsert(), but returns as soon as another thread is applying
+    // the upserts of the submap, which will apply this one as well.
+    // -----------------------------------------------------------------
+    template <class F>
+    void upsert_async(const K& key, F&& fn) {
+        size_t hashval  = this->hash(key);
+        size_t idx      = this->subidx(hashval);
+        bool   inserted = false;
+        if (!try_apply_now(idx, key, hashval, fn, inserted))
+            post(idx, new async_op<F, false>(key, hashval, std::forward<F>(fn)));
+    }
+
+    template <class F>
+    std::future<bool> upsert_async(const K& key, F&& fn, with_future_t) {
+        size_t hashval  = this->hash(key);
+        size_t idx      = this->subidx(hashval);
+        bool   inserted = false;
+        if (try_apply_now(idx, key, hashval, fn, inserted)) {
+            std::promise<bool> done;
+            done.set_value(inserted);
+            return done.get_future();
+        }
+        auto op = new async_op<F, true>(key, hashval, std::forward<F>(fn));
+        std::future<bool> res = op->promise_.get_future();
+        post(idx, op);
+        return res;
+    }
+
+private:
+    void post(size_t idx, op_base* op) {
+        slot& s = slots_[idx];
+        s.push(op);
+        // when combining is seen set after the push, the combiner has yet
+        // to look at the list for the last time, see combine_locked()
+        for (unsigned spins = 0; !s.combining.load(); ++spins) {
+            if (try_combine(idx))
+                break;
+            backoff(spins);
+        }
+    }
+
+    // When no upsert is pending on submap idx and its lock is free, applies
+    // fn right away, without pushing it, then the upserts pushed meanwhile.
+    template <class F>
+    bool try_apply_now(size_t idx, const K& key, size_t hashval, F& fn, bool& inserted) {
+        Inner& inner = this->sets_[idx];
+        slot&  s     = slots_[idx];
+        if (s.head.load(std::memory_order_relaxed))
+            return false;
+        UniqueLock m(inner, phmap::defer_lock_t());
+        if (!m.try_lock())
+            return false;
+        fn(value_of(inner.set_, key, hashval, inserted));
+        if (s.head.load(std::memory_order_relaxed))
+            combine_locked(inner.set_, s);
+        return true;
+    }
+
+    // Applies the pending upserts of submap idx if its lock is free. When it
+    // returns true, all the upserts pushed before the call are applied.
+    bool try_combine(size_t idx) {
+        Inner&     inner = this->sets_[idx];
+        UniqueLock m(inner, phmap::defer_lock_t());
+        if (!m.try_lock())
+            return false;
+        combine_locked(inner.set_, slots_[idx]);
+        return true;
+    }
+
+    // PRECONDITION: unique lock held on the submap of s
+    static void combine_locked(EmbeddedSet& set, slot& s) {
+        s.combining.store(true);
+        for (;;) {
+            op_base* ops = s.head.exchange(nullptr);
+            if (!ops) {
+                s.combining.store(false);
+                if (!s.head.load())
+                    break;              // a post() seeing combining clear retries the lock
+                s.combining.store(true);
+                continue;
+            }
+            ops = reversed(ops);        // in the order of the pushes
+            while (ops) {
+                op_base* next = ops->next;
+                bool inserted = false;
+                V&   v        = value_of(set, ops->key(), ops->hashval, inserted);
+                ops->apply(v, inserted);
+                ops = next;
+            }
+        }
+    }
+
+    static V& value_of(EmbeddedSet& set, const K& key, size_t hashval, bool& inserted) {
+        auto it = set.lazy_emplace_with_hash(key, hashval,
+            [&](const typename Base::constructor& ctor) {
+                ctor(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple());
+                inserted = true;
+            });
+        return it->second;
+    }
+
+    static op_base* reversed(op_base* ops) {
+        op_base* res = nullptr;
+        while (ops) {
+            op_base* next = ops->next;
+            ops->next = res;
+            res = ops;
+            ops = next;
+        }
+        return res;
+    }
+
+    static void backoff(unsigned spins) {
+        if (spins >= 16)
+            std::this_thread::yield();
+    }
+
+    std::array<slot, (size_t(1) << N)> slots_;
+};
+
+}  // namespace phmap
+
+#endif // phmap_combining_h_guard_
@@ -646,6 +646,98 @@
     #include <tmmintrin.h>
 #endif
 
+// ----------------------------------------------------------------------
+// NEON, used by GroupNeonImpl on little endian 64 bit ARM
+// ----------------------------------------------------------------------
+#ifndef PHMAP_HAVE_NEON
+    #if defined(__ARM_NEON) && defined(__aarch64__) && !defined(__ARM_BIG_ENDIAN)
+        #define PHMAP_HAVE_NEON 1
+    #else
+        #define PHMAP_HAVE_NEON 0
+    #endif
+#endif
+
+#if PHMAP_HAVE_NEON
+    #include <arm_neon.h>
+#endif
+
+// ----------------------------------------------------------------------
+// SSE4.2 crc32 and AES-NI, used by phmap::HwHash (see phmap_utils.h).
+// 64 bit targets only.
+// ----------------------------------------------------------------------
+#ifndef PHMAP_HAVE_SSE42
+    #if (defined(__SSE4_2__) || (defined(_MSC_VER) && defined(__AVX__))) && \
+        (defined(__x86_64__) || defined(_M_X64))
+        #define PHMAP_HAVE_SSE42 1
+    #else
+        #define PHMAP_HAVE_SSE42 0
+    #endif
+#endif
+
+#ifndef PHMAP_HAVE_AESNI
+    #if (defined(__AES__) || (defined(_MSC_VER) && defined(__AVX__))) && \
+        (defined(__x86_64__) || defined(_M_X64))
+        #define PHMAP_HAVE_AESNI 1
+    #else
+        #define PHMAP_HAVE_AESNI 0
+    #endif
+#endif
+
+#if PHMAP_HAVE_SSE42
+    #include <nmmintrin.h>
+#endif
+
+#if PHMAP_HAVE_AESNI
+    #include <wmmintrin.h>
+#endif
+
+// ----------------------------------------------------------------------
+// AVX2 and AVX-512F, used by phmap_mix_many() (see phmap_utils.h), and
+// AVX-512BW, used by the 64 wide Group (see GroupAvx512Impl in phmap.h).
+// ----------------------------------------------------------------------
+#ifndef PHMAP_HAVE_AVX2
+    #if defined(__AVX2__) && (defined(__x86_64__) || defined(_M_X64))
+        #define PHMAP_HAVE_AVX2 1
+    #else
+        #define PHMAP_HAVE_AVX2 0
+    #endif
+#endif
+
+#ifndef PHMAP_HAVE_AVX512F
+    #if defined(__AVX512F__) && (defined(__x86_64__) || defined(_M_X64))
+        #define PHMAP_HAVE_AVX512F 1
+    #else
+        #define PHMAP_HAVE_AVX512F 0
+    #endif
+#endif
+
+#ifndef PHMAP_HAVE_AVX512BW
+    #if defined(__AVX512BW__) && (defined(__x86_64__) || defined(_M_X64))
+        #define PHMAP_HAVE_AVX512BW 1
+    #else
+        #define PHMAP_HAVE_AVX512BW 0
+    #endif
+#endif
+
+// ----------------------------------------------------------------------
+// Opt-in with PHMAP_CPU_DISPATCH=1: the loops over the whole control byte
+// array get SSSE3 and AVX2 versions, chosen from the cpu features at run
+// time (see cpu_dispatch_internal in phmap.h). GCC and Clang on x86-64
+// only, and pointless when the 64 wide Group is compiled in.
+// ----------------------------------------------------------------------
+#ifndef PHMAP_HAVE_CPU_DISPATCH
+    #if defined(PHMAP_CPU_DISPATCH) && PHMAP_CPU_DISPATCH && PHMAP_HAVE_SSE2 && \
+        !PHMAP_HAVE_AVX512BW && defined(__GNUC__) && defined(__x86_64__)
+        #define PHMAP_HAVE_CPU_DISPATCH 1
+    #else
+        #define PHMAP_HAVE_CPU_DISPATCH 0
+    #endif
+#endif
+
+#if PHMAP_HAVE_AVX2 || PHMAP_HAVE_AVX512F || PHMAP_HAVE_AVX512BW || PHMAP_HAVE_CPU_DISPATCH
+    #include <immintrin.h>
+#endif
+
 
 // ----------------------------------------------------------------------
 // constexpr if
@@ -0,0 +1,259 @@
+#if !defined(phmap_counter_h_guard_)
+#define phmap_counter_h_guard_
+
+// ---------------------------------------------------------------------------
+// Copyright (c) 2019, Gregory Popovitch - greg7mdp@gmail.com
+//
+//       providing parallel_counter_map
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "phmap.h"
+
+namespace phmap {
+
+namespace priv {
+
+// ---------------------------------------------------------------------------
+// Mapped type of parallel_counter_map. The count can be incremented
+// concurrently through a const reference, so existing keys can be updated
+// while holding only a shared lock on their submap.
+// Copyable (needed when the submap is resized, which happens under the
+// unique lock), and convertible to Int.
+// ---------------------------------------------------------------------------
+template <class Int>
+class atomic_counter
+{
+public:
+    atomic_counter(Int v = Int()) : v_(v) {}
+    atomic_counter(const atomic_counter& o) : v_(o.load()) {}
+
+    atomic_counter& operator=(const atomic_counter& o) {
+        v_.store(o.load(), std::memory_order_relaxed);
+        return *this;
+    }
+
+    Int load() const { return v_.load(std::memory_order_relaxed); }
+    operator Int() const { return load(); }
+
+    // returns the updated count
+    Int add(Int n) const { return v_.fetch_add(n, std::memory_order_relaxed) + n; }
+
+private:
+    mutable std::atomic<Int> v_;
+};
+
+#ifdef PHMAP_HAVE_SHARED_MUTEX
+    using counter_map_mutex = std::shared_mutex;
+#else
+    using counter_map_mutex = std::mutex;
+#endif
+
+}  // namespace priv
+
+// -----------------------------------------------------------------------------
+// phmap::parallel_counter_map
+// -----------------------------------------------------------------------------
+// A parallel_flat_hash_map<K, Int> specialized for counting from many threads
+// (word counts, metrics aggregation...).
+//
+// add() increments existing keys with a relaxed atomic fetch_add under the
+// submap's shared lock, so concurrent updates of the same submap do not
+// serialize. Only the insertion of new keys takes the unique lock.
+//
+// The default mutex is std::shared_mutex when available (C++17). With a
+// non-shared mutex such as std::mutex, add() still works but increments
+// are serialized per submap, as with `lazy_emplace_l`.
+//
+// Counts should be read when no add() is in progress for an exact result;
+// concurrent reads see a (relaxed) recent value.
+// -----------------------------------------------------------------------------
+template <class K, class Int = size_t,
+          class Hash  = phmap::priv::hash_default_hash<K>,
+          class Eq    = phmap::priv::hash_default_eq<K>,
+          class Alloc = phmap::priv::Allocator<
+                        phmap::priv::Pair<const K, priv::atomic_counter<Int>>>,
+          size_t N    = 4,                          // 2**N submaps
+          class Mutex = priv::counter_map_mutex>
+class parallel_counter_map
+    : public phmap::parallel_flat_hash_map<K, priv::atomic_counter<Int>, Hash, Eq, Alloc, N, Mutex>
+{
+    using Base       = typename parallel_counter_map::parallel_flat_hash_map;
+    using Inner      = typename Base::Inner;
+    using Lockable   = phmap::LockableImpl<Mutex>;
+    using SharedLock = typename Lockable::SharedLock;
+    using UniqueLock = typename Lockable::UniqueLock;
+    using EmbeddedSet = typename Base::EmbeddedSet;
+
+public:
+    using counter_type = Int;
+    using count_vector = std::vector<std::pair<K, Int>>;
+
+    parallel_counter_map() {}
+#ifdef __INTEL_COMPILER
+    using Base::parallel_flat_hash_map;
+#else
+    using Base::Base;
+#endif
+
+    // Adds `n` to the count of `key` (starting from 0 for a new key).
+    // Returns the updated count.
+    // -----------------------------------------------------------------
+    Int add(const K& key, Int n = 1) {
+        return add_with_hash(key, this->hash(key), n);
+    }
+
+    Int add_with_hash(const K& key, size_t hashval, Int n = 1) {
+        Inner& inner = this->sets_[this->subidx(hashval)];
+        {
+            SharedLock m(inner);
+            auto p = inner.set_.find_ptr(key, hashval);
+            if (p)
+                return p->second.add(n);
+        }
+        UniqueLock m(inner);
+        return add_locked(inner.set_, key, hashval, n);
+    }
+
+    // Returns the count of `key`, 0 if not present.
+    // -----------------------------------------------------------------
+    Int get(const K& key) const {
+        Int res = Int();
+        this->if_contains(key, [&](const typename Base::value_type& v) { res = v.second.load(); });
+        return res;
+    }
+
+    // Adds 1 to the count of each key in [first, last) (a forward range).
+    // Keys are grouped by submap first, so that each submap lock is taken at
+    // most twice (shared for the existing keys, unique for the new ones).
+    // -----------------------------------------------------------------
+    template <class It>
+    void add_all(It first, It last) {
+        using entry = std::pair<size_t, It>;  // hash, key
+        std::vector<std::vector<entry>> by_submap(this->subcnt());
+        for (It it = first; it != last; ++it) {
+            size_t hashval = this->hash(*it);
+            by_submap[this->subidx(hashval)].emplace_back(hashval, it);
+        }
+
+        std::vector<entry> missing;
+        for (size_t i = 0; i < by_submap.size(); ++i) {
+            auto& entries = by_submap[i];
+            if (entries.empty())
+                continue;
+            Inner& inner = this->sets_[i];
+            missing.clear();
+            {
+                SharedLock m(inner);
+                for (auto& e : entries) {
+                    auto p = inner.set_.find_ptr(*e.second, e.first);
+                    if (p)
+                        p->second.add(1);
+                    else
+                        missing.push_back(e);
+                }
+            }
+            if (!missing.empty()) {
+                UniqueLock m(inner);
+                for (auto& e : missing)
+                    add_locked(inner.set_, *e.second, e.first, 1);
+            }
+        }
+    }
+
+    template <class Range>
+    void add_all(const Range& keys) {
+        add_all(std::begin(keys), std::end(keys));
+    }
+
+    // Returns the `k` keys with the highest counts, sorted by decreasing count.
+    // The submaps are scanned concurrently by `num_threads` threads (0 means
+    // std::thread::hardware_concurrency()), each keeping its own top k.
+    // -----------------------------------------------------------------
+    count_vector top_k(size_t k, size_t num_threads = 0) const {
+        count_vector res;
+        if (k == 0)
+            return res;
+        if (num_threads == 0)
+            num_threads = std::thread::hardware_concurrency();
+        num_threads = (std::max)(size_t(1), (std::min)(num_threads, this->subcnt()));
+
+        std::vector<count_vector> partial(num_threads);
+        auto scan = [&](size_t t) {
+            count_vector& v = partial[t];
+            for (size_t i = t; i < this->subcnt(); i += num_threads) {
+                this->with_submap(i, [&](const EmbeddedSet& set) {
+                    for (auto& p : set) {
+                        v.emplace_back(p.first, p.second.load());
+                        if (v.size() >= 2 * k)
+                            keep_top(v, k);
+                    }
+                });
+            }
+            keep_top(v, k);
+        };
+
+        if (num_threads == 1) {
+            scan(0);
+        } else {
+            std::vector<std::thread> threads;
+            threads.reserve(num_threads);
+            for (size_t t = 0; t < num_threads; ++t)
+                threads.emplace_back(scan, t);
+            for (auto& t : threads)
+                t.join();
+        }
+
+        for (auto& v : partial)
+            res.insert(res.end(), std::make_move_iterator(v.begin()), std::make_move_iterator(v.end()));
+        keep_top(res, k);
+        std::sort(res.begin(), res.end(), by_count);
+        return res;
+    }
+
+private:
+    // PRECONDITION: unique lock held on the submap containing `key`
+    Int add_locked(EmbeddedSet& set, const K& key, size_t hashval, Int n) {
+        bool inserted = false;
+        auto it = set.lazy_emplace_with_hash(key, hashval,
+            [&](const typename Base::constructor& ctor) {
+                ctor(key, n);
+                inserted = true;
+            });
+        return inserted ? n : it->second.add(n);
+    }
+
+    static bool by_count(const std::pair<K, Int>& a, const std::pair<K, Int>& b) {
+        return a.second > b.second;
+    }
+
+    // keeps the k highest counts (unsorted)
+    static void keep_top(count_vector& v, size_t k) {
+        if (v.size() <= k)
+            return;
+        std::nth_element(v.begin(), v.begin() + (k - 1), v.end(), by_count);
+        v.resize(k);
+    }
+};
+
+}  // namespace phmap
+
+#endif // phmap_counter_h_guard_
@@ -0,0 +1,434 @@
+#if !defined(phmap_dense_h_guard_)
+#define phmap_dense_h_guard_
+
+// ---------------------------------------------------------------------------
+// Copyright (c) 2019, Gregory Popovitch - greg7mdp@gmail.com
+//
+//       providing dense_hash_map
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ---------------------------------------------------------------------------
+
+#include <cassert>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "phmap.h"
+
+namespace phmap {
+
+// -----------------------------------------------------------------------------
+// phmap::dense_hash_map
+// -----------------------------------------------------------------------------
+// A hash map storing its entries contiguously, in a vector, in insertion
+// order. The hash table itself is a flat_hash_set of 32-bit indices into the
+// vector, so a slot takes 4 bytes whatever the size of the entries.
+//
+// - iteration is a linear scan of the entries, as fast as iterating a vector,
+//   and does not depend on the capacity of the table,
+// - iterators are pointers, and the entries can also be accessed by position
+//   (nth(), data()),
+// - erase() moves the last entry into the erased position (swap-with-last),
+//   so the insertion order is kept only until the first erase, and erasing
+//   invalidates the iterators to the last entry.
+//
+// value_type is std::pair<K, V> (not std::pair<const K, V>) so that entries
+// can be moved on erase. Modifying the key through an iterator is undefined
+// behavior.
+//
+// As for std::vector, inserting may invalidate all iterators and references.
+// At most 2**32 - 1 entries can be stored.
+// -----------------------------------------------------------------------------
+template <class K, class V, class Hash, class Eq, class Alloc>
+class dense_hash_map
+{
+    using AllocTraits  = phmap::allocator_traits<Alloc>;
+    using entry_type   = std::pair<K, V>;
+    using EntryAlloc   = typename AllocTraits::template rebind_alloc<entry_type>;
+    using IndexAlloc   = typename AllocTraits::template rebind_alloc<uint32_t>;
+    using Entries      = std::vector<entry_type, EntryAlloc>;
+
+    template <class KK>
+    struct key_ref
+    {
+        const KK* k;
+    };
+
+    // The index stores positions in the entries vector. It hashes and compares
+    // them through the entries, whose address does not change when the
+    // dense_hash_map is moved or swapped, as the vector is allocated apart.
+    // Lookups use a key_ref so that they can't be confused with positions
+    // when K is itself an integer.
+    struct IndexHash : public Hash
+    {
+        using is_transparent = void;
+
+        IndexHash(const Hash& h = Hash(), const Entries* e = nullptr) : Hash(h), entries(e) {}
+
+        size_t operator()(uint32_t i) const {
+            return Hash::operator()((*entries)[i].first);
+        }
+        template <class KK>
+        size_t operator()(key_ref<KK> r) const { return Hash::operator()(*r.k); }
+
+        const Entries* entries;
+    };
+
+    struct IndexEq : public Eq
+    {
+        using is_transparent = void;
+
+        IndexEq(const Eq& eq = Eq(), const Entries* e = nullptr) : Eq(eq), entries(e) {}
+
+        bool operator()(uint32_t i, uint32_t j) const { return i == j; }
+
+        template <class KK>
+        bool operator()(uint32_t i, key_ref<KK> r) const {
+            return Eq::operator()((*entries)[i].first, *r.k);
+        }
+        template <class KK>
+        bool operator()(key_ref<KK> r, uint32_t i) const { return (*this)(i, r); }
+
+        const Entries* entries;
+    };
+
+    using Index = phmap::flat_hash_set<uint32_t, IndexHash, IndexEq, IndexAlloc>;
+
+    template <class KK>
+    using key_arg = typename phmap::priv::KeyArg<phmap::priv::IsTransparent<Eq>::value &&
+                                                 phmap::priv::IsTransparent<Hash>::value>::
+        template type<KK, K>;
+
+public:
+    using key_type        = K;
+    using mapped_type     = V;
+    using value_type      = entry_type;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+    using hasher          = Hash;
+    using key_equal       = Eq;
+    using allocator_type  = Alloc;
+    using reference       = value_type&;
+    using const_reference = const value_type&;
+    using iterator        = value_type*;
+    using const_iterator  = const value_type*;
+
+    dense_hash_map() {}
+
+    explicit dense_hash_map(size_t bucket_cnt,
+                            const hasher& hash = hasher(),
+                            const key_equal& eq = key_equal(),
+                            const allocator_type& alloc = allocator_type())
+        : index_(0, IndexHash(hash), IndexEq(eq), IndexAlloc(alloc)) {
+        reserve(bucket_cnt);
+    }
+
+    template <class InputIter>
+    dense_hash_map(InputIter first, InputIter last, size_t bucket_cnt = 0,
+                   const hasher& hash = hasher(), const key_equal& eq = key_equal(),
+                   const allocator_type& alloc = allocator_type())
+        : dense_hash_map(bucket_cnt, hash, eq, alloc) {
+        insert(first, last);
+    }
+
+    dense_hash_map(std::initializer_list<value_type> init, size_t bucket_cnt = 0,
+                   const hasher& hash = hasher(), const key_equal& eq = key_equal(),
+                   const allocator_type& alloc = allocator_type())
+        : dense_hash_map(init.begin(), init.end(), bucket_cnt, hash, eq, alloc) {}
+
+    dense_hash_map(const dense_hash_map& o)
+        : index_(0, o.index_.hash_function(), o.index_.key_eq(),
+                 AllocTraits::select_on_container_copy_construction(o.get_allocator())) {
+        if (o.entries_) {
+            entries_.reset(new Entries(*o.entries_));
+            attach();
+            index_.reserve(entries_->size());
+            for (size_t i = 0; i < entries_->size(); ++i)
+                index_.insert(uint32_t(i));
+        }
+    }
+
+    // the moved-from map is empty, and allocates its entries vector again
+    // when used
+    dense_hash_map(dense_hash_map&& o) noexcept
+        : index_(std::move(o.index_)), entries_(std::move(o.entries_)) {}
+
+    dense_hash_map& operator=(dense_hash_map o) {
+        swap(o);
+        return *this;
+    }
+
+    // ---------------------------------------------------------------------
+    iterator       begin()        { return entries_ ? entries_->data() : nullptr; }
+    const_iterator begin()  const { return entries_ ? entries_->data() : nullptr; }
+    const_iterator cbegin() const { return begin(); }
+    iterator       end()          { return begin() + size(); }
+    const_iterator end()    const { return begin() + size(); }
+    const_iterator cend()   const { return end(); }
+
+    value_type*       data()       { return begin(); }
+    const value_type* data() const { return begin(); }
+
+    // entry at position `i` of the iteration order
+    value_type&       nth(size_t i)       { assert(i < size()); return (*entries_)[i]; }
+    const value_type& nth(size_t i) const { assert(i < size()); return (*entries_)[i]; }
+
+    size_t size()     const { return entries_ ? entries_->size() : 0; }
+    bool   empty()    const { return size() == 0; }
+    size_t max_size() const { return (std::numeric_limits<uint32_t>::max)(); }
+
+    // capacity of the hash table (the entries vector grows independently)
+    size_t bucket_count() const { return index_.bucket_count(); }
+    float  load_factor()  const { return index_.load_factor(); }
+
+    void clear() {
+        index_.clear();
+        if (entries_)
+            entries_->clear();
+    }
+
+    void reserve(size_t n) {
+        if (n == 0)
+            return;
+        ensure_entries();
+        entries_->reserve(n);
+        index_.reserve(n);
+    }
+
+    void swap(dense_hash_map& o) noexcept {
+        index_.swap(o.index_);
+        entries_.swap(o.entries_);
+    }
+
+    hasher         hash_function() const { return index_.hash_function(); }
+    key_equal      key_eq()        const { return index_.key_eq(); }
+    allocator_type get_allocator() const { return allocator_type(index_.get_allocator()); }
+
+    template <class KK = K>
+    size_t hash(const key_arg<KK>& key) const { return index_.hash(key_ref<KK>{&key}); }
+
+    // Inserts `key` with a value constructed from `args`, if `key` is not
+    // present. The new entry is added at the end.
+    // ---------------------------------------------------------------------
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(const K& key, Args&&... args) {
+        return try_emplace_impl(key, std::forward<Args>(args)...);
+    }
+
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+        return try_emplace_impl(std::move(key), std::forward<Args>(args)...);
+    }
+
+    template <class... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        value_type v(std::forward<Args>(args)...);
+        return try_emplace_impl(std::move(v.first), std::move(v.second));
+    }
+
+    std::pair<iterator, bool> insert(const value_type& v) { return try_emplace_impl(v.first, v.second); }
+    std::pair<iterator, bool> insert(value_type&& v) {
+        return try_emplace_impl(std::move(v.first), std::move(v.second));
+    }
+
+    template <class InputIter>
+    void insert(InputIter first, InputIter last) {
+        for (; first != last; ++first)
+            emplace(*first);
+    }
+
+    void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+    template <class VV>
+    std::pair<iterator, bool> insert_or_assign(const K& key, VV&& v) {
+        auto res = try_emplace_impl(key, std::forward<VV>(v));
+        if (!res.second)
+            res.first->second = std::forward<VV>(v);
+        return res;
+    }
+
+    template <class KK = K>
+    V& operator[](const key_arg<KK>& key) {
+        return try_emplace_impl(key).first->second;
+    }
+
+    V& operator[](K&& key) { return try_emplace_impl(std::move(key)).first->second; }
+
+    // ---------------------------------------------------------------------
+    template <class KK = K>
+    iterator find(const key_arg<KK>& key) {
+        return find_with_hash(key, hash(key));
+    }
+
+    template <class KK = K>
+    iterator find_with_hash(const key_arg<KK>& key, size_t hashval) {
+        if (empty())
+            return end();
+        auto it = index_.find(key_ref<KK>{&key}, hashval);
+        return it == index_.end() ? end() : begin() + *it;
+    }
+
+    template <class KK = K>
+    const_iterator find(const key_arg<KK>& key) const {
+        return const_cast<dense_hash_map*>(this)->find(key);
+    }
+
+    template <class KK = K>
+    const_iterator find_with_hash(const key_arg<KK>& key, size_t hashval) const {
+        return const_cast<dense_hash_map*>(this)->find_with_hash(key, hashval);
+    }
+
+    template <class KK = K>
+    bool contains(const key_arg<KK>& key) const { return find(key) != end(); }
+
+    template <class KK = K>
+    size_t count(const key_arg<KK>& key) const { return contains(key) ? 1 : 0; }
+
+    template <class KK = K>
+    V& at(const key_arg<KK>& key) {
+        auto it = find(key);
+        if (it == end())
+            phmap::base_internal::ThrowStdOutOfRange("phmap at(): lookup non-existent key");
+        return it->second;
+    }
+
+    template <class KK = K>
+    const V& at(const key_arg<KK>& key) const {
+        return const_cast<dense_hash_map*>(this)->at(key);
+    }
+
+    // Erases `key`, moving the last entry in its place. Returns the number of
+    // entries erased (0 or 1).
+    // ---------------------------------------------------------------------
+    template <class KK = K>
+    size_t erase(const key_arg<KK>& key) {
+        if (empty())
+            return 0;
+        auto it = index_.find(key_ref<KK>{&key});
+        if (it == index_.end())
+            return 0;
+        erase_slot(it);
+        return 1;
+    }
+
+    // Erases the entry at `pos`, moving the last entry in its place. Returns
+    // an iterator to the same position, which holds the next entry to visit,
+    // so that erasing while iterating doesn't skip entries.
+    // ---------------------------------------------------------------------
+    iterator erase(const_iterator pos) {
+        size_t i = (size_t)(pos - begin());
+        assert(i < size());
+        erase_slot(index_.find(uint32_t(i)));
+        return begin() + i;
+    }
+
+    iterator erase(iterator pos) { return erase(const_iterator(pos)); }
+
+    // Erases the last entry, without moving any other.
+    void pop_back() {
+        assert(!empty());
+        erase_slot(index_.find(uint32_t(size() - 1)));
+    }
+
+    friend bool operator==(const dense_hash_map& a, const dense_hash_map& b) {
+        if (a.size() != b.size())
+            return false;
+        for (const value_type& v : a) {
+            auto it = b.find(v.first);
+            if (it == b.end() || !(it->second == v.second))
+                return false;
+        }
+        return true;
+    }
+
+    friend bool operator!=(const dense_hash_map& a, const dense_hash_map& b) { return !(a == b); }
+
+    friend void swap(dense_hash_map& a, dense_hash_map& b) noexcept { a.swap(b); }
+
+private:
+    // The entries vector is allocated on first insertion (or reserve), and
+    // the index's functors are pointed to it.
+    void ensure_entries() {
+        if (entries_)
+            return;
+        entries_.reset(new Entries(EntryAlloc(index_.get_allocator())));
+        attach();
+    }
+
+    // PRECONDITION: index_ is empty
+    void attach() {
+        Index index(0, IndexHash(index_.hash_function(), entries_.get()),
+                    IndexEq(index_.key_eq(), entries_.get()), index_.get_allocator());
+        index_.swap(index);
+    }
+
+    template <class KK, class... Args>
+    std::pair<iterator, bool> try_emplace_impl(KK&& key, Args&&... args) {
+        using KeyRef = key_ref<typename std::remove_cv<typename std::remove_reference<KK>::type>::type>;
+        ensure_entries();
+        Entries& entries = *entries_;
+        size_t n = entries.size();
+        bool inserted = false;
+        auto it = index_.lazy_emplace_with_hash(KeyRef{&key}, hash(key),
+            [&](const typename Index::constructor& ctor) {
+                ctor(uint32_t(n));
+                inserted = true;
+            });
+        if (!inserted)
+            return {begin() + *it, false};
+        assert(n < max_size());
+#ifdef PHMAP_HAVE_EXCEPTIONS
+        try {
+#endif
+            entries.emplace_back(std::piecewise_construct,
+                                 std::forward_as_tuple(std::forward<KK>(key)),
+                                 std::forward_as_tuple(std::forward<Args>(args)...));
+#ifdef PHMAP_HAVE_EXCEPTIONS
+        } catch (...) {
+            index_._erase(it);
+            throw;
+        }
+#endif
+        return {begin() + n, true};
+    }
+
+    // Erases the index slot `it` and its entry. The last entry is moved in the
+    // freed position, and its index slot updated in place: it stays valid as
+    // the slot's hash is that of the moved key.
+    void erase_slot(typename Index::iterator it) {
+        assert(it != index_.end());
+        Entries& entries = *entries_;
+        uint32_t i    = *it;
+        uint32_t last = uint32_t(entries.size() - 1);
+        index_._erase(it);
+        if (i != last) {
+            auto jt = index_.find(last);
+            assert(jt != index_.end());
+            entries[i] = std::move(entries[last]);
+            const_cast<uint32_t&>(*jt) = i;
+        }
+        entries.pop_back();
+    }
+
+    Index                    index_;
+    std::unique_ptr<Entries> entries_;  // allocated apart so that index_ can refer to it
+};
+
+}  // namespace phmap
+
+#endif // phmap_dense_h_guard_
@@ -46,6 +46,7 @@ namespace priv {
 
 static constexpr size_t s_version_base = std::numeric_limits<size_t>::max() - 10;
 static constexpr size_t s_version = s_version_base;
+static constexpr size_t s_version_seeded = s_version_base + 1; // followed by the hash seed
 // ------------------------------------------------------------------------
 // dump/load for raw_hash_set
 // ------------------------------------------------------------------------
@@ -55,7 +56,13 @@ bool raw_hash_set<Policy, Hash, Eq, Alloc>::phmap_dump(OutputArchive& ar) const
     static_assert(type_traits_internal::IsTriviallyCopyable<value_type>::value,
                     "value_type should be trivially copyable");
 
-    ar.saveBinary(&s_version, sizeof(size_t));
+    const size_t seed = hash_seed();
+    if (seed) {
+        ar.saveBinary(&s_version_seeded, sizeof(size_t));
+        ar.saveBinary(&seed, sizeof(size_t));
+    } else {
+        ar.saveBinary(&s_version, sizeof(size_t));
+    }
     ar.saveBinary(&size_, sizeof(size_t));
     ar.saveBinary(&capacity_, sizeof(size_t));
     if (size_ == 0)
@@ -69,16 +76,33 @@ bool raw_hash_set<Policy, Hash, Eq, Alloc>::phmap_dump(OutputArchive& ar) const
 template <class Policy, class Hash, class Eq, class Alloc>
 template<typename InputArchive>
 bool raw_hash_set<Policy, Hash, Eq, Alloc>::phmap_load(InputArchive& ar) {
+    size_t seed = 0;
+    if (!load_dump(ar, seed))
+        return false;
+    if (seed != hash_seed()) {
+        // laid out with another hash seed, reinsert the elements
+        raw_hash_set tmp(begin(), end(), capacity_, hash_ref(), eq_ref(), alloc_ref());
+        swap(tmp);
+    }
+    return true;
+}
+
+template <class Policy, class Hash, class Eq, class Alloc>
+template<typename InputArchive>
+bool raw_hash_set<Policy, Hash, Eq, Alloc>::load_dump(InputArchive& ar, size_t& seed) {
     static_assert(type_traits_internal::IsTriviallyCopyable<value_type>::value,
                     "value_type should be trivially copyable");
     raw_hash_set<Policy, Hash, Eq, Alloc>().swap(*this); // clear any existing content
 
     size_t version = 0;
+    seed = 0;
     ar.loadBinary(&version, sizeof(size_t));
     if (version < s_version_base) {
         // we didn't store the version, version actually contains the size
         size_ = version;
     } else {
+        if (version == s_version_seeded)
+            ar.loadBinary(&seed, sizeof(size_t));
         ar.loadBinary(&size_, sizeof(size_t));
     }
     ar.loadBinary(&capacity_, sizeof(size_t));
@@ -141,13 +165,22 @@ bool parallel_hash_set<N, RefSet, Mtx_, Policy, Hash, Eq, Alloc>::phmap_load(Inp
         return false;
     }
 
+    bool reseeded = false;
     for (size_t i = 0; i < submap_count; ++i) {            
         auto& inner = sets_[i];
         typename Lockable::UniqueLock m(const_cast<Inner&>(inner));
-        if (!inner.set_.phmap_load(ar)) {
+        size_t seed = 0;
+        if (!inner.set_.load_dump(ar, seed)) {
             std::cerr << "Failed to load submap " << i << std::endl;
             return false;
         }
+        reseeded |= (seed != hash_seed());
+    }
+    if (reseeded) {
+        // the elements were spread over the submaps with another hash seed,
+        // reinsert them
+        parallel_hash_set tmp(begin(), end(), capacity(), hash_ref(), eq_ref(), alloc_ref());
+        swap(tmp);
     }
     return true;
 }
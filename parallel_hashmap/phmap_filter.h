@@ -0,0 +1,435 @@
+#if !defined(phmap_filter_h_guard_)
+#define phmap_filter_h_guard_
+
+// ---------------------------------------------------------------------------
+// Copyright (c) 2019, Gregory Popovitch - greg7mdp@gmail.com
+//
+//       providing parallel_filtered_flat_hash_set and parallel_filtered_flat_hash_map
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ---------------------------------------------------------------------------
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "phmap.h"
+
+namespace phmap {
+
+namespace priv {
+
+// ---------------------------------------------------------------------------
+// A split block Bloom filter: the hash selects a 64-byte block, and sets or
+// tests one bit in each of its 8 words, so a test reads a single cache line.
+// With 8 bits per key (the filter is sized to one byte per slot of the
+// submap), the false positive rate is about 2% when the submap is full.
+//
+// Bits are atomic words, so that the filter can be tested without holding
+// any lock while a writer (holding the submap's unique lock) updates it.
+// ---------------------------------------------------------------------------
+class split_block_bloom_filter
+{
+public:
+    // `capacity` is the number of slots of the submap
+    explicit split_block_bloom_filter(size_t capacity) {
+        size_t num_blocks = 1;
+        while (num_blocks * 64 < capacity)
+            num_blocks *= 2;
+        mask_ = num_blocks - 1;
+        // over-allocate to align the blocks on cache lines
+        storage_.reset(new std::atomic<uint64_t>[num_blocks * 8 + 7]());
+        uintptr_t p = reinterpret_cast<uintptr_t>(storage_.get());
+        words_ = storage_.get() + ((64 - (p & 63)) & 63) / sizeof(uint64_t);
+    }
+
+    size_t num_keys() const { return (mask_ + 1) * 64; }   // at 8 bits per key
+    size_t bytes()    const { return (mask_ + 1) * 64; }
+
+    // only called by one writer at a time
+    void add(size_t hashval) {
+        std::atomic<uint64_t>* block = block_of(hashval);
+        uint64_t h = bits_hash(hashval);
+        for (int i = 0; i < 8; ++i) {
+            uint64_t bit = uint64_t(1) << ((h >> (6 * i)) & 63);
+            uint64_t w = block[i].load(std::memory_order_relaxed);
+            if (!(w & bit))
+                block[i].store(w | bit, std::memory_order_relaxed);
+        }
+    }
+
+    bool may_contain(size_t hashval) const {
+        const std::atomic<uint64_t>* block = block_of(hashval);
+        uint64_t h = bits_hash(hashval);
+        for (int i = 0; i < 8; ++i) {
+            uint64_t bit = uint64_t(1) << ((h >> (6 * i)) & 63);
+            if (!(block[i].load(std::memory_order_relaxed) & bit))
+                return false;
+        }
+        return true;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < (mask_ + 1) * 8; ++i)
+            words_[i].store(0, std::memory_order_relaxed);
+    }
+
+private:
+    // `hashval` is the mixed hash used by the submap. Its low bits select the
+    // submap and the control byte, so the block is taken from the high bits,
+    // and the bit positions from a second mix.
+    std::atomic<uint64_t>* block_of(size_t hashval) const {
+        return words_ + ((static_cast<uint64_t>(hashval) >> 32) & mask_) * 8;
+    }
+
+    static uint64_t bits_hash(size_t hashval) {
+        return (static_cast<uint64_t>(hashval) * 0x9E3779B97F4A7C15ULL) >> 16;
+    }
+
+    size_t                                   mask_;
+    std::unique_ptr<std::atomic<uint64_t>[]> storage_;
+    std::atomic<uint64_t>*                   words_;
+};
+
+#ifdef PHMAP_HAVE_SHARED_MUTEX
+    using filtered_mutex = std::shared_mutex;
+#else
+    using filtered_mutex = std::mutex;
+#endif
+
+// ---------------------------------------------------------------------------
+// Common implementation of the parallel_filtered_flat_hash_* containers.
+//
+// Each submap has a Bloom filter, which contains() and if_contains() test
+// before taking the submap's lock. When the filter says the key is absent,
+// the lookup returns without touching the lock or the table.
+//
+// Filters are updated under the submap's unique lock:
+// - insertions set the bits of the new key,
+// - when the submap grows, a larger filter is built from its keys and
+//   replaces the current one. The old filter is kept until destruction,
+//   since a concurrent lookup may still be reading it (the filters only
+//   grow, so this at most doubles their memory),
+// - erasing doesn't clear bits. After many erases (as many as half the
+//   keys the filter is sized for), the filter is rebuilt in place from the
+//   remaining keys, like the table's own drop_deletes_without_resize().
+//
+// Rebuilds are published through a per-submap sequence number: a lookup
+// which sees it change while testing the filter falls back to the locked
+// lookup, so a rebuild never causes a false negative.
+// ---------------------------------------------------------------------------
+template <class Base, size_t N, class Mutex>
+class parallel_filtered_base : protected Base
+{
+protected:
+    using Inner       = typename Base::Inner;
+    using EmbeddedSet = typename Base::EmbeddedSet;
+    using Lockable    = phmap::LockableImpl<Mutex>;
+    using SharedLock  = typename Lockable::SharedLock;
+    using UniqueLock  = typename Lockable::UniqueLock;
+    using Filter      = split_block_bloom_filter;
+
+    struct alignas(PHMAP_CACHELINE_SIZE) FilterState
+    {
+        std::atomic<Filter*>                 filter{nullptr};
+        std::atomic<uint32_t>                seq{0};     // odd while the filter is rebuilt
+        size_t                               erased = 0; // since the last rebuild
+        std::vector<std::unique_ptr<Filter>> filters;    // the last one is current
+    };
+
+public:
+    using key_type   = typename Base::key_type;
+    using value_type = typename Base::value_type;
+    using hasher     = typename Base::hasher;
+    using key_equal  = typename Base::key_equal;
+
+    template <class K>
+    using key_arg = typename Base::template key_arg<K>;
+
+    parallel_filtered_base() {}
+    parallel_filtered_base(const parallel_filtered_base&) = delete;
+    parallel_filtered_base& operator=(const parallel_filtered_base&) = delete;
+
+    using Base::size;
+    using Base::empty;
+    using Base::subcnt;
+    using Base::hash;
+    using Base::for_each;
+
+    // Returns true if `key` is present. Most absent keys are rejected by the
+    // filter, without locking.
+    // -----------------------------------------------------------------
+    template <class K = key_type>
+    bool contains(const key_arg<K>& key) const {
+        size_t hashval = this->hash(key);
+        size_t idx     = this->subidx(hashval);
+        if (!may_contain(idx, hashval))
+            return false;
+        const Inner& inner = this->sets_[idx];
+        SharedLock m(const_cast<Inner&>(inner));
+        return inner.set_.contains(key, hashval);
+    }
+
+    template <class K = key_type>
+    size_t count(const key_arg<K>& key) const { return contains(key) ? 1 : 0; }
+
+    // If `key` is present, calls `f` with its value_type under the submap's
+    // shared lock and returns true.
+    // -----------------------------------------------------------------
+    template <class K = key_type, class F>
+    bool if_contains(const key_arg<K>& key, F&& f) const {
+        size_t hashval = this->hash(key);
+        size_t idx     = this->subidx(hashval);
+        if (!may_contain(idx, hashval))
+            return false;
+        Inner& inner = const_cast<Inner&>(this->sets_[idx]);
+        SharedLock m(inner);
+        auto it = inner.set_.find(key, hashval);
+        if (it == inner.set_.end())
+            return false;
+        std::forward<F>(f)(*it);
+        return true;
+    }
+
+    // Inserts `v` if its key is not present. Returns true if inserted.
+    // -----------------------------------------------------------------
+    bool insert(const value_type& v) { return emplace_value(v); }
+    bool insert(value_type&& v) { return emplace_value(std::move(v)); }
+
+    template <class K = key_type>
+    size_t erase(const key_arg<K>& key) {
+        size_t hashval = this->hash(key);
+        size_t idx     = this->subidx(hashval);
+        Inner& inner   = this->sets_[idx];
+        UniqueLock m(inner);
+        auto it = inner.set_.find(key, hashval);
+        if (it == inner.set_.end())
+            return 0;
+        inner.set_._erase(it);
+        FilterState& state = states_[idx];
+        Filter* f = state.filter.load(std::memory_order_relaxed);
+        if (++state.erased >= f->num_keys() / 2)
+            rebuild_in_place(idx);
+        return 1;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < this->subcnt(); ++i) {
+            Inner& inner = this->sets_[i];
+            UniqueLock m(inner);
+            inner.set_.clear();
+            if (states_[i].filter.load(std::memory_order_relaxed))
+                rebuild_in_place(i);
+        }
+    }
+
+    void reserve(size_t n) {
+        size_t per_submap = n / this->subcnt();
+        for (size_t i = 0; i < this->subcnt(); ++i) {
+            Inner& inner = this->sets_[i];
+            UniqueLock m(inner);
+            inner.set_.reserve(per_submap);
+            update_filter_size(i);
+        }
+    }
+
+    // memory used by the current filters
+    size_t filter_bytes() const {
+        size_t res = 0;
+        for (auto& s : states_) {
+            Filter* f = s.filter.load(std::memory_order_acquire);
+            res += f ? f->bytes() : 0;
+        }
+        return res;
+    }
+
+protected:
+    bool may_contain(size_t idx, size_t hashval) const {
+        const FilterState& state = states_[idx];
+        uint32_t seq = state.seq.load(std::memory_order_acquire);
+        if (seq & 1)
+            return true;            // being rebuilt
+        Filter* f = state.filter.load(std::memory_order_acquire);
+        if (!f)
+            return false;           // nothing was ever inserted
+        if (f->may_contain(hashval))
+            return true;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return state.seq.load(std::memory_order_relaxed) != seq;
+    }
+
+    // PRECONDITION: unique lock held on submap `idx`, after an insertion
+    void on_insert(size_t idx, size_t hashval) {
+        if (!update_filter_size(idx))
+            states_[idx].filter.load(std::memory_order_relaxed)->add(hashval);
+    }
+
+    // PRECONDITION: unique lock held on submap `idx`.
+    // Replaces the filter with a larger one when the submap has grown.
+    // Returns true if it did (the new filter contains all the keys).
+    bool update_filter_size(size_t idx) {
+        FilterState& state = states_[idx];
+        EmbeddedSet& set   = this->sets_[idx].set_;
+        Filter* f = state.filter.load(std::memory_order_relaxed);
+        if (f && f->num_keys() >= set.capacity())
+            return false;
+        std::unique_ptr<Filter> nf(new Filter(set.capacity()));
+        fill(*nf, set);
+        state.filters.reserve(state.filters.size() + 1);
+        uint32_t seq = state.seq.load(std::memory_order_relaxed);
+        state.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        state.filter.store(nf.get(), std::memory_order_release);
+        state.filters.push_back(std::move(nf));
+        state.seq.store(seq + 2, std::memory_order_release);
+        state.erased = 0;
+        return true;
+    }
+
+    // PRECONDITION: unique lock held on submap `idx`
+    void rebuild_in_place(size_t idx) {
+        FilterState& state = states_[idx];
+        Filter* f = state.filter.load(std::memory_order_relaxed);
+        uint32_t seq = state.seq.load(std::memory_order_relaxed);
+        state.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        f->clear();
+        fill(*f, this->sets_[idx].set_);
+        state.seq.store(seq + 2, std::memory_order_release);
+        state.erased = 0;
+    }
+
+    void fill(Filter& f, const EmbeddedSet& set) {
+        for (const auto& v : set)
+            f.add(set.hash(key_of(v)));
+    }
+
+    template <class V>
+    bool emplace_value(V&& v) {
+        size_t hashval = this->hash(key_of(v));
+        size_t idx     = this->subidx(hashval);
+        Inner& inner   = this->sets_[idx];
+        UniqueLock m(inner);
+        if (!inner.set_.emplace_with_hash(hashval, std::forward<V>(v)).second)
+            return false;
+        on_insert(idx, hashval);
+        return true;
+    }
+
+    static const key_type& key_of(const key_type& k) { return k; }
+
+    template <class P>
+    static const key_type& key_of(const P& p) { return p.first; }
+
+    std::array<FilterState, (size_t(1) << N)> states_;
+};
+
+}  // namespace priv
+
+// -----------------------------------------------------------------------------
+// phmap::parallel_filtered_flat_hash_set
+// -----------------------------------------------------------------------------
+// A parallel_flat_hash_set for workloads where most lookups miss (such as
+// deduplication): each submap has a Bloom filter, tested without locking
+// before the submap is locked and searched (see priv::parallel_filtered_base).
+//
+// The filters take one byte per slot. The default mutex is std::shared_mutex
+// when available, so that the lookups which pass the filter don't serialize.
+// -----------------------------------------------------------------------------
+template <class T,
+          class Hash  = phmap::priv::hash_default_hash<T>,
+          class Eq    = phmap::priv::hash_default_eq<T>,
+          class Alloc = phmap::priv::Allocator<T>,
+          size_t N    = 4,                          // 2**N submaps
+          class Mutex = priv::filtered_mutex>
+class parallel_filtered_flat_hash_set
+    : public priv::parallel_filtered_base<phmap::parallel_flat_hash_set<T, Hash, Eq, Alloc, N, Mutex>, N, Mutex>
+{
+public:
+    parallel_filtered_flat_hash_set() {}
+
+    template <class... Args>
+    bool emplace(Args&&... args) { return this->emplace_value(T(std::forward<Args>(args)...)); }
+};
+
+// -----------------------------------------------------------------------------
+// phmap::parallel_filtered_flat_hash_map
+// -----------------------------------------------------------------------------
+// The map version of parallel_filtered_flat_hash_set.
+// -----------------------------------------------------------------------------
+template <class K, class V,
+          class Hash  = phmap::priv::hash_default_hash<K>,
+          class Eq    = phmap::priv::hash_default_eq<K>,
+          class Alloc = phmap::priv::Allocator<phmap::priv::Pair<const K, V>>,
+          size_t N    = 4,                          // 2**N submaps
+          class Mutex = priv::filtered_mutex>
+class parallel_filtered_flat_hash_map
+    : public priv::parallel_filtered_base<phmap::parallel_flat_hash_map<K, V, Hash, Eq, Alloc, N, Mutex>, N, Mutex>
+{
+    using Base = typename parallel_filtered_flat_hash_map::parallel_filtered_base;
+    using typename Base::Inner;
+    using typename Base::UniqueLock;
+
+public:
+    using mapped_type = V;
+
+    parallel_filtered_flat_hash_map() {}
+
+    // Inserts `key` with a value constructed from `args` if `key` is not
+    // present. Returns true if inserted.
+    // -----------------------------------------------------------------
+    template <class... Args>
+    bool try_emplace(const K& key, Args&&... args) {
+        size_t hashval = this->hash(key);
+        size_t idx     = this->subidx(hashval);
+        Inner& inner   = this->sets_[idx];
+        UniqueLock m(inner);
+        bool inserted = false;
+        inner.set_.lazy_emplace_with_hash(key, hashval,
+            [&](const typename Base::EmbeddedSet::constructor& ctor) {
+                ctor(std::piecewise_construct, std::forward_as_tuple(key),
+                     std::forward_as_tuple(std::forward<Args>(args)...));
+                inserted = true;
+            });
+        if (inserted)
+            this->on_insert(idx, hashval);
+        return inserted;
+    }
+
+    // Inserts or assigns the value of `key`. Returns true if inserted.
+    // -----------------------------------------------------------------
+    template <class VV>
+    bool insert_or_assign(const K& key, VV&& v) {
+        size_t hashval = this->hash(key);
+        size_t idx     = this->subidx(hashval);
+        Inner& inner   = this->sets_[idx];
+        UniqueLock m(inner);
+        auto p = inner.set_.find_ptr(key, hashval);
+        if (p) {
+            p->second = std::forward<VV>(v);
+            return false;
+        }
+        inner.set_.emplace_with_hash(hashval, std::piecewise_construct, std::forward_as_tuple(key),
+                                     std::forward_as_tuple(std::forward<VV>(v)));
+        this->on_insert(idx, hashval);
+        return true;
+    }
+};
+
+}  // namespace phmap
+
+#endif // phmap_filter_h_guard_
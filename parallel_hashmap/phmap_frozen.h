@@ -0,0 +1,512 @@
+#if !defined(phmap_frozen_h_guard_)
+#define phmap_frozen_h_guard_
+
+// ---------------------------------------------------------------------------
+// Copyright (c) 2019, Gregory Popovitch - greg7mdp@gmail.com
+//
+//       providing frozen_hash_map, an immutable map using a minimal perfect
+//       hash function.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "phmap.h"
+#include "phmap_dump.h"
+
+namespace phmap {
+
+// -----------------------------------------------------------------------------
+// phmap::frozen_hash_map
+// -----------------------------------------------------------------------------
+// An immutable map, built once from a range (any phmap container, a sorted
+// vector...), storing its n values in an array of exactly n entries.
+//
+// The position of a key is given by a minimal perfect hash function, built
+// with the PTHash algorithm:
+//
+//  - keys are distributed into about n/4 buckets (skewed: 60% of the keys go
+//    to 30% of the buckets),
+//  - buckets are processed by decreasing size; for each, we search the
+//    smallest "pilot" such that (hash ^ mix(pilot)) mod m sends all its keys to
+//    free positions of a table of size m (slightly larger than n),
+//  - the few keys landing at positions >= n are remapped to the holes < n.
+//
+// A lookup computes one hash, reads one pilot (and rarely one remap entry),
+// and does a single key comparison. There are no empty slots and no control
+// bytes, the extra space (pilots and remap table) is about 1.25 byte per key.
+//
+// All keys must have distinct hash values (std::invalid_argument is thrown
+// otherwise). When the source contains a key several times, the first one is
+// kept.
+//
+// When K and V are trivially copyable, the map can be written with
+// phmap_dump() (see phmap_dump.h), and either read back with phmap_load(),
+// or used in place with attach() from a memory mapped dump file, with no
+// copy or rebuild.
+// -----------------------------------------------------------------------------
+template <class K, class V, class Hash, class Eq>
+class frozen_hash_map
+{
+public:
+    using key_type        = K;
+    using mapped_type     = V;
+    using value_type      = std::pair<const K, V>;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+    using hasher          = Hash;
+    using key_equal       = Eq;
+    using reference       = const value_type&;
+    using const_reference = const value_type&;
+    using pointer         = const value_type*;
+    using const_pointer   = const value_type*;
+    using iterator        = const value_type*;
+    using const_iterator  = const value_type*;
+
+    frozen_hash_map() {}
+
+    template <class InputIt>
+    frozen_hash_map(InputIt first, InputIt last,
+                    const hasher& hash = hasher(), const key_equal& eq = key_equal())
+        : hash_(hash), eq_(eq)
+    {
+        build(std::vector<value_type>(first, last));
+    }
+
+    frozen_hash_map(std::initializer_list<value_type> init,
+                    const hasher& hash = hasher(), const key_equal& eq = key_equal())
+        : frozen_hash_map(init.begin(), init.end(), hash, eq) {}
+
+    // builds from any container of (key, value) pairs
+    template <class Container,
+              class = decltype(std::begin(std::declval<const Container&>()))>
+    explicit frozen_hash_map(const Container& c,
+                             const hasher& hash = hasher(), const key_equal& eq = key_equal())
+        : frozen_hash_map(std::begin(c), std::end(c), hash, eq) {}
+
+    frozen_hash_map(const frozen_hash_map& o)
+        : hash_(o.hash_), eq_(o.eq_), size_(o.size_), table_size_(o.table_size_),
+          num_buckets_(o.num_buckets_), dense_buckets_(o.dense_buckets_), seed_(o.seed_),
+          pilots_store_(o.pilots_store_), remap_store_(o.remap_store_), values_store_(o.values_store_),
+          pilots_(o.pilots_), remap_(o.remap_), values_(o.values_), attached_(o.attached_)
+    {
+        if (!attached_)
+            bind_store();
+    }
+
+    frozen_hash_map(frozen_hash_map&& o) noexcept { swap(o); }
+
+    frozen_hash_map& operator=(frozen_hash_map o) noexcept {
+        swap(o);
+        return *this;
+    }
+
+    void swap(frozen_hash_map& o) noexcept {
+        using std::swap;
+        swap(hash_, o.hash_);
+        swap(eq_, o.eq_);
+        swap(size_, o.size_);
+        swap(table_size_, o.table_size_);
+        swap(num_buckets_, o.num_buckets_);
+        swap(dense_buckets_, o.dense_buckets_);
+        swap(seed_, o.seed_);
+        pilots_store_.swap(o.pilots_store_);   // vector swaps keep the buffers,
+        remap_store_.swap(o.remap_store_);     // so the pointers stay valid
+        values_store_.swap(o.values_store_);
+        swap(pilots_, o.pilots_);
+        swap(remap_, o.remap_);
+        swap(values_, o.values_);
+        swap(attached_, o.attached_);
+    }
+
+    // ---------------------------------------------------------------------
+    const_iterator begin()  const { return values_; }
+    const_iterator end()    const { return values_ + size_; }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend()   const { return end(); }
+
+    size_t size()  const { return size_; }
+    bool   empty() const { return size_ == 0; }
+
+    hasher    hash_function() const { return hash_; }
+    key_equal key_eq()        const { return eq_; }
+
+    // bytes used by the pilots, remap and value arrays
+    size_t bytes_used() const {
+        return num_buckets_ * sizeof(uint32_t) + (table_size_ - size_) * sizeof(uint32_t) +
+               size_ * sizeof(value_type);
+    }
+
+    // ---------------------------------------------------------------------
+    const_iterator find(const key_type& key) const {
+        if (size_ == 0)
+            return end();
+        const value_type* v = values_ + position(key_hash(key));
+        return eq_(v->first, key) ? v : end();
+    }
+
+    bool   contains(const key_type& key) const { return find(key) != end(); }
+    size_t count(const key_type& key)    const { return contains(key) ? 1 : 0; }
+
+    const mapped_type& at(const key_type& key) const {
+        auto it = find(key);
+        if (it == end())
+            phmap::base_internal::ThrowStdOutOfRange("phmap at(): lookup non-existent key");
+        return it->second;
+    }
+
+    friend bool operator==(const frozen_hash_map& a, const frozen_hash_map& b) {
+        if (a.size() != b.size())
+            return false;
+        for (auto& v : a) {
+            auto it = b.find(v.first);
+            if (it == b.end() || !(it->second == v.second))
+                return false;
+        }
+        return true;
+    }
+
+    friend bool operator!=(const frozen_hash_map& a, const frozen_hash_map& b) {
+        return !(a == b);
+    }
+
+    friend void swap(frozen_hash_map& a, frozen_hash_map& b) noexcept { a.swap(b); }
+
+#if !defined(PHMAP_NON_DETERMINISTIC) && !defined(PHMAP_DISABLE_DUMP)
+    // ---------------------------------------------------------------------
+    // Serialization. The layout is a header of 64 bit words, followed by the
+    // pilots, the remap table and the values, each starting at a multiple of
+    // 8 bytes, so that a dump at the start of a file can be attach()ed from
+    // mmap() without copying.
+    // ---------------------------------------------------------------------
+    template<typename OutputArchive>
+    bool phmap_dump(OutputArchive& ar) const {
+        static_assert(type_traits_internal::IsTriviallyCopyable<value_type>::value,
+                      "value_type should be trivially copyable");
+        uint64_t header[kHeaderWords] = { kVersion, sizeof(value_type), size_, table_size_,
+                                          num_buckets_, dense_buckets_, seed_ };
+        ar.saveBinary(header, sizeof(header));
+        save_padded(ar, pilots_, num_buckets_ * sizeof(uint32_t));
+        save_padded(ar, remap_, (table_size_ - size_) * sizeof(uint32_t));
+        save_padded(ar, values_, size_ * sizeof(value_type));
+        return true;
+    }
+
+    template<typename InputArchive>
+    bool phmap_load(InputArchive& ar) {
+        static_assert(type_traits_internal::IsTriviallyCopyable<value_type>::value,
+                      "value_type should be trivially copyable");
+        frozen_hash_map tmp(hash_, eq_);
+        uint64_t header[kHeaderWords];
+        ar.loadBinary(header, sizeof(header));
+        if (!tmp.read_header(header))
+            return false;
+        tmp.pilots_store_.resize(tmp.num_buckets_);
+        tmp.remap_store_.resize(tmp.table_size_ - tmp.size_);
+        tmp.values_store_.resize(tmp.size_);
+        load_padded(ar, tmp.pilots_store_.data(), tmp.num_buckets_ * sizeof(uint32_t));
+        load_padded(ar, tmp.remap_store_.data(), (tmp.table_size_ - tmp.size_) * sizeof(uint32_t));
+        load_padded(ar, tmp.values_store_.data(), tmp.size_ * sizeof(value_type));
+        tmp.bind_store();
+        swap(tmp);
+        return true;
+    }
+
+    // Uses a dump (as written by phmap_dump()) in place. `data` must be 8 byte
+    // aligned and remain valid and unchanged while the map is used.
+    // Returns false if `data` does not hold a compatible dump.
+    // ---------------------------------------------------------------------
+    bool attach(const void* data, size_t len) {
+        static_assert(type_traits_internal::IsTriviallyCopyable<value_type>::value,
+                      "value_type should be trivially copyable");
+        static_assert(alignof(value_type) <= 8, "value_type alignment should be at most 8");
+        const char* p = static_cast<const char*>(data);
+        if (len < sizeof(uint64_t) * kHeaderWords || (reinterpret_cast<uintptr_t>(p) & 7))
+            return false;
+        frozen_hash_map tmp(hash_, eq_);
+        uint64_t header[kHeaderWords];
+        std::memcpy(header, p, sizeof(header));
+        if (!tmp.read_header(header))
+            return false;
+        size_t pilots_bytes = padded(tmp.num_buckets_ * sizeof(uint32_t));
+        size_t remap_bytes  = padded((tmp.table_size_ - tmp.size_) * sizeof(uint32_t));
+        size_t values_bytes = padded(tmp.size_ * sizeof(value_type));
+        if (len < sizeof(header) + pilots_bytes + remap_bytes + values_bytes)
+            return false;
+        p += sizeof(header);
+        tmp.pilots_ = reinterpret_cast<const uint32_t*>(p);
+        p += pilots_bytes;
+        tmp.remap_ = reinterpret_cast<const uint32_t*>(p);
+        p += remap_bytes;
+        tmp.values_ = reinterpret_cast<const value_type*>(p);
+        tmp.attached_ = true;
+        swap(tmp);
+        return true;
+    }
+#endif
+
+private:
+    static constexpr uint64_t kVersion     = 0x70686d6170465a31ull;  // "phmapFZ1"
+    static constexpr size_t   kHeaderWords = 7;
+    static constexpr size_t   kKeysPerBucket = 4;
+    static constexpr uint32_t kMaxPilot    = 1u << 20;
+
+    frozen_hash_map(const hasher& hash, const key_equal& eq) : hash_(hash), eq_(eq) {}
+
+    // a bijection, so that distinct raw hashes stay distinct
+    static uint64_t mix64(uint64_t x) {
+        x *= 0x9e3779b97f4a7c15ull;
+        return x ^ (x >> 32);
+    }
+
+    // high 64 bits of x * range, in [0, range)
+    static uint64_t fastrange64(uint64_t x, uint64_t range) {
+#if defined(PHMAP_HAS_UMUL128)
+        uint64_t high;
+        (void)phmap::umul128(x, range, &high);
+        return high;
+#else
+        uint64_t x_lo = x & 0xffffffffull, x_hi = x >> 32;
+        uint64_t r_lo = range & 0xffffffffull, r_hi = range >> 32;
+        uint64_t mid  = x_hi * r_lo + ((x_lo * r_lo) >> 32);
+        uint64_t mid2 = x_lo * r_hi + (mid & 0xffffffffull);
+        return x_hi * r_hi + (mid >> 32) + (mid2 >> 32);
+#endif
+    }
+
+    static uint32_t fastrange32(uint64_t x, uint64_t range) {
+        return static_cast<uint32_t>(((x & 0xffffffffull) * range) >> 32);
+    }
+
+    uint64_t raw_hash(const key_type& key) const { return static_cast<uint64_t>(hash_(key)); }
+
+    uint64_t seeded(uint64_t raw) const { return mix64(raw ^ seed_); }
+
+    uint64_t key_hash(const key_type& key) const { return seeded(raw_hash(key)); }
+
+    // skewed bucket assignment: 60% of the keys go to the first 30% of the buckets
+    size_t bucket_of(uint64_t h) const {
+        // written so that it compiles to conditional moves, the test is unpredictable
+        bool   dense = (h >> 32) < 0x9999999aull;   // 0.6 * 2**32
+        size_t first = dense ? 0 : dense_buckets_;
+        size_t count = dense ? dense_buckets_ : num_buckets_ - dense_buckets_;
+        return first + fastrange32(h, count);
+    }
+
+    static size_t slot_of(uint64_t h, uint32_t pilot, size_t table_size) {
+        return static_cast<size_t>(fastrange64(h ^ (pilot * 0xc2b2ae3d27d4eb4full), table_size));
+    }
+
+    size_t position(uint64_t h) const {
+        size_t p = slot_of(h, pilots_[bucket_of(h)], table_size_);
+        return p < size_ ? p : remap_[p - size_];
+    }
+
+    void bind_store() {
+        pilots_ = pilots_store_.data();
+        remap_  = remap_store_.data();
+        values_ = values_store_.data();
+    }
+
+    // ---------------------------------------------------------------------
+    void build(std::vector<value_type> items) {
+        // sort the (hash, index) pairs to drop duplicate keys and detect
+        // hash collisions, which no seed could resolve.
+        std::vector<std::pair<uint64_t, size_t>> hashes;
+        hashes.reserve(items.size());
+        for (size_t i = 0; i < items.size(); ++i)
+            hashes.emplace_back(raw_hash(items[i].first), i);
+        std::sort(hashes.begin(), hashes.end());
+
+        size_t n = 0;
+        for (size_t i = 0; i < hashes.size(); ++i) {
+            if (n && hashes[n - 1].first == hashes[i].first) {
+                if (!eq_(items[hashes[n - 1].second].first, items[hashes[i].second].first))
+                    phmap::base_internal::ThrowStdInvalidArgument(
+                        "phmap frozen_hash_map: distinct keys with the same hash value");
+                continue;   // duplicate key, keep the first one
+            }
+            hashes[n++] = hashes[i];
+        }
+        hashes.resize(n);
+
+        size_          = n;
+        table_size_    = n ? n + (n >> 4) + 1 : 0;   // load factor ~0.94
+        num_buckets_   = n ? (std::max)(size_t(2), (n + kKeysPerBucket - 1) / kKeysPerBucket) : 0;
+        dense_buckets_ = n ? (std::max)(size_t(1), num_buckets_ * 3 / 10) : 0;
+        seed_          = 0x9e3779b97f4a7c15ull;
+
+        std::vector<size_t> slots;   // slot in [0, table_size_) of each entry of `hashes`
+        while (n && !find_pilots(hashes, slots))
+            seed_ = mix64(seed_ + 1);
+
+        // positions >= size_ are remapped to the free positions < size_
+        remap_store_.assign(table_size_ - size_, 0);
+        std::vector<size_t> order(size_);   // order[final position] = item index
+        {
+            std::vector<bool> taken(size_);
+            for (size_t s : slots)
+                if (s < size_)
+                    taken[s] = true;
+            size_t next_free = 0;
+            for (size_t i = 0; i < n; ++i) {
+                size_t s = slots[i];
+                if (s >= size_) {
+                    while (taken[next_free])
+                        ++next_free;
+                    taken[next_free] = true;
+                    remap_store_[s - size_] = static_cast<uint32_t>(next_free);
+                    s = next_free;
+                }
+                order[s] = hashes[i].second;
+            }
+        }
+
+        values_store_.clear();
+        values_store_.reserve(size_);
+        for (size_t i = 0; i < size_; ++i)
+            values_store_.push_back(std::move(items[order[i]]));
+        bind_store();
+    }
+
+    // Finds a pilot for each bucket with the current seed. Returns false if
+    // some bucket needs a pilot over kMaxPilot (then a new seed is tried).
+    bool find_pilots(const std::vector<std::pair<uint64_t, size_t>>& hashes,
+                     std::vector<size_t>& slots) {
+        const size_t n = hashes.size();
+
+        // group the entries by bucket (counting sort)
+        std::vector<size_t> bucket(n);
+        std::vector<size_t> start(num_buckets_ + 1, 0);
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t h = seeded(hashes[i].first);
+            bucket[i]  = bucket_of(h);
+            ++start[bucket[i] + 1];
+        }
+        size_t max_size = 0;
+        for (size_t b = 0; b < num_buckets_; ++b) {
+            max_size = (std::max)(max_size, start[b + 1]);
+            start[b + 1] += start[b];
+        }
+        std::vector<size_t> members(n);   // entry indices, grouped by bucket
+        {
+            std::vector<size_t> fill(start.begin(), start.end() - 1);
+            for (size_t i = 0; i < n; ++i)
+                members[fill[bucket[i]]++] = i;
+        }
+        std::vector<uint64_t> grouped(n);  // hashes, grouped by bucket
+        for (size_t j = 0; j < n; ++j)
+            grouped[j] = seeded(hashes[members[j]].first);
+
+        // process the buckets by decreasing size (counting sort again)
+        std::vector<std::vector<size_t>> by_size(max_size + 1);
+        for (size_t b = 0; b < num_buckets_; ++b)
+            by_size[start[b + 1] - start[b]].push_back(b);
+
+        pilots_store_.assign(num_buckets_, 0);
+        slots.assign(n, 0);
+        std::vector<uint64_t> taken((table_size_ + 63) / 64, 0);   // bitset
+        std::vector<size_t> pos;
+        for (size_t sz = max_size; sz > 0; --sz) {
+            for (size_t b : by_size[sz]) {
+                uint32_t pilot = 0;
+                for (;; ++pilot) {
+                    if (pilot == kMaxPilot)
+                        return false;
+                    pos.clear();
+                    bool ok = true;
+                    for (size_t j = start[b]; j < start[b + 1]; ++j) {
+                        size_t s = slot_of(grouped[j], pilot, table_size_);
+                        uint64_t bit = uint64_t(1) << (s & 63);
+                        if (taken[s >> 6] & bit) {
+                            ok = false;
+                            break;
+                        }
+                        taken[s >> 6] |= bit;
+                        pos.push_back(s);
+                    }
+                    if (ok)
+                        break;
+                    for (size_t s : pos)
+                        taken[s >> 6] &= ~(uint64_t(1) << (s & 63));
+                }
+                pilots_store_[b] = pilot;
+                for (size_t j = start[b]; j < start[b + 1]; ++j)
+                    slots[members[j]] = pos[j - start[b]];
+            }
+        }
+        return true;
+    }
+
+#if !defined(PHMAP_NON_DETERMINISTIC) && !defined(PHMAP_DISABLE_DUMP)
+    static size_t padded(size_t bytes) { return (bytes + 7) & ~size_t(7); }
+
+    template<typename OutputArchive>
+    static void save_padded(OutputArchive& ar, const void* p, size_t bytes) {
+        static const char zeros[8] = {};
+        if (bytes)
+            ar.saveBinary(p, bytes);
+        if (padded(bytes) != bytes)
+            ar.saveBinary(zeros, padded(bytes) - bytes);
+    }
+
+    template<typename InputArchive>
+    static void load_padded(InputArchive& ar, void* p, size_t bytes) {
+        char pad[8];
+        if (bytes)
+            ar.loadBinary(p, bytes);
+        if (padded(bytes) != bytes)
+            ar.loadBinary(pad, padded(bytes) - bytes);
+    }
+
+    bool read_header(const uint64_t* header) {
+        if (header[0] != kVersion || header[1] != sizeof(value_type) ||
+            header[3] < header[2] || (header[2] && header[4] < 2))
+            return false;
+        size_          = static_cast<size_t>(header[2]);
+        table_size_    = static_cast<size_t>(header[3]);
+        num_buckets_   = static_cast<size_t>(header[4]);
+        dense_buckets_ = static_cast<size_t>(header[5]);
+        seed_          = header[6];
+        return true;
+    }
+#endif
+
+    hasher    hash_;
+    key_equal eq_;
+    size_t    size_          = 0;
+    size_t    table_size_    = 0;   // m >= size_, range of the perfect hash before remapping
+    size_t    num_buckets_   = 0;
+    size_t    dense_buckets_ = 0;
+    uint64_t  seed_          = 0;
+
+    std::vector<uint32_t>   pilots_store_;
+    std::vector<uint32_t>   remap_store_;
+    std::vector<value_type> values_store_;
+
+    // point either to the vectors above, or to an attach()ed buffer
+    const uint32_t*   pilots_   = nullptr;
+    const uint32_t*   remap_    = nullptr;
+    const value_type* values_   = nullptr;
+    bool              attached_ = false;
+};
+
+}  // namespace phmap
+
+#endif // phmap_frozen_h_guard_
@@ -80,6 +80,19 @@ namespace phmap {
               class Alloc = phmap::priv::Allocator<
                             phmap::priv::Pair<const K, V>>> // alias for std::allocator
         class flat_hash_map;
+
+    template <class T, size_t N = 4,            // inline capacity
+              class Hash  = phmap::priv::hash_default_hash<T>,
+              class Eq    = phmap::priv::hash_default_eq<T>,
+              class Alloc = phmap::priv::Allocator<T>>  // alias for std::allocator
+        class inline_flat_hash_set;
+
+    template <class K, class V, size_t N = 4,   // inline capacity
+              class Hash  = phmap::priv::hash_default_hash<K>,
+              class Eq    = phmap::priv::hash_default_eq<K>,
+              class Alloc = phmap::priv::Allocator<
+                            phmap::priv::Pair<const K, V>>> // alias for std::allocator
+        class inline_flat_hash_map;
     
     template <class T, 
               class Hash  = phmap::priv::hash_default_hash<T>,
@@ -94,6 +107,32 @@ namespace phmap {
                             phmap::priv::Pair<const Key, Value>>> // alias for std::allocator
         class node_hash_map;
 
+    template <class T, 
+              class Hash  = phmap::priv::hash_default_hash<T>,
+              class Eq    = phmap::priv::hash_default_eq<T>,
+              class Alloc = phmap::priv::Allocator<T>>  // alias for std::allocator
+        class cached_hash_flat_hash_set;
+
+    template <class K, class V,
+              class Hash  = phmap::priv::hash_default_hash<K>,
+              class Eq    = phmap::priv::hash_default_eq<K>,
+              class Alloc = phmap::priv::Allocator<
+                            phmap::priv::Pair<const K, V>>> // alias for std::allocator
+        class cached_hash_flat_hash_map;
+
+    template <class T, 
+              class Hash  = phmap::priv::hash_default_hash<T>,
+              class Eq    = phmap::priv::hash_default_eq<T>,
+              class Alloc = phmap::priv::Allocator<T>> // alias for std::allocator
+        class cached_hash_node_hash_set;
+
+    template <class Key, class Value,
+              class Hash  = phmap::priv::hash_default_hash<Key>,
+              class Eq    = phmap::priv::hash_default_eq<Key>,
+              class Alloc = phmap::priv::Allocator<
+                            phmap::priv::Pair<const Key, Value>>> // alias for std::allocator
+        class cached_hash_node_hash_map;
+
     template <class T,
               class Hash  = phmap::priv::hash_default_hash<T>,
               class Eq    = phmap::priv::hash_default_eq<T>,
@@ -128,6 +167,39 @@ namespace phmap {
               class Mutex = phmap::NullMutex>   // use std::mutex to enable internal locks
         class parallel_node_hash_map;
 
+    // ------------- hashed multimaps (see phmap_multimap.h) ------------------------------------
+    template <class K, class V,
+              class Hash  = phmap::priv::hash_default_hash<K>,
+              class Eq    = phmap::priv::hash_default_eq<K>,
+              class Alloc = phmap::priv::Allocator<
+                            phmap::priv::Pair<const K, V>>> // alias for std::allocator
+        class flat_hash_multimap;
+
+    template <class K, class V,
+              class Hash  = phmap::priv::hash_default_hash<K>,
+              class Eq    = phmap::priv::hash_default_eq<K>,
+              class Alloc = phmap::priv::Allocator<
+                            phmap::priv::Pair<const K, V>>, // alias for std::allocator
+              size_t N    = 4,                  // 2**N submaps
+              class Mutex = phmap::NullMutex>   // use std::mutex to enable internal locks
+        class parallel_flat_hash_multimap;
+
+    // ------------- insertion-ordered dense map (see phmap_dense.h) -----------------------------
+    template <class K, class V,
+              class Hash  = phmap::priv::hash_default_hash<K>,
+              class Eq    = phmap::priv::hash_default_eq<K>,
+              class Alloc = phmap::priv::Allocator<
+                            phmap::priv::Pair<const K, V>>> // alias for std::allocator
+        class dense_hash_map;
+
+    // ------------- flat map with 8-byte slots and stable values (see phmap_indirect.h) --------
+    template <class K, class V,
+              class Hash  = phmap::priv::hash_default_hash<K>,
+              class Eq    = phmap::priv::hash_default_eq<K>,
+              class Alloc = phmap::priv::Allocator<
+                            phmap::priv::Pair<const K, V>>> // alias for std::allocator
+        class indirect_flat_hash_map;
+
     // -----------------------------------------------------------------------------
     // phmap::parallel_*_hash_* using std::mutex by default
     // -----------------------------------------------------------------------------
@@ -159,6 +231,30 @@ namespace phmap {
               size_t N     = 4>
     using parallel_node_hash_map_m = parallel_node_hash_map<K, V, Hash, Eq, Alloc, N, std::mutex>;
 
+    // -----------------------------------------------------------------------------
+    // phmap::arena_flat_hash_* allocating from a phmap::arena (see phmap_base.h)
+    // -----------------------------------------------------------------------------
+    class arena;
+    template <class T> class arena_allocator;
+
+    template <class T,
+              class Hash  = phmap::priv::hash_default_hash<T>,
+              class Eq    = phmap::priv::hash_default_eq<T>>
+    using arena_flat_hash_set = flat_hash_set<T, Hash, Eq, arena_allocator<T>>;
+
+    template <class K, class V,
+              class Hash  = phmap::priv::hash_default_hash<K>,
+              class Eq    = phmap::priv::hash_default_eq<K>>
+    using arena_flat_hash_map = flat_hash_map<K, V, Hash, Eq, arena_allocator<phmap::priv::Pair<const K, V>>>;
+
+    // -----------------------------------------------------------------------------
+    // phmap::frozen_hash_map, immutable, using a minimal perfect hash (see phmap_frozen.h)
+    // -----------------------------------------------------------------------------
+    template <class K, class V,
+              class Hash  = phmap::priv::hash_default_hash<K>,
+              class Eq    = phmap::priv::hash_default_eq<K>>
+        class frozen_hash_map;
+
     // ------------- forward declarations for btree containers ----------------------------------
     template <typename Key, typename Compare = phmap::Less<Key>,
               typename Alloc = phmap::Allocator<Key>>
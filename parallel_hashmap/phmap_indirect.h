@@ -0,0 +1,577 @@
+#if !defined(phmap_indirect_h_guard_)
+#define phmap_indirect_h_guard_
+
+// ---------------------------------------------------------------------------
+// Copyright (c) 2019, Gregory Popovitch - greg7mdp@gmail.com
+//
+//       providing indirect_flat_hash_map
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ---------------------------------------------------------------------------
+
+#include <cassert>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "phmap.h"
+
+namespace phmap {
+
+namespace priv {
+
+constexpr uint32_t log2_floor(size_t n) { return n <= 1 ? 0 : 1 + log2_floor(n >> 1); }
+
+// ---------------------------------------------------------------------------
+// Storage for the values of an indirect_flat_hash_map, addressed by a 32-bit
+// index. Values are stored in chunks which are never reallocated, so a value
+// never moves once constructed. The first chunks double in size (16, 32...
+// values) up to about 64KB, the next ones all have that size, so that at
+// most one partly used chunk is wasted.
+// The arena doesn't know which indices hold a constructed value: its owner
+// must destroy them before reset() or the destructor.
+// ---------------------------------------------------------------------------
+template <class T, class Alloc>
+class indexed_arena
+{
+    using AllocTraits = phmap::allocator_traits<Alloc>;
+    using FreeList    = std::vector<uint32_t, typename AllocTraits::template rebind_alloc<uint32_t>>;
+    using Chunks      = std::vector<T*, typename AllocTraits::template rebind_alloc<T*>>;
+
+    enum : uint32_t {
+        kFirstChunkShift = 4,
+        kMaxChunkShift   = log2_floor(64 * 1024 / sizeof(T)) > kFirstChunkShift
+                               ? log2_floor(64 * 1024 / sizeof(T)) : kFirstChunkShift,
+        kNumGrowing      = kMaxChunkShift - kFirstChunkShift,      // chunks of increasing size
+        kGrowingEnd      = (1u << kMaxChunkShift) - (1u << kFirstChunkShift)  // indices they hold
+    };
+
+public:
+    explicit indexed_arena(const Alloc& alloc = Alloc()) : chunks_(alloc), free_(alloc), alloc_(alloc) {}
+
+    indexed_arena(indexed_arena&& o) noexcept
+        : chunks_(std::move(o.chunks_)), next_(o.next_), free_(std::move(o.free_)), alloc_(o.alloc_) {
+        o.chunks_.clear();
+        o.next_ = 0;
+    }
+
+    indexed_arena(const indexed_arena&) = delete;
+    indexed_arena& operator=(const indexed_arena&) = delete;
+
+    ~indexed_arena() {
+        for (uint32_t c = 0; c < chunks_.size(); ++c)
+            AllocTraits::deallocate(alloc_, chunks_[c], chunk_size(c));
+    }
+
+    T& operator[](uint32_t i) {
+        if (i < kGrowingEnd) {
+            uint32_t c = 31 - phmap::base_internal::CountLeadingZeros32((i >> kFirstChunkShift) + 1);
+            return chunks_[c][(size_t)i + (1u << kFirstChunkShift) - chunk_size(c)];
+        }
+        i -= kGrowingEnd;
+        return chunks_[kNumGrowing + (i >> kMaxChunkShift)][i & ((1u << kMaxChunkShift) - 1)];
+    }
+
+    const T& operator[](uint32_t i) const { return (*const_cast<indexed_arena*>(this))[i]; }
+
+    // Makes sure that the next acquire() will not allocate.
+    void prepare() {
+        if (!free_.empty() || next_ < capacity())
+            return;
+        if (next_ == (std::numeric_limits<uint32_t>::max)())
+            phmap::base_internal::ThrowStdLengthError("phmap: too many values for a 32-bit index");
+        chunks_.push_back(nullptr);
+        chunks_.back() = AllocTraits::allocate(alloc_, chunk_size((uint32_t)chunks_.size() - 1));
+    }
+
+    // PRECONDITION: prepare() was called since the last acquire(). Doesn't throw.
+    uint32_t acquire() {
+        if (!free_.empty()) {
+            uint32_t i = free_.back();
+            free_.pop_back();
+            return i;
+        }
+        return next_++;
+    }
+
+    // gives back an index from acquire() which doesn't hold a value
+    void release(uint32_t i) {
+        if (i + 1 == next_)
+            --next_;
+        else
+            free_.push_back(i);
+    }
+
+    template <class... Args>
+    void construct(uint32_t i, Args&&... args) {
+        AllocTraits::construct(alloc_, &(*this)[i], std::forward<Args>(args)...);
+    }
+
+    // doesn't release `i`
+    void destroy(uint32_t i) { AllocTraits::destroy(alloc_, &(*this)[i]); }
+
+    // PRECONDITION: all values are destroyed. Keeps the chunks.
+    void reset() {
+        next_ = 0;
+        free_.clear();
+    }
+
+    void swap(indexed_arena& o) noexcept {
+        chunks_.swap(o.chunks_);
+        std::swap(next_, o.next_);
+        free_.swap(o.free_);
+        std::swap(alloc_, o.alloc_);
+    }
+
+    // number of values for which memory is allocated
+    size_t capacity() const {
+        size_t n = chunks_.size();
+        if (n <= kNumGrowing)
+            return (size_t(1) << (kFirstChunkShift + n)) - (size_t(1) << kFirstChunkShift);
+        return kGrowingEnd + ((n - kNumGrowing) << kMaxChunkShift);
+    }
+
+private:
+    static size_t chunk_size(uint32_t c) {
+        return size_t(1) << (c < kNumGrowing ? kFirstChunkShift + c : kMaxChunkShift);
+    }
+
+    Chunks   chunks_;
+    uint32_t next_ = 0;   // indices >= next_ have never been used
+    FreeList free_;
+    Alloc    alloc_;
+};
+
+}  // namespace priv
+
+// -----------------------------------------------------------------------------
+// phmap::indirect_flat_hash_map
+// -----------------------------------------------------------------------------
+// A hash map for large values. The hash table (a flat_hash_set) holds 8-byte
+// slots: a 32-bit index into a separate value storage, and 32 bits of the
+// hash of the key. The (key, value) pairs are stored in chunks which are
+// never reallocated.
+//
+// - empty slots take 8 bytes (plus the control byte) instead of the size of
+//   a value,
+// - growing the table rehashes and moves the 8-byte slots only, using the
+//   stored hash bits, without touching the values,
+// - a lookup compares the stored hash bits before comparing keys, so it
+//   reads a value only when it is very likely the one looked for,
+// - references and pointers to the elements are stable (as for
+//   node_hash_map), while the values are allocated in large chunks instead
+//   of one allocation per value. Iterators are invalidated by rehashing.
+//
+// At most 2**32 - 1 elements can be stored.
+// -----------------------------------------------------------------------------
+template <class K, class V, class Hash, class Eq, class Alloc>
+class indirect_flat_hash_map
+{
+    using AllocTraits = phmap::allocator_traits<Alloc>;
+
+public:
+    using key_type        = K;
+    using mapped_type     = V;
+    using value_type      = std::pair<const K, V>;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+    using hasher          = Hash;
+    using key_equal       = Eq;
+    using allocator_type  = Alloc;
+    using reference       = value_type&;
+    using const_reference = const value_type&;
+
+private:
+    using ValueAlloc = typename AllocTraits::template rebind_alloc<value_type>;
+    using Arena      = priv::indexed_arena<value_type, ValueAlloc>;
+
+    struct slot
+    {
+        uint32_t idx;
+        uint32_t hash;
+    };
+
+    template <class KK>
+    struct key_ref
+    {
+        const KK*                     k;
+        const indirect_flat_hash_map* m;
+        uint32_t                      hash;
+    };
+
+    struct SlotHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(const slot& s) const { return s.hash; }
+        template <class KK>
+        size_t operator()(const key_ref<KK>& r) const { return r.hash; }
+    };
+
+    struct SlotEq
+    {
+        using is_transparent = void;
+
+        bool operator()(const slot& a, const slot& b) const { return a.idx == b.idx; }
+
+        template <class KK>
+        bool operator()(const slot& s, const key_ref<KK>& r) const {
+            return s.hash == r.hash && r.m->eq_(r.m->arena_[s.idx].first, *r.k);
+        }
+        template <class KK>
+        bool operator()(const key_ref<KK>& r, const slot& s) const { return (*this)(s, r); }
+    };
+
+    using SlotAlloc = typename AllocTraits::template rebind_alloc<slot>;
+    using Index     = phmap::flat_hash_set<slot, SlotHash, SlotEq, SlotAlloc>;
+
+    template <class KK>
+    using key_arg = typename phmap::priv::KeyArg<phmap::priv::IsTransparent<Eq>::value &&
+                                                 phmap::priv::IsTransparent<Hash>::value>::
+        template type<KK, K>;
+
+    template <class MapArena, class Ref>
+    class iter
+    {
+        friend class indirect_flat_hash_map;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = typename indirect_flat_hash_map::value_type;
+        using reference         = Ref&;
+        using pointer           = Ref*;
+        using difference_type   = ptrdiff_t;
+
+        iter() {}
+        template <class A, class R, typename std::enable_if<std::is_convertible<R*, Ref*>::value, int>::type = 0>
+        iter(const iter<A, R>& o) : inner_(o.inner_), arena_(o.arena_) {}
+
+        reference operator*()  const { return (*arena_)[inner_->idx]; }
+        pointer   operator->() const { return &**this; }
+
+        iter& operator++() { ++inner_; return *this; }
+        iter  operator++(int) { iter tmp = *this; ++inner_; return tmp; }
+
+        friend bool operator==(const iter& a, const iter& b) { return a.inner_ == b.inner_; }
+        friend bool operator!=(const iter& a, const iter& b) { return a.inner_ != b.inner_; }
+
+    private:
+        template <class A, class R> friend class iter;
+
+        iter(typename Index::const_iterator inner, MapArena* arena) : inner_(inner), arena_(arena) {}
+
+        typename Index::const_iterator inner_;
+        MapArena*                      arena_ = nullptr;
+    };
+
+public:
+    using iterator       = iter<Arena, value_type>;
+    using const_iterator = iter<const Arena, const value_type>;
+
+    indirect_flat_hash_map() {}
+
+    explicit indirect_flat_hash_map(size_t bucket_cnt,
+                                    const hasher& hash = hasher(),
+                                    const key_equal& eq = key_equal(),
+                                    const allocator_type& alloc = allocator_type())
+        : index_(bucket_cnt, SlotHash(), SlotEq(), SlotAlloc(alloc)), arena_(ValueAlloc(alloc)),
+          hash_(hash), eq_(eq) {}
+
+    template <class InputIter>
+    indirect_flat_hash_map(InputIter first, InputIter last, size_t bucket_cnt = 0,
+                           const hasher& hash = hasher(), const key_equal& eq = key_equal(),
+                           const allocator_type& alloc = allocator_type())
+        : indirect_flat_hash_map(bucket_cnt, hash, eq, alloc) {
+        insert(first, last);
+    }
+
+    indirect_flat_hash_map(std::initializer_list<value_type> init, size_t bucket_cnt = 0,
+                           const hasher& hash = hasher(), const key_equal& eq = key_equal(),
+                           const allocator_type& alloc = allocator_type())
+        : indirect_flat_hash_map(init.begin(), init.end(), bucket_cnt, hash, eq, alloc) {}
+
+    indirect_flat_hash_map(const indirect_flat_hash_map& o)
+        : indirect_flat_hash_map(o.size(), o.hash_, o.eq_,
+                                 AllocTraits::select_on_container_copy_construction(o.get_allocator())) {
+        // the stored hash bits are reused, keys are not hashed again
+        for (const slot& s : o.index_) {
+            arena_.prepare();
+            uint32_t idx = arena_.acquire();
+            construct_or_release(idx, o.arena_[s.idx]);
+            index_.insert(slot{idx, s.hash});
+        }
+    }
+
+    indirect_flat_hash_map(indirect_flat_hash_map&& o) noexcept
+        : index_(std::move(o.index_)), arena_(std::move(o.arena_)), hash_(o.hash_), eq_(o.eq_) {}
+
+    indirect_flat_hash_map& operator=(indirect_flat_hash_map o) {
+        swap(o);
+        return *this;
+    }
+
+    ~indirect_flat_hash_map() { destroy_values(); }
+
+    // ---------------------------------------------------------------------
+    iterator       begin()        { return iterator(index_.begin(), &arena_); }
+    const_iterator begin()  const { return const_iterator(index_.begin(), &arena_); }
+    const_iterator cbegin() const { return begin(); }
+    iterator       end()          { return iterator(index_.end(), &arena_); }
+    const_iterator end()    const { return const_iterator(index_.end(), &arena_); }
+    const_iterator cend()   const { return end(); }
+
+    size_t size()     const { return index_.size(); }
+    bool   empty()    const { return index_.empty(); }
+    size_t max_size() const { return (std::numeric_limits<uint32_t>::max)(); }
+
+    size_t bucket_count() const { return index_.bucket_count(); }
+    float  load_factor()  const { return index_.load_factor(); }
+
+    // number of values for which memory is allocated
+    size_t value_capacity() const { return arena_.capacity(); }
+
+    void clear() {
+        destroy_values();
+        index_.clear();
+        arena_.reset();
+    }
+
+    void reserve(size_t n) { index_.reserve(n); }
+    void rehash(size_t n)  { index_.rehash(n); }
+
+    void swap(indirect_flat_hash_map& o) noexcept {
+        index_.swap(o.index_);
+        arena_.swap(o.arena_);
+        std::swap(hash_, o.hash_);
+        std::swap(eq_, o.eq_);
+    }
+
+    hasher         hash_function() const { return hash_; }
+    key_equal      key_eq()        const { return eq_; }
+    allocator_type get_allocator() const { return allocator_type(index_.get_allocator()); }
+
+    // ---------------------------------------------------------------------
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(const K& key, Args&&... args) {
+        return try_emplace_impl(key, std::forward<Args>(args)...);
+    }
+
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+        return try_emplace_impl(std::move(key), std::forward<Args>(args)...);
+    }
+
+    // The value is constructed in place first, and destroyed if its key is
+    // already present.
+    // ---------------------------------------------------------------------
+    template <class... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        arena_.prepare();
+        uint32_t idx = arena_.acquire();
+        construct_or_release(idx, std::forward<Args>(args)...);
+        const K& key = arena_[idx].first;
+        key_ref<K> ref{&key, this, short_hash(key)};
+        bool inserted = false;
+#ifdef PHMAP_HAVE_EXCEPTIONS
+        try {
+#endif
+            auto it = index_.lazy_emplace_with_hash(ref, index_.hash(ref),
+                [&](const typename Index::constructor& ctor) {
+                    ctor(slot{idx, ref.hash});
+                    inserted = true;
+                });
+            if (!inserted)
+                erase_value(idx);
+            return {iterator(it, &arena_), inserted};
+#ifdef PHMAP_HAVE_EXCEPTIONS
+        } catch (...) {
+            erase_value(idx);
+            throw;
+        }
+#endif
+    }
+
+    std::pair<iterator, bool> insert(const value_type& v) { return try_emplace_impl(v.first, v.second); }
+
+    template <class P, typename std::enable_if<std::is_constructible<value_type, P&&>::value, int>::type = 0>
+    std::pair<iterator, bool> insert(P&& v) { return emplace(std::forward<P>(v)); }
+
+    template <class InputIter>
+    void insert(InputIter first, InputIter last) {
+        for (; first != last; ++first)
+            emplace(*first);
+    }
+
+    void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+    template <class VV>
+    std::pair<iterator, bool> insert_or_assign(const K& key, VV&& v) {
+        auto res = try_emplace_impl(key, std::forward<VV>(v));
+        if (!res.second)
+            res.first->second = std::forward<VV>(v);
+        return res;
+    }
+
+    template <class KK = K>
+    V& operator[](const key_arg<KK>& key) { return try_emplace_impl(key).first->second; }
+
+    V& operator[](K&& key) { return try_emplace_impl(std::move(key)).first->second; }
+
+    // ---------------------------------------------------------------------
+    template <class KK = K>
+    iterator find(const key_arg<KK>& key) {
+        key_ref<KK> ref{&key, this, short_hash(key)};
+        return iterator(index_.find(ref, index_.hash(ref)), &arena_);
+    }
+
+    template <class KK = K>
+    const_iterator find(const key_arg<KK>& key) const {
+        return const_cast<indirect_flat_hash_map*>(this)->find(key);
+    }
+
+    template <class KK = K>
+    bool contains(const key_arg<KK>& key) const { return find(key) != end(); }
+
+    template <class KK = K>
+    size_t count(const key_arg<KK>& key) const { return contains(key) ? 1 : 0; }
+
+    template <class KK = K>
+    V& at(const key_arg<KK>& key) {
+        auto it = find(key);
+        if (it == end())
+            phmap::base_internal::ThrowStdOutOfRange("phmap at(): lookup non-existent key");
+        return it->second;
+    }
+
+    template <class KK = K>
+    const V& at(const key_arg<KK>& key) const {
+        return const_cast<indirect_flat_hash_map*>(this)->at(key);
+    }
+
+    // ---------------------------------------------------------------------
+    template <class KK = K>
+    size_t erase(const key_arg<KK>& key) {
+        auto it = find(key);
+        if (it == end())
+            return 0;
+        erase(it);
+        return 1;
+    }
+
+    // Returns an iterator to the next element. Erasing doesn't move the other
+    // elements in the table, so erasing while iterating visits every element.
+    iterator erase(const_iterator pos) {
+        iterator next(pos.inner_, &arena_);
+        ++next;
+        erase_value(pos.inner_->idx);
+        index_._erase(pos.inner_);
+        return next;
+    }
+
+    iterator erase(iterator pos) { return erase(const_iterator(pos)); }
+
+    friend bool operator==(const indirect_flat_hash_map& a, const indirect_flat_hash_map& b) {
+        if (a.size() != b.size())
+            return false;
+        for (const value_type& v : a) {
+            auto it = b.find(v.first);
+            if (it == b.end() || !(it->second == v.second))
+                return false;
+        }
+        return true;
+    }
+
+    friend bool operator!=(const indirect_flat_hash_map& a, const indirect_flat_hash_map& b) {
+        return !(a == b);
+    }
+
+    friend void swap(indirect_flat_hash_map& a, indirect_flat_hash_map& b) noexcept { a.swap(b); }
+
+private:
+    // The 32 hash bits stored in the slots. The index mixes them again to
+    // get the probe position and the control byte.
+    template <class KK>
+    uint32_t short_hash(const KK& key) const {
+        return static_cast<uint32_t>(phmap::phmap_mix<sizeof(size_t)>()(hash_(key)));
+    }
+
+    template <class... Args>
+    void construct_or_release(uint32_t idx, Args&&... args) {
+#ifdef PHMAP_HAVE_EXCEPTIONS
+        try {
+#endif
+            arena_.construct(idx, std::forward<Args>(args)...);
+#ifdef PHMAP_HAVE_EXCEPTIONS
+        } catch (...) {
+            arena_.release(idx);
+            throw;
+        }
+#endif
+    }
+
+    template <class KK, class... Args>
+    std::pair<iterator, bool> try_emplace_impl(KK&& key, Args&&... args) {
+        using KeyRef = key_ref<typename std::remove_cv<typename std::remove_reference<KK>::type>::type>;
+        KeyRef ref{&key, this, short_hash(key)};
+        arena_.prepare();
+        uint32_t idx = 0;
+        bool inserted = false;
+        auto it = index_.lazy_emplace_with_hash(ref, index_.hash(ref),
+            [&](const typename Index::constructor& ctor) {
+                idx = arena_.acquire();
+                ctor(slot{idx, ref.hash});
+                inserted = true;
+            });
+        if (inserted) {
+#ifdef PHMAP_HAVE_EXCEPTIONS
+            try {
+#endif
+                arena_.construct(idx, std::piecewise_construct,
+                                 std::forward_as_tuple(std::forward<KK>(key)),
+                                 std::forward_as_tuple(std::forward<Args>(args)...));
+#ifdef PHMAP_HAVE_EXCEPTIONS
+            } catch (...) {
+                index_._erase(it);
+                arena_.release(idx);
+                throw;
+            }
+#endif
+        }
+        return {iterator(it, &arena_), inserted};
+    }
+
+    void erase_value(uint32_t idx) {
+        arena_.destroy(idx);
+        arena_.release(idx);
+    }
+
+    void destroy_values() {
+        if (!std::is_trivially_destructible<value_type>::value) {
+            for (const slot& s : index_)
+                arena_.destroy(s.idx);
+        }
+    }
+
+    Index     index_;
+    Arena     arena_;
+    hasher    hash_;
+    key_equal eq_;
+};
+
+}  // namespace phmap
+
+#endif // phmap_indirect_h_guard_
@@ -0,0 +1,295 @@
+#if !defined(phmap_lru_cache_h_guard_)
+#define phmap_lru_cache_h_guard_
+
+// ---------------------------------------------------------------------------
+// Copyright (c) 2019, Gregory Popovitch - greg7mdp@gmail.com
+//
+//       providing parallel_lru_cache
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ---------------------------------------------------------------------------
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include "phmap.h"
+
+namespace phmap {
+
+namespace priv {
+
+// ---------------------------------------------------------------------------
+// Mapped type of parallel_lru_cache: the cached value and its CLOCK reference
+// bit. The bit is set by lookups holding only a shared lock, hence atomic.
+// ---------------------------------------------------------------------------
+template <class V>
+struct clock_entry
+{
+    template <class VV, typename std::enable_if<
+                  !std::is_same<typename std::decay<VV>::type, clock_entry>::value, int>::type = 0>
+    explicit clock_entry(VV&& v) : value(std::forward<VV>(v)), referenced(0) {}
+
+    clock_entry(const clock_entry& o) : value(o.value), referenced(o.referenced.load(std::memory_order_relaxed)) {}
+    clock_entry(clock_entry&& o) : value(std::move(o.value)), referenced(o.referenced.load(std::memory_order_relaxed)) {}
+
+    clock_entry& operator=(const clock_entry& o) {
+        value = o.value;
+        referenced.store(o.referenced.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
+    void touch() const {
+        // avoid dirtying the cache line when the bit is already set
+        if (!referenced.load(std::memory_order_relaxed))
+            referenced.store(1, std::memory_order_relaxed);
+    }
+
+    V value;
+    mutable std::atomic<uint8_t> referenced;
+};
+
+#ifdef PHMAP_HAVE_SHARED_MUTEX
+    using lru_cache_mutex = std::shared_mutex;
+#else
+    using lru_cache_mutex = std::mutex;
+#endif
+
+}  // namespace priv
+
+struct lru_cache_stats
+{
+    size_t hits      = 0;
+    size_t misses    = 0;
+    size_t evictions = 0;
+};
+
+// -----------------------------------------------------------------------------
+// phmap::parallel_lru_cache
+// -----------------------------------------------------------------------------
+// A bounded cache sharded over the 2**N submaps of a parallel_flat_hash_map.
+// Each submap holds at most capacity() / 2**N entries, and evicts with the
+// CLOCK algorithm (an approximation of LRU) when full:
+//
+//  - every entry has a reference bit, set when it is read,
+//  - the submap keeps a "hand" (a slot index); to evict, the hand sweeps the
+//    slots, clearing the bits it finds set, and evicts the first entry whose
+//    bit is already clear.
+//
+// The eviction metadata lives in the slots, so there is no linked list to
+// update on lookups: get() only takes the submap's shared lock (when Mutex is
+// a shared mutex, which is the default when available). put() and the miss
+// path of get_or_compute() take the submap's unique lock.
+// -----------------------------------------------------------------------------
+template <class K, class V,
+          class Hash  = phmap::priv::hash_default_hash<K>,
+          class Eq    = phmap::priv::hash_default_eq<K>,
+          class Alloc = phmap::priv::Allocator<
+                        phmap::priv::Pair<const K, priv::clock_entry<V>>>,
+          size_t N    = 4,                          // 2**N submaps
+          class Mutex = priv::lru_cache_mutex>
+class parallel_lru_cache
+    : protected phmap::parallel_flat_hash_map<K, priv::clock_entry<V>, Hash, Eq, Alloc, N, Mutex>
+{
+    using Base        = typename parallel_lru_cache::parallel_flat_hash_map;
+    using Inner       = typename Base::Inner;
+    using Lockable    = phmap::LockableImpl<Mutex>;
+    using SharedLock  = typename Lockable::SharedLock;
+    using UniqueLock  = typename Lockable::UniqueLock;
+    using EmbeddedSet = typename Base::EmbeddedSet;
+
+    // per submap, protected by the submap's lock (the counters are updated
+    // under the shared lock too). Aligned so that submaps don't share a line.
+    struct alignas(PHMAP_CACHELINE_SIZE) SubmapState
+    {
+        size_t              hand = 0;
+        std::atomic<size_t> hits{0};
+        std::atomic<size_t> misses{0};
+        std::atomic<size_t> evictions{0};
+    };
+
+public:
+    using key_type    = K;
+    using mapped_type = V;
+
+    // `max_entries` is the maximum number of entries, split evenly among the
+    // submaps (at least one entry per submap).
+    explicit parallel_lru_cache(size_t max_entries,
+                                const Hash& hash = Hash(), const Eq& eq = Eq(),
+                                const Alloc& alloc = Alloc())
+        : Base(0, hash, eq, alloc),
+          submap_capacity_((max_entries + Base::subcnt() - 1) / Base::subcnt())
+    {
+        if (submap_capacity_ == 0)
+            submap_capacity_ = 1;
+        for (size_t i = 0; i < Base::subcnt(); ++i)
+            this->sets_[i].set_.reserve(submap_capacity_);
+    }
+
+    parallel_lru_cache(const parallel_lru_cache&) = delete;
+    parallel_lru_cache& operator=(const parallel_lru_cache&) = delete;
+
+    using Base::size;
+    using Base::empty;
+    using Base::subcnt;
+
+    size_t capacity() const { return submap_capacity_ * Base::subcnt(); }
+
+    // Copies the cached value of `key` into `value` and returns true if
+    // present, returns false otherwise.
+    // -----------------------------------------------------------------
+    bool get(const K& key, V& value) {
+        size_t hashval = this->hash(key);
+        size_t idx     = this->subidx(hashval);
+        Inner& inner   = this->sets_[idx];
+        SharedLock m(inner);
+        auto p = inner.set_.find_ptr(key, hashval);
+        if (!p) {
+            state_[idx].misses.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        p->second.touch();
+        value = p->second.value;
+        state_[idx].hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool contains(const K& key) const { return Base::contains(key); }
+
+    // Inserts or updates `key`. Returns true if the key was inserted.
+    // -----------------------------------------------------------------
+    template <class VV>
+    bool put(const K& key, VV&& value) {
+        size_t hashval = this->hash(key);
+        size_t idx     = this->subidx(hashval);
+        Inner& inner   = this->sets_[idx];
+        UniqueLock m(inner);
+        auto p = inner.set_.find_ptr(key, hashval);
+        if (p) {
+            p->second.value = std::forward<VV>(value);
+            p->second.touch();
+            return false;
+        }
+        insert_locked(idx, key, hashval, std::forward<VV>(value));
+        return true;
+    }
+
+    // Returns the cached value of `key`, or computes it with `fn(key)`, caches
+    // it and returns it. `fn` is called while holding the submap's unique lock,
+    // so it runs once per missing key even when several threads miss on it.
+    // -----------------------------------------------------------------
+    template <class F>
+    V get_or_compute(const K& key, F&& fn) {
+        size_t hashval = this->hash(key);
+        size_t idx     = this->subidx(hashval);
+        Inner& inner   = this->sets_[idx];
+        {
+            SharedLock m(inner);
+            auto p = inner.set_.find_ptr(key, hashval);
+            if (p) {
+                p->second.touch();
+                state_[idx].hits.fetch_add(1, std::memory_order_relaxed);
+                return p->second.value;
+            }
+        }
+        UniqueLock m(inner);
+        auto p = inner.set_.find_ptr(key, hashval);
+        if (p) {
+            // inserted by another thread since we released the shared lock
+            p->second.touch();
+            state_[idx].hits.fetch_add(1, std::memory_order_relaxed);
+            return p->second.value;
+        }
+        state_[idx].misses.fetch_add(1, std::memory_order_relaxed);
+        return insert_locked(idx, key, hashval, fn(key))->second.value;
+    }
+
+    // Removes `key`. Returns the number of entries removed (0 or 1).
+    // -----------------------------------------------------------------
+    size_t erase(const K& key) { return Base::erase(key); }
+
+    // Removes all entries, keeping the memory reserved for capacity() entries.
+    void clear() {
+        for (size_t i = 0; i < Base::subcnt(); ++i) {
+            Inner& inner = this->sets_[i];
+            UniqueLock m(inner);
+            inner.set_.clear();
+            inner.set_.reserve(submap_capacity_);
+            state_[i].hand = 0;
+        }
+    }
+
+    lru_cache_stats stats() const {
+        lru_cache_stats res;
+        for (auto& s : state_) {
+            res.hits      += s.hits.load(std::memory_order_relaxed);
+            res.misses    += s.misses.load(std::memory_order_relaxed);
+            res.evictions += s.evictions.load(std::memory_order_relaxed);
+        }
+        return res;
+    }
+
+    void reset_stats() {
+        for (auto& s : state_) {
+            s.hits.store(0, std::memory_order_relaxed);
+            s.misses.store(0, std::memory_order_relaxed);
+            s.evictions.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    // PRECONDITION: unique lock held on submap `idx`, `key` not present
+    template <class VV>
+    typename EmbeddedSet::iterator insert_locked(size_t idx, const K& key, size_t hashval, VV&& value) {
+        EmbeddedSet& set = this->sets_[idx].set_;
+        if (set.size() >= submap_capacity_)
+            evict_one(idx);
+        return set.lazy_emplace_with_hash(key, hashval,
+            [&](const typename Base::constructor& ctor) {
+                ctor(std::piecewise_construct, std::forward_as_tuple(key),
+                     std::forward_as_tuple(std::forward<VV>(value)));
+            });
+    }
+
+    // PRECONDITION: unique lock held on submap `idx`, submap not empty.
+    // Terminates within two sweeps, as the first one clears all the bits.
+    void evict_one(size_t idx) {
+        EmbeddedSet&  set   = this->sets_[idx].set_;
+        SubmapState&  state = state_[idx];
+        if (state.hand > set.capacity())
+            state.hand = 0;   // the submap was cleared or shrunk
+        auto it = set.iterator_from_index(state.hand);
+        for (;;) {
+            if (it == set.end())
+                it = set.begin();
+            auto& entry = it->second;
+            if (entry.referenced.load(std::memory_order_relaxed)) {
+                entry.referenced.store(0, std::memory_order_relaxed);
+                ++it;
+                continue;
+            }
+            state.hand = set.index_of(it) + 1;
+            set._erase(it);
+            state.evictions.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    size_t submap_capacity_;
+    std::array<SubmapState, (size_t(1) << N)> state_;
+};
+
+}  // namespace phmap
+
+#endif // phmap_lru_cache_h_guard_
@@ -0,0 +1,538 @@
+#if !defined(phmap_multimap_h_guard_)
+#define phmap_multimap_h_guard_
+
+// ---------------------------------------------------------------------------
+// Copyright (c) 2019, Gregory Popovitch - greg7mdp@gmail.com
+//
+//       providing flat_hash_multimap and parallel_flat_hash_multimap
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "phmap.h"
+
+namespace phmap {
+
+// -----------------------------------------------------------------------------
+// phmap::flat_hash_multimap
+// -----------------------------------------------------------------------------
+// A hash map allowing several values per key, without a container per key.
+//
+// Each distinct key is stored once, in a flat_hash_map, along with the offset
+// and the number of its values in a side array shared by all the keys. The
+// values of a key are contiguous, in a segment whose capacity is a power of
+// two. When a segment is full, the values move to a segment twice as large
+// (or the segment is extended in place when it is the last one of the array).
+// Segments released by a move or an erase are reused, by size class.
+//
+// Compared with flat_hash_map<K, std::vector<V>>, there is no allocation per
+// key, and a key entry takes 8 bytes instead of sizeof(std::vector).
+//
+// equal_range() returns the range of the values of a key (not of (key, value)
+// pairs as std::unordered_multimap does, as they all have the same key), as a
+// pair of pointers.
+//
+// V must be default constructible (the unused part of a segment holds
+// default constructed values). As for flat_hash_map, inserting may invalidate
+// iterators and references to the values. At most 2**32 - 1 values can be
+// stored.
+// -----------------------------------------------------------------------------
+template <class K, class V, class Hash, class Eq, class Alloc>
+class flat_hash_multimap
+{
+    static_assert(std::is_default_constructible<V>::value, "V should be default constructible");
+
+    struct key_entry
+    {
+        uint32_t offset;
+        uint32_t count;
+    };
+
+    using AllocTraits = phmap::allocator_traits<Alloc>;
+    using ValueAlloc  = typename AllocTraits::template rebind_alloc<V>;
+    using IndexAlloc  = typename AllocTraits::template rebind_alloc<
+                            phmap::priv::Pair<const K, key_entry>>;
+    using Index       = phmap::flat_hash_map<K, key_entry, Hash, Eq, IndexAlloc>;
+    using FreeList    = std::vector<uint32_t, typename AllocTraits::template rebind_alloc<uint32_t>>;
+
+public:
+    using key_type             = K;
+    using mapped_type          = V;
+    using size_type            = size_t;
+    using hasher               = Hash;
+    using key_equal            = Eq;
+    using allocator_type       = Alloc;
+    using value_iterator       = V*;
+    using const_value_iterator = const V*;
+
+    flat_hash_multimap() {}
+
+    explicit flat_hash_multimap(size_t bucket_cnt,
+                                const hasher& hash = hasher(),
+                                const key_equal& eq = key_equal(),
+                                const allocator_type& alloc = allocator_type())
+        : index_(bucket_cnt, hash, eq, IndexAlloc(alloc)), values_(ValueAlloc(alloc)) {}
+
+    flat_hash_multimap(std::initializer_list<std::pair<K, V>> init) {
+        for (auto& p : init)
+            insert(p.first, p.second);
+    }
+
+    // ---------------------------------------------------------------------
+    size_t size()      const { return size_; }
+    bool   empty()     const { return size_ == 0; }
+    size_t key_count() const { return index_.size(); }
+
+    void clear() {
+        index_.clear();
+        values_.clear();
+        for (auto& l : free_)
+            l.clear();
+        size_ = 0;
+    }
+
+    // reserves space for `num_values` values, of `num_keys` distinct keys
+    void reserve(size_t num_values, size_t num_keys = 0) {
+        values_.reserve(num_values);
+        index_.reserve(num_keys);
+    }
+
+    void swap(flat_hash_multimap& o) noexcept {
+        index_.swap(o.index_);
+        values_.swap(o.values_);
+        std::swap(free_, o.free_);
+        std::swap(size_, o.size_);
+    }
+
+    hasher         hash_function() const { return index_.hash_function(); }
+    key_equal      key_eq()        const { return index_.key_eq(); }
+    allocator_type get_allocator() const { return allocator_type(index_.get_allocator()); }
+
+    template <class KK>
+    size_t hash(const KK& key) const { return index_.hash(key); }
+
+    // Adds a value for `key` (after the existing ones), constructed from
+    // `args`. Returns a reference to the new value.
+    // ---------------------------------------------------------------------
+    template <class... Args>
+    V& emplace(const K& key, Args&&... args) {
+        return emplace_with_hash(key, hash(key), std::forward<Args>(args)...);
+    }
+
+    template <class... Args>
+    V& emplace_with_hash(const K& key, size_t hashval, Args&&... args) {
+        // constructed first, as args may refer to a value of this map, which
+        // grow() or new_segment() would move
+        V tmp(std::forward<Args>(args)...);
+        auto it = index_.lazy_emplace_with_hash(key, hashval,
+            [&](const typename Index::constructor& ctor) {
+                ctor(key, key_entry{0, 0});
+            });
+        key_entry& e = it->second;
+        if (e.count == 0)
+            e.offset = new_segment(0);
+        else if (is_pow2(e.count))
+            grow(e);    // segment full
+        V& v = values_[e.offset + e.count];
+        v = std::move(tmp);
+        ++e.count;
+        ++size_;
+        return v;
+    }
+
+    V& insert(const K& key, const V& value) { return emplace(key, value); }
+    V& insert(const K& key, V&& value)      { return emplace(key, std::move(value)); }
+
+    template <class P>
+    V& insert(const std::pair<P, V>& p) { return emplace(p.first, p.second); }
+
+    template <class InputIt>
+    void insert(InputIt first, InputIt last) {
+        for (; first != last; ++first)
+            emplace(first->first, first->second);
+    }
+
+    // ---------------------------------------------------------------------
+    size_t count(const K& key) const { return count_with_hash(key, hash(key)); }
+
+    size_t count_with_hash(const K& key, size_t hashval) const {
+        auto it = index_.find(key, hashval);
+        return it == index_.end() ? 0 : it->second.count;
+    }
+
+    bool contains(const K& key) const { return count(key) != 0; }
+
+    std::pair<value_iterator, value_iterator> equal_range(const K& key) {
+        return equal_range_with_hash(key, hash(key));
+    }
+
+    std::pair<const_value_iterator, const_value_iterator> equal_range(const K& key) const {
+        return equal_range_with_hash(key, hash(key));
+    }
+
+    std::pair<value_iterator, value_iterator> equal_range_with_hash(const K& key, size_t hashval) {
+        auto it = index_.find(key, hashval);
+        if (it == index_.end())
+            return { nullptr, nullptr };
+        V* first = values_.data() + it->second.offset;
+        return { first, first + it->second.count };
+    }
+
+    std::pair<const_value_iterator, const_value_iterator>
+    equal_range_with_hash(const K& key, size_t hashval) const {
+        auto r = const_cast<flat_hash_multimap*>(this)->equal_range_with_hash(key, hashval);
+        return { r.first, r.second };
+    }
+
+    // Calls `fn(value)` for each value of `key`, returns the number of values.
+    // ---------------------------------------------------------------------
+    template <class F>
+    size_t for_each_of(const K& key, F&& fn) {
+        return for_each_of_with_hash(key, hash(key), std::forward<F>(fn));
+    }
+
+    template <class F>
+    size_t for_each_of(const K& key, F&& fn) const {
+        return for_each_of_with_hash(key, hash(key), std::forward<F>(fn));
+    }
+
+    template <class F>
+    size_t for_each_of_with_hash(const K& key, size_t hashval, F&& fn) {
+        auto r = equal_range_with_hash(key, hashval);
+        for (auto p = r.first; p != r.second; ++p)
+            fn(*p);
+        return static_cast<size_t>(r.second - r.first);
+    }
+
+    template <class F>
+    size_t for_each_of_with_hash(const K& key, size_t hashval, F&& fn) const {
+        auto r = equal_range_with_hash(key, hashval);
+        for (auto p = r.first; p != r.second; ++p)
+            fn(*p);
+        return static_cast<size_t>(r.second - r.first);
+    }
+
+    // Calls `fn(key, value)` for all the values, grouped by key.
+    // ---------------------------------------------------------------------
+    template <class F>
+    void for_each(F&& fn) {
+        for (auto& p : index_)
+            for (uint32_t i = 0; i < p.second.count; ++i)
+                fn(p.first, values_[p.second.offset + i]);
+    }
+
+    template <class F>
+    void for_each(F&& fn) const {
+        for (auto& p : index_)
+            for (uint32_t i = 0; i < p.second.count; ++i)
+                fn(p.first, static_cast<const V&>(values_[p.second.offset + i]));
+    }
+
+    // Removes all the values of `key`, returns the number of values removed.
+    // ---------------------------------------------------------------------
+    size_t erase(const K& key) { return erase_with_hash(key, hash(key)); }
+
+    size_t erase_with_hash(const K& key, size_t hashval) {
+        auto it = index_.find(key, hashval);
+        if (it == index_.end())
+            return 0;
+        key_entry e = it->second;
+        index_.erase(it);
+        release_segment(e.offset, e.count);
+        size_ -= e.count;
+        return e.count;
+    }
+
+    friend bool operator==(const flat_hash_multimap& a, const flat_hash_multimap& b) {
+        if (a.size() != b.size() || a.key_count() != b.key_count())
+            return false;
+        for (auto& p : a.index_) {
+            auto ra = a.equal_range(p.first);
+            auto rb = b.equal_range(p.first);
+            if (ra.second - ra.first != rb.second - rb.first ||
+                !std::is_permutation(ra.first, ra.second, rb.first))
+                return false;
+        }
+        return true;
+    }
+
+    friend bool operator!=(const flat_hash_multimap& a, const flat_hash_multimap& b) {
+        return !(a == b);
+    }
+
+    friend void swap(flat_hash_multimap& a, flat_hash_multimap& b) noexcept { a.swap(b); }
+
+private:
+    static bool is_pow2(uint32_t n) { return (n & (n - 1)) == 0; }
+
+    // segments of size class c hold 2**c values
+    static size_t size_class(uint32_t count) {
+        return count <= 1 ? 0 : 32 - (size_t)phmap::base_internal::CountLeadingZeros32(count - 1);
+    }
+
+    // the offsets of the segments are 32 bits
+    static void check_values_size(size_t n) {
+        if (n > size_t(~uint32_t(0)))
+            phmap::base_internal::ThrowStdLengthError("flat_hash_multimap: too many values");
+    }
+
+    // returns the offset of a free segment of class c
+    uint32_t new_segment(size_t c) {
+        if (c < free_.size() && !free_[c].empty()) {
+            uint32_t offset = free_[c].back();
+            free_[c].pop_back();
+            return offset;
+        }
+        size_t offset = values_.size();
+        size_t cap    = size_t(1) << c;
+        check_values_size(offset + cap);
+        if (offset + cap > values_.capacity())
+            values_.reserve((std::max)(offset + cap, values_.capacity() + values_.capacity() / 2));
+        values_.resize(offset + cap);
+        return static_cast<uint32_t>(offset);
+    }
+
+    // PRECONDITION: the segment of `e` is full (e.count is its capacity)
+    void grow(key_entry& e) {
+        size_t c = size_class(e.count);
+        if (e.offset + e.count == values_.size() && (c + 1 >= free_.size() || free_[c + 1].empty())) {
+            // last segment of the array: extend it in place
+            check_values_size(values_.size() + e.count);
+            if (values_.size() + e.count > values_.capacity())
+                values_.reserve((std::max)(values_.size() + e.count,
+                                           values_.capacity() + values_.capacity() / 2));
+            values_.resize(values_.size() + e.count);
+            return;
+        }
+        uint32_t offset = new_segment(c + 1);
+        std::move(values_.begin() + e.offset, values_.begin() + e.offset + e.count,
+                  values_.begin() + offset);
+        release_segment(e.offset, e.count);
+        e.offset = offset;
+    }
+
+    void release_segment(uint32_t offset, uint32_t count) {
+        size_t c = size_class(count);
+        for (uint32_t i = 0; i < count; ++i)
+            values_[offset + i] = V();   // free the resources held by the values
+        if (c >= free_.size())
+            free_.resize(c + 1);
+        free_[c].push_back(offset);
+    }
+
+    Index                         index_;
+    std::vector<V, ValueAlloc>    values_;
+    std::vector<FreeList>         free_;        // free segment offsets, by size class
+    size_t                        size_ = 0;    // number of values
+};
+
+// -----------------------------------------------------------------------------
+// phmap::parallel_flat_hash_multimap
+// -----------------------------------------------------------------------------
+// 2**N flat_hash_multimaps, each with its own mutex (phmap::NullMutex by
+// default, in which case there is no locking), the key's hash selecting the
+// submap as for parallel_flat_hash_map.
+//
+// Since iterators would outlive the lock, the values of a key are accessed
+// with for_each_of() (shared lock) or for_each_of_m() (unique lock).
+// -----------------------------------------------------------------------------
+template <class K, class V, class Hash, class Eq, class Alloc, size_t N, class Mutex>
+class parallel_flat_hash_multimap
+{
+    static_assert(N <= 12, "N = 12 means 4096 hash tables!");
+    static constexpr size_t num_tables = size_t(1) << N;
+    static constexpr size_t mask       = num_tables - 1;
+
+    using Lockable   = phmap::LockableImpl<Mutex>;
+    using UniqueLock = typename Lockable::UniqueLock;
+    using SharedLock = typename Lockable::SharedLock;
+
+public:
+    using EmbeddedSet    = flat_hash_multimap<K, V, Hash, Eq, Alloc>;
+    using key_type       = K;
+    using mapped_type    = V;
+    using size_type      = size_t;
+    using hasher         = Hash;
+    using key_equal      = Eq;
+    using allocator_type = Alloc;
+
+protected:
+    struct Inner : public Lockable
+    {
+        Inner() {}
+        Inner(const Inner& o) : Lockable(), set_(o.set_) {}
+
+        EmbeddedSet set_;
+    };
+
+public:
+    parallel_flat_hash_multimap() {}
+
+    explicit parallel_flat_hash_multimap(size_t bucket_cnt,
+                                         const hasher& hash = hasher(),
+                                         const key_equal& eq = key_equal(),
+                                         const allocator_type& alloc = allocator_type()) {
+        for (auto& inner : sets_)
+            inner.set_ = EmbeddedSet(bucket_cnt / num_tables, hash, eq, alloc);
+    }
+
+    parallel_flat_hash_multimap(std::initializer_list<std::pair<K, V>> init) {
+        for (auto& p : init)
+            insert(p.first, p.second);
+    }
+
+    static size_t subidx(size_t hashval) {
+        return ((hashval >> 8) ^ (hashval >> 16) ^ (hashval >> 24)) & mask;
+    }
+
+    static size_t subcnt() { return num_tables; }
+
+    template <class KK>
+    size_t hash(const KK& key) const { return sets_[0].set_.hash(key); }
+
+    // ---------------------------------------------------------------------
+    size_t size() const {
+        size_t sz = 0;
+        for (auto& inner : sets_) {
+            SharedLock m(const_cast<Inner&>(inner));
+            sz += inner.set_.size();
+        }
+        return sz;
+    }
+
+    size_t key_count() const {
+        size_t sz = 0;
+        for (auto& inner : sets_) {
+            SharedLock m(const_cast<Inner&>(inner));
+            sz += inner.set_.key_count();
+        }
+        return sz;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    void clear() {
+        for (auto& inner : sets_) {
+            UniqueLock m(inner);
+            inner.set_.clear();
+        }
+    }
+
+    // Adds a value for `key`, constructed from `args` under the unique lock
+    // of the key's submap.
+    // ---------------------------------------------------------------------
+    template <class... Args>
+    void emplace(const K& key, Args&&... args) {
+        size_t hashval = hash(key);
+        Inner& inner   = sets_[subidx(hashval)];
+        UniqueLock m(inner);
+        inner.set_.emplace_with_hash(key, hashval, std::forward<Args>(args)...);
+    }
+
+    void insert(const K& key, const V& value) { emplace(key, value); }
+    void insert(const K& key, V&& value)      { emplace(key, std::move(value)); }
+
+    template <class P>
+    void insert(const std::pair<P, V>& p) { emplace(p.first, p.second); }
+
+    template <class InputIt>
+    void insert(InputIt first, InputIt last) {
+        for (; first != last; ++first)
+            emplace(first->first, first->second);
+    }
+
+    size_t count(const K& key) const {
+        size_t hashval = hash(key);
+        const Inner& inner = sets_[subidx(hashval)];
+        SharedLock m(const_cast<Inner&>(inner));
+        return inner.set_.count_with_hash(key, hashval);
+    }
+
+    bool contains(const K& key) const { return count(key) != 0; }
+
+    size_t erase(const K& key) {
+        size_t hashval = hash(key);
+        Inner& inner   = sets_[subidx(hashval)];
+        UniqueLock m(inner);
+        return inner.set_.erase_with_hash(key, hashval);
+    }
+
+    // Calls `fn(const V&)` for each value of `key`, holding the submap's
+    // shared lock. Returns the number of values.
+    // ---------------------------------------------------------------------
+    template <class F>
+    size_t for_each_of(const K& key, F&& fn) const {
+        size_t hashval = hash(key);
+        const Inner& inner = sets_[subidx(hashval)];
+        SharedLock m(const_cast<Inner&>(inner));
+        return inner.set_.for_each_of_with_hash(key, hashval, std::forward<F>(fn));
+    }
+
+    // Calls `fn(V&)` for each value of `key`, holding the submap's unique lock.
+    // ---------------------------------------------------------------------
+    template <class F>
+    size_t for_each_of_m(const K& key, F&& fn) {
+        size_t hashval = hash(key);
+        Inner& inner   = sets_[subidx(hashval)];
+        UniqueLock m(inner);
+        return inner.set_.for_each_of_with_hash(key, hashval, std::forward<F>(fn));
+    }
+
+    // Calls `fn(const K&, const V&)` for all the values, locking one submap
+    // at a time.
+    // ---------------------------------------------------------------------
+    template <class F>
+    void for_each(F&& fn) const {
+        for (auto& inner : sets_) {
+            SharedLock m(const_cast<Inner&>(inner));
+            static_cast<const EmbeddedSet&>(inner.set_).for_each(fn);
+        }
+    }
+
+    // Extension API: access internal submaps by index under lock protection
+    // -------------------------------------------------
+    template <class F>
+    void with_submap(size_t idx, F&& fCallback) const {
+        const Inner& inner = sets_[idx];
+        SharedLock m(const_cast<Inner&>(inner));
+        fCallback(static_cast<const EmbeddedSet&>(inner.set_));
+    }
+
+    template <class F>
+    void with_submap_m(size_t idx, F&& fCallback) {
+        Inner& inner = sets_[idx];
+        UniqueLock m(inner);
+        fCallback(inner.set_);
+    }
+
+    void swap(parallel_flat_hash_multimap& o) {
+        for (size_t i = 0; i < num_tables; ++i) {
+            UniqueLock m(sets_[i]), m2(o.sets_[i]);
+            sets_[i].set_.swap(o.sets_[i].set_);
+        }
+    }
+
+protected:
+    std::array<Inner, num_tables> sets_;
+};
+
+}  // namespace phmap
+
+#endif // phmap_multimap_h_guard_
@@ -0,0 +1,318 @@
+#if !defined(phmap_snapshot_h_guard_)
+#define phmap_snapshot_h_guard_
+
+// ---------------------------------------------------------------------------
+// Copyright (c) 2019, Gregory Popovitch - greg7mdp@gmail.com
+//
+//       providing parallel_snapshot_flat_hash_map
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ---------------------------------------------------------------------------
+
+#include <array>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "phmap.h"
+
+namespace phmap {
+
+namespace priv {
+
+#ifdef PHMAP_HAVE_SHARED_MUTEX
+    using snapshot_mutex = std::shared_mutex;
+#else
+    using snapshot_mutex = std::mutex;
+#endif
+
+}  // namespace priv
+
+// -----------------------------------------------------------------------------
+// phmap::parallel_snapshot_flat_hash_map
+// -----------------------------------------------------------------------------
+// A parallel_flat_hash_map which can take point-in-time snapshots while
+// writers keep going. Snapshots are copy-on-write, per submap:
+//
+//  - snapshot() takes all the submap locks at once, just long enough to mark
+//    every submap as shared with the new snapshot, which is O(2**N),
+//  - the first write to a marked submap copies it for the snapshots sharing
+//    it, before modifying it. Submaps which are not written to are never
+//    copied: the snapshot reads them in place, under their shared lock.
+//
+// So a snapshot sees the map exactly as it was when it was taken, and costs
+// one copy of each submap modified during its lifetime.
+//
+// Only the members below modify the map, so they can copy the submaps first.
+// A snapshot must not outlive its map.
+// -----------------------------------------------------------------------------
+template <class K, class V,
+          class Hash  = phmap::priv::hash_default_hash<K>,
+          class Eq    = phmap::priv::hash_default_eq<K>,
+          class Alloc = phmap::priv::Allocator<phmap::priv::Pair<const K, V>>,
+          size_t N    = 4,                          // 2**N submaps
+          class Mutex = priv::snapshot_mutex>
+class parallel_snapshot_flat_hash_map
+    : protected phmap::parallel_flat_hash_map<K, V, Hash, Eq, Alloc, N, Mutex>
+{
+    using Base        = typename parallel_snapshot_flat_hash_map::parallel_flat_hash_map;
+    using Inner       = typename Base::Inner;
+    using Lockable    = phmap::LockableImpl<Mutex>;
+    using SharedLock  = typename Lockable::SharedLock;
+    using UniqueLock  = typename Lockable::UniqueLock;
+    using EmbeddedSet = typename Base::EmbeddedSet;
+
+    static constexpr size_t num_submaps = size_t(1) << N;
+
+    // The image of one submap, shared by the snapshots taken since the last
+    // write to it. `image` is set by the first write, under the submap's
+    // unique lock; until then the snapshots read the live submap.
+    struct SubmapImage
+    {
+        std::shared_ptr<const EmbeddedSet> image;
+    };
+
+    // protected by the submap's lock. Aligned so that submaps don't share a line.
+    struct alignas(PHMAP_CACHELINE_SIZE) SubmapState
+    {
+        std::shared_ptr<SubmapImage> pending;
+    };
+
+public:
+    using key_type    = K;
+    using mapped_type = V;
+    using value_type  = typename Base::value_type;
+    using hasher      = Hash;
+    using key_equal   = Eq;
+
+    template <class KK>
+    using key_arg = typename Base::template key_arg<KK>;
+
+    // -------------------------------------------------------------------------
+    // A point-in-time view of the map, see snapshot().
+    // -------------------------------------------------------------------------
+    class snapshot_type
+    {
+    public:
+        size_t size() const {
+            size_t res = 0;
+            for (size_t i = 0; i < num_submaps; ++i)
+                with_submap(i, [&](const EmbeddedSet& set) { res += set.size(); });
+            return res;
+        }
+
+        bool empty() const { return size() == 0; }
+
+        // Calls `f` with each value_type of the snapshot.
+        template <class F>
+        void for_each(F&& f) const {
+            for (size_t i = 0; i < num_submaps; ++i)
+                with_submap(i, [&](const EmbeddedSet& set) {
+                    for (const auto& v : set)
+                        f(v);
+                });
+        }
+
+        template <class KK = key_type>
+        bool contains(const key_arg<KK>& key) const {
+            return if_contains(key, [](const value_type&) {});
+        }
+
+        // If `key` was present, calls `f` with its value_type and returns true.
+        template <class KK = key_type, class F>
+        bool if_contains(const key_arg<KK>& key, F&& f) const {
+            size_t hashval = map_->hash(key);
+            bool found = false;
+            with_submap(map_->subidx(hashval), [&](const EmbeddedSet& set) {
+                auto it = set.find(key, hashval);
+                if (it != set.end()) {
+                    found = true;
+                    f(*it);
+                }
+            });
+            return found;
+        }
+
+        // Writes the snapshot in the format of parallel_flat_hash_map::phmap_dump(),
+        // so that a parallel_flat_hash_map with the same N can phmap_load() it.
+        // Requires "phmap_dump.h".
+        template <class OutputArchive>
+        bool phmap_dump(OutputArchive& ar) const {
+            size_t submap_count = num_submaps;
+            ar.saveBinary(&submap_count, sizeof(size_t));
+            bool ok = true;
+            for (size_t i = 0; i < num_submaps && ok; ++i)
+                with_submap(i, [&](const EmbeddedSet& set) { ok = set.phmap_dump(ar); });
+            return ok;
+        }
+
+    private:
+        friend class parallel_snapshot_flat_hash_map;
+
+        explicit snapshot_type(const parallel_snapshot_flat_hash_map* m) : map_(m) {}
+
+        // calls `f` with the image of submap `i`: the copy made by a writer,
+        // or the live submap (under its shared lock) when it has not changed.
+        template <class F>
+        void with_submap(size_t i, F&& f) const {
+            Inner& inner = const_cast<Inner&>(map_->sets_[i]);
+            SharedLock m(inner);
+            std::shared_ptr<const EmbeddedSet> image = images_[i]->image;
+            if (!image) {
+                f(inner.set_);
+                return;
+            }
+            m.unlock();
+            f(*image);
+        }
+
+        const parallel_snapshot_flat_hash_map*               map_;
+        std::array<std::shared_ptr<SubmapImage>, num_submaps> images_;
+    };
+
+    parallel_snapshot_flat_hash_map() {}
+    parallel_snapshot_flat_hash_map(const parallel_snapshot_flat_hash_map&) = delete;
+    parallel_snapshot_flat_hash_map& operator=(const parallel_snapshot_flat_hash_map&) = delete;
+
+    using Base::size;
+    using Base::empty;
+    using Base::subcnt;
+    using Base::hash;
+    using Base::for_each;
+    using Base::contains;
+    using Base::count;
+    using Base::if_contains;
+
+    // Returns a view of the map as it is now. Blocks the writers only while
+    // marking the submaps.
+    // -----------------------------------------------------------------
+    snapshot_type snapshot() const {
+        snapshot_type res(this);
+        std::vector<UniqueLock> locks;
+        locks.reserve(num_submaps);
+        for (size_t i = 0; i < num_submaps; ++i)
+            locks.emplace_back(const_cast<Inner&>(this->sets_[i]));
+        for (size_t i = 0; i < num_submaps; ++i) {
+            auto& pending = state_[i].pending;
+            if (!pending)
+                pending = std::make_shared<SubmapImage>();
+            res.images_[i] = pending;
+        }
+        return res;
+    }
+
+    // Inserts `key` with a value constructed from `args` if `key` is not
+    // present. Returns true if inserted.
+    // -----------------------------------------------------------------
+    template <class... Args>
+    bool try_emplace(const K& key, Args&&... args) {
+        size_t hashval = this->hash(key);
+        size_t idx     = this->subidx(hashval);
+        Inner& inner   = this->sets_[idx];
+        UniqueLock m(inner);
+        if (inner.set_.contains(key, hashval))
+            return false;
+        before_write(idx);
+        inner.set_.emplace_with_hash(hashval, std::piecewise_construct,
+                                     std::forward_as_tuple(key),
+                                     std::forward_as_tuple(std::forward<Args>(args)...));
+        return true;
+    }
+
+    bool insert(const value_type& v) { return try_emplace(v.first, v.second); }
+
+    // Inserts or updates `key`. Returns true if the key was inserted.
+    // -----------------------------------------------------------------
+    template <class VV>
+    bool insert_or_assign(const K& key, VV&& value) {
+        size_t hashval = this->hash(key);
+        size_t idx     = this->subidx(hashval);
+        Inner& inner   = this->sets_[idx];
+        UniqueLock m(inner);
+        before_write(idx);
+        auto p = inner.set_.find_ptr(key, hashval);
+        if (p) {
+            p->second = std::forward<VV>(value);
+            return false;
+        }
+        inner.set_.emplace_with_hash(hashval, std::piecewise_construct,
+                                     std::forward_as_tuple(key),
+                                     std::forward_as_tuple(std::forward<VV>(value)));
+        return true;
+    }
+
+    // If `key` is present, calls `f` with its value_type (which it may
+    // modify) under the submap's unique lock and returns true.
+    // -----------------------------------------------------------------
+    template <class F>
+    bool modify_if(const K& key, F&& f) {
+        size_t hashval = this->hash(key);
+        size_t idx     = this->subidx(hashval);
+        Inner& inner   = this->sets_[idx];
+        UniqueLock m(inner);
+        if (!inner.set_.contains(key, hashval))
+            return false;
+        before_write(idx);
+        std::forward<F>(f)(*inner.set_.find(key, hashval));
+        return true;
+    }
+
+    // Removes `key`. Returns the number of entries removed (0 or 1).
+    // -----------------------------------------------------------------
+    size_t erase(const K& key) {
+        size_t hashval = this->hash(key);
+        size_t idx     = this->subidx(hashval);
+        Inner& inner   = this->sets_[idx];
+        UniqueLock m(inner);
+        if (!inner.set_.contains(key, hashval))
+            return 0;
+        before_write(idx);
+        inner.set_._erase(inner.set_.find(key, hashval));
+        return 1;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < num_submaps; ++i) {
+            Inner& inner = this->sets_[i];
+            UniqueLock m(inner);
+            if (inner.set_.empty())
+                continue;
+            before_write(i);
+            inner.set_.clear();
+        }
+    }
+
+    // doesn't change the contents, so the snapshots are not affected
+    void reserve(size_t n) { Base::reserve(n); }
+
+private:
+    // PRECONDITION: unique lock held on submap `idx`, which is about to be
+    // modified. Copies it for the live snapshots which still read it in place.
+    void before_write(size_t idx) {
+        auto& pending = state_[idx].pending;
+        if (!pending)
+            return;
+        // the count only grows in snapshot(), under this lock, so 1 means
+        // that no snapshot can read this submap anymore.
+        if (pending.use_count() > 1)
+            pending->image = std::make_shared<const EmbeddedSet>(this->sets_[idx].set_);
+        pending.reset();
+    }
+
+    mutable std::array<SubmapState, num_submaps> state_;
+};
+
+}  // namespace phmap
+
+#endif // phmap_snapshot_h_guard_
@@ -0,0 +1,583 @@
+#if !defined(phmap_string_h_guard_)
+#define phmap_string_h_guard_
+
+// ---------------------------------------------------------------------------
+// Copyright (c) 2019, Gregory Popovitch - greg7mdp@gmail.com
+//
+//       providing string_interner and flat_string_map
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "phmap.h"
+
+#if !PHMAP_HAVE_STD_STRING_VIEW
+    #error "phmap_string.h requires std::string_view (C++17)"
+#endif
+
+namespace phmap {
+
+namespace priv {
+
+// ---------------------------------------------------------------------------
+// Storage for the chars of the keys of a string_interner or flat_string_map.
+// Keys are copied back to back, each followed by a '\0', in chunks of 64KB
+// (or of the length of the key if larger) which are never reallocated, so the
+// views of the stored keys stay valid until reset(), and no two of them
+// start at the same address. Nothing is given back when a key is erased.
+// ---------------------------------------------------------------------------
+class string_arena
+{
+    enum : size_t { kChunkSize = 64 * 1024 };
+
+public:
+    string_arena() {}
+
+    string_arena(string_arena&& o) noexcept
+        : chunks_(std::move(o.chunks_)), cur_(o.cur_), end_(o.end_), used_(o.used_), reserved_(o.reserved_) {
+        o.chunks_.clear();
+        o.cur_ = o.end_ = nullptr;
+        o.used_ = o.reserved_ = 0;
+    }
+
+    string_arena(const string_arena&) = delete;
+    string_arena& operator=(const string_arena&) = delete;
+
+    // Makes sure that the next store() of up to n chars will not allocate.
+    void prepare(size_t n) {
+        if (n >= static_cast<size_t>(end_ - cur_))
+            add_chunk(n + 1);
+    }
+
+    // PRECONDITION: prepare(s.size()) was called since the last store(). Doesn't throw.
+    std::string_view store(std::string_view s) noexcept {
+        assert(s.size() < static_cast<size_t>(end_ - cur_));
+        char* p = cur_;
+        if (!s.empty())
+            std::memcpy(p, s.data(), s.size());
+        p[s.size()] = 0;
+        cur_ += s.size() + 1;
+        used_ += s.size() + 1;
+        return std::string_view(p, s.size());
+    }
+
+    // Forgets all the stored chars. Keeps the first chunk.
+    void reset() {
+        if (chunks_.size() > 1) {
+            reserved_ = chunks_[0].second;
+            chunks_.resize(1);
+        }
+        cur_  = chunks_.empty() ? nullptr : chunks_[0].first.get();
+        end_  = chunks_.empty() ? nullptr : cur_ + chunks_[0].second;
+        used_ = 0;
+    }
+
+    void swap(string_arena& o) noexcept {
+        chunks_.swap(o.chunks_);
+        std::swap(cur_, o.cur_);
+        std::swap(end_, o.end_);
+        std::swap(used_, o.used_);
+        std::swap(reserved_, o.reserved_);
+    }
+
+    size_t bytes_used() const     { return used_; }      // stored since the last reset(), with the '\0's
+    size_t bytes_reserved() const { return reserved_; }  // size of the chunks
+
+private:
+    void add_chunk(size_t n) {
+        size_t sz = (std::max)(static_cast<size_t>(kChunkSize), n);
+        chunks_.emplace_back(std::unique_ptr<char[]>(new char[sz]), sz);
+        cur_ = chunks_.back().first.get();
+        end_ = cur_ + sz;
+        reserved_ += sz;
+    }
+
+    std::vector<std::pair<std::unique_ptr<char[]>, size_t>> chunks_;
+    char*  cur_      = nullptr;
+    char*  end_      = nullptr;
+    size_t used_     = 0;
+    size_t reserved_ = 0;
+};
+
+// ---------------------------------------------------------------------------
+// A key being looked up: the view, with the 32 hash bits and the 8 byte
+// prefix which the slots store.
+// ---------------------------------------------------------------------------
+struct string_probe
+{
+    std::string_view key;
+    uint64_t         prefix;
+    uint32_t         hash;
+};
+
+// the first 8 chars of s, zero padded
+inline uint64_t string_prefix(std::string_view s) {
+    uint64_t p = 0;
+    if (!s.empty())
+        std::memcpy(&p, s.data(), (std::min)(s.size(), sizeof(p)));
+    return p;
+}
+
+template <class Hash>
+string_probe make_string_probe(std::string_view s, const Hash& hash) {
+    return string_probe{s, string_prefix(s),
+                        static_cast<uint32_t>(phmap::phmap_mix<sizeof(size_t)>()(hash(s)))};
+}
+
+// The hash and prefix reject almost all the other keys without reading the
+// chars in the arena, and keys of up to 8 chars are compared entirely by
+// their prefix and length.
+template <class Slot>
+bool string_slot_matches(const Slot& s, const string_probe& p) {
+    std::string_view k = s.key();
+    return s.hash == p.hash && s.prefix == p.prefix && k.size() == p.key.size() &&
+           (k.size() <= sizeof(uint64_t) ||
+            std::memcmp(k.data() + sizeof(uint64_t), p.key.data() + sizeof(uint64_t),
+                        k.size() - sizeof(uint64_t)) == 0);
+}
+
+template <class Slot>
+struct string_slot_hash
+{
+    using is_transparent = void;
+
+    size_t operator()(const Slot& s) const { return s.hash; }
+    size_t operator()(const string_probe& p) const { return p.hash; }
+};
+
+template <class Slot>
+struct string_slot_eq
+{
+    using is_transparent = void;
+
+    bool operator()(const Slot& a, const Slot& b) const { return a.key().data() == b.key().data(); }
+    bool operator()(const Slot& s, const string_probe& p) const { return string_slot_matches(s, p); }
+    bool operator()(const string_probe& p, const Slot& s) const { return string_slot_matches(s, p); }
+};
+
+}  // namespace priv
+
+// -----------------------------------------------------------------------------
+// phmap::string_interner
+// -----------------------------------------------------------------------------
+// A set of strings which stores one copy of each distinct string, and hands
+// out views of it which stay valid until clear() (or the destruction of the
+// interner). Two interned views are equal exactly when their data() pointers
+// are, so they can be compared and hashed as pointers. Each one is followed
+// by a '\0', so data() can also be passed where a C string is expected.
+//
+// The chars are copied back to back in large chunks instead of one allocation
+// per string, and the table slots hold a view of them, 32 bits of the hash
+// and the first 8 chars, so that a lookup seldom has to read the chunks.
+//
+//     phmap::string_interner words;
+//     std::string_view w = words.intern(line.substr(0, tab));
+// -----------------------------------------------------------------------------
+class string_interner
+{
+    struct slot
+    {
+        std::string_view key() const { return view; }
+
+        std::string_view view;
+        uint64_t         prefix;
+        uint32_t         hash;
+    };
+
+    using Index = phmap::flat_hash_set<slot, priv::string_slot_hash<slot>, priv::string_slot_eq<slot>>;
+
+    class iter
+    {
+        friend class string_interner;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = std::string_view;
+        using reference         = const std::string_view&;
+        using pointer           = const std::string_view*;
+        using difference_type   = ptrdiff_t;
+
+        iter() {}
+
+        reference operator*()  const { return inner_->view; }
+        pointer   operator->() const { return &inner_->view; }
+
+        iter& operator++() { ++inner_; return *this; }
+        iter  operator++(int) { iter tmp = *this; ++inner_; return tmp; }
+
+        friend bool operator==(const iter& a, const iter& b) { return a.inner_ == b.inner_; }
+        friend bool operator!=(const iter& a, const iter& b) { return a.inner_ != b.inner_; }
+
+    private:
+        explicit iter(typename Index::const_iterator inner) : inner_(inner) {}
+
+        typename Index::const_iterator inner_;
+    };
+
+public:
+    using value_type     = std::string_view;
+    using size_type      = size_t;
+    using hasher         = phmap::priv::hash_default_hash<std::string_view>;
+    using iterator       = iter;
+    using const_iterator = iter;
+
+    string_interner() {}
+
+    explicit string_interner(size_t bucket_cnt, const hasher& hash = hasher())
+        : index_(bucket_cnt), hash_(hash) {}
+
+    string_interner(string_interner&& o) noexcept
+        : index_(std::move(o.index_)), arena_(std::move(o.arena_)), hash_(o.hash_) {}
+
+    string_interner& operator=(string_interner&& o) noexcept {
+        swap(o);
+        return *this;
+    }
+
+    string_interner(const string_interner&) = delete;
+    string_interner& operator=(const string_interner&) = delete;
+
+    // ---------------------------------------------------------------------
+    const_iterator begin() const { return const_iterator(index_.begin()); }
+    const_iterator end()   const { return const_iterator(index_.end()); }
+
+    size_t size()  const { return index_.size(); }
+    bool   empty() const { return index_.empty(); }
+
+    size_t bucket_count() const { return index_.bucket_count(); }
+    float  load_factor()  const { return index_.load_factor(); }
+
+    // chars stored in the arena, and memory obtained for them
+    size_t key_bytes()          const { return arena_.bytes_used(); }
+    size_t key_bytes_reserved() const { return arena_.bytes_reserved(); }
+
+    // invalidates all the interned views
+    void clear() {
+        index_.clear();
+        arena_.reset();
+    }
+
+    void reserve(size_t n) { index_.reserve(n); }
+
+    void swap(string_interner& o) noexcept {
+        index_.swap(o.index_);
+        arena_.swap(o.arena_);
+        std::swap(hash_, o.hash_);
+    }
+
+    hasher hash_function() const { return hash_; }
+
+    // ---------------------------------------------------------------------
+    // Returns the stored copy of s, after storing it if it wasn't there.
+    // ---------------------------------------------------------------------
+    std::string_view intern(std::string_view s) {
+        return intern_impl(s).first;
+    }
+
+    // Also returns whether s was stored by this call.
+    std::pair<std::string_view, bool> insert(std::string_view s) {
+        return intern_impl(s);
+    }
+
+    // Returns the stored copy of s, or a view with a null data() if there
+    // is none.
+    std::string_view find(std::string_view s) const {
+        priv::string_probe probe = priv::make_string_probe(s, hash_);
+        auto it = index_.find(probe, index_.hash(probe));
+        return it == index_.end() ? std::string_view() : it->view;
+    }
+
+    bool   contains(std::string_view s) const { return find(s).data() != nullptr; }
+    size_t count(std::string_view s)    const { return contains(s) ? 1 : 0; }
+
+private:
+    std::pair<std::string_view, bool> intern_impl(std::string_view s) {
+        priv::string_probe probe = priv::make_string_probe(s, hash_);
+        arena_.prepare(s.size());
+        bool inserted = false;
+        auto it = index_.lazy_emplace_with_hash(probe, index_.hash(probe),
+            [&](const Index::constructor& ctor) {
+                ctor(slot{arena_.store(s), probe.prefix, probe.hash});
+                inserted = true;
+            });
+        return {it->view, inserted};
+    }
+
+    Index              index_;
+    priv::string_arena arena_;
+    hasher             hash_;
+};
+
+// -----------------------------------------------------------------------------
+// phmap::flat_string_map
+// -----------------------------------------------------------------------------
+// A flat hash map from strings to V, for maps with many string keys: the
+// chars of the keys are copied back to back in large chunks which the map
+// owns, as in string_interner, rather than in one std::string each.
+//
+// - no allocation per key, whatever its length, and no key destructor to
+//   run on clear(),
+// - the slots hold 32 bits of the hash and the first 8 chars of the key, so
+//   that a lookup almost never reads the chars of another key, and compares
+//   keys of up to 8 chars without reading the chunks at all,
+// - growing the table moves the slots without hashing the keys again,
+// - all the lookups take a std::string_view (std::string and const char*
+//   convert to it), without building a std::string.
+//
+// The elements are std::pair<const std::string_view, V>. The chars of the
+// keys stay where they are until clear(), so the views remain valid when the
+// table grows, but the pairs move as in flat_hash_map. The chars of erased
+// keys are only reclaimed by clear().
+// -----------------------------------------------------------------------------
+template <class V, class Hash = phmap::priv::hash_default_hash<std::string_view>>
+class flat_string_map
+{
+public:
+    using key_type    = std::string_view;
+    using mapped_type = V;
+    using value_type  = std::pair<const std::string_view, V>;
+    using size_type   = size_t;
+    using hasher      = Hash;
+    using reference       = value_type&;
+    using const_reference = const value_type&;
+
+private:
+    struct slot
+    {
+        template <class... Args>
+        slot(std::string_view k, uint64_t p, uint32_t h, Args&&... args)
+            : kv(std::piecewise_construct, std::forward_as_tuple(k),
+                 std::forward_as_tuple(std::forward<Args>(args)...)),
+              prefix(p), hash(h) {}
+
+        std::string_view key() const { return kv.first; }
+
+        value_type kv;
+        uint64_t   prefix;
+        uint32_t   hash;
+    };
+
+    using Index = phmap::flat_hash_set<slot, priv::string_slot_hash<slot>, priv::string_slot_eq<slot>>;
+
+    template <class Ref>
+    class iter
+    {
+        friend class flat_string_map;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = typename flat_string_map::value_type;
+        using reference         = Ref&;
+        using pointer           = Ref*;
+        using difference_type   = ptrdiff_t;
+
+        iter() {}
+        template <class R, typename std::enable_if<std::is_convertible<R*, Ref*>::value, int>::type = 0>
+        iter(const iter<R>& o) : inner_(o.inner_) {}
+
+        // the set only hands out const slots, but the mapped values are not
+        // part of what it hashes and compares
+        reference operator*()  const { return const_cast<value_type&>(inner_->kv); }
+        pointer   operator->() const { return &**this; }
+
+        iter& operator++() { ++inner_; return *this; }
+        iter  operator++(int) { iter tmp = *this; ++inner_; return tmp; }
+
+        friend bool operator==(const iter& a, const iter& b) { return a.inner_ == b.inner_; }
+        friend bool operator!=(const iter& a, const iter& b) { return a.inner_ != b.inner_; }
+
+    private:
+        template <class R> friend class iter;
+
+        explicit iter(typename Index::const_iterator inner) : inner_(inner) {}
+
+        typename Index::const_iterator inner_;
+    };
+
+public:
+    using iterator       = iter<value_type>;
+    using const_iterator = iter<const value_type>;
+
+    flat_string_map() {}
+
+    explicit flat_string_map(size_t bucket_cnt, const hasher& hash = hasher())
+        : index_(bucket_cnt), hash_(hash) {}
+
+    flat_string_map(std::initializer_list<std::pair<std::string_view, V>> init)
+        : flat_string_map(init.size()) {
+        for (const auto& v : init)
+            try_emplace(v.first, v.second);
+    }
+
+    // the keys are copied in the arena of the new map, the stored hash bits
+    // are reused
+    flat_string_map(const flat_string_map& o) : flat_string_map(o.size(), o.hash_) {
+        for (const slot& s : o.index_) {
+            arena_.prepare(s.key().size());
+            index_.emplace(arena_.store(s.key()), s.prefix, s.hash, s.kv.second);
+        }
+    }
+
+    flat_string_map(flat_string_map&& o) noexcept
+        : index_(std::move(o.index_)), arena_(std::move(o.arena_)), hash_(o.hash_) {}
+
+    flat_string_map& operator=(flat_string_map o) {
+        swap(o);
+        return *this;
+    }
+
+    // ---------------------------------------------------------------------
+    iterator       begin()        { return iterator(index_.begin()); }
+    const_iterator begin()  const { return const_iterator(index_.begin()); }
+    const_iterator cbegin() const { return begin(); }
+    iterator       end()          { return iterator(index_.end()); }
+    const_iterator end()    const { return const_iterator(index_.end()); }
+    const_iterator cend()   const { return end(); }
+
+    size_t size()  const { return index_.size(); }
+    bool   empty() const { return index_.empty(); }
+
+    size_t bucket_count() const { return index_.bucket_count(); }
+    float  load_factor()  const { return index_.load_factor(); }
+
+    // chars stored in the arena, and memory obtained for them
+    size_t key_bytes()          const { return arena_.bytes_used(); }
+    size_t key_bytes_reserved() const { return arena_.bytes_reserved(); }
+
+    void clear() {
+        index_.clear();
+        arena_.reset();
+    }
+
+    void reserve(size_t n) { index_.reserve(n); }
+    void rehash(size_t n)  { index_.rehash(n); }
+
+    void swap(flat_string_map& o) noexcept {
+        index_.swap(o.index_);
+        arena_.swap(o.arena_);
+        std::swap(hash_, o.hash_);
+    }
+
+    hasher hash_function() const { return hash_; }
+
+    // ---------------------------------------------------------------------
+    // The key is copied in the arena only when it is inserted.
+    // ---------------------------------------------------------------------
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(std::string_view key, Args&&... args) {
+        priv::string_probe probe = priv::make_string_probe(key, hash_);
+        arena_.prepare(key.size());
+        bool inserted = false;
+        auto it = index_.lazy_emplace_with_hash(probe, index_.hash(probe),
+            [&](const typename Index::constructor& ctor) {
+                ctor(arena_.store(key), probe.prefix, probe.hash, std::forward<Args>(args)...);
+                inserted = true;
+            });
+        return {iterator(it), inserted};
+    }
+
+    template <class... Args>
+    std::pair<iterator, bool> emplace(std::string_view key, Args&&... args) {
+        return try_emplace(key, std::forward<Args>(args)...);
+    }
+
+    std::pair<iterator, bool> insert(const std::pair<std::string_view, V>& v) {
+        return try_emplace(v.first, v.second);
+    }
+
+    template <class VV>
+    std::pair<iterator, bool> insert_or_assign(std::string_view key, VV&& v) {
+        auto res = try_emplace(key, std::forward<VV>(v));
+        if (!res.second)
+            res.first->second = std::forward<VV>(v);
+        return res;
+    }
+
+    V& operator[](std::string_view key) { return try_emplace(key).first->second; }
+
+    // ---------------------------------------------------------------------
+    iterator find(std::string_view key) {
+        priv::string_probe probe = priv::make_string_probe(key, hash_);
+        return iterator(index_.find(probe, index_.hash(probe)));
+    }
+
+    const_iterator find(std::string_view key) const {
+        return const_cast<flat_string_map*>(this)->find(key);
+    }
+
+    bool   contains(std::string_view key) const { return find(key) != end(); }
+    size_t count(std::string_view key)    const { return contains(key) ? 1 : 0; }
+
+    V& at(std::string_view key) {
+        auto it = find(key);
+        if (it == end())
+            phmap::base_internal::ThrowStdOutOfRange("phmap at(): lookup non-existent key");
+        return it->second;
+    }
+
+    const V& at(std::string_view key) const { return const_cast<flat_string_map*>(this)->at(key); }
+
+    // ---------------------------------------------------------------------
+    size_t erase(std::string_view key) {
+        auto it = find(key);
+        if (it == end())
+            return 0;
+        erase(it);
+        return 1;
+    }
+
+    // Returns an iterator to the next element.
+    iterator erase(const_iterator pos) {
+        iterator next(pos.inner_);
+        ++next;
+        index_._erase(pos.inner_);
+        return next;
+    }
+
+    iterator erase(iterator pos) { return erase(const_iterator(pos)); }
+
+    friend bool operator==(const flat_string_map& a, const flat_string_map& b) {
+        if (a.size() != b.size())
+            return false;
+        for (const value_type& v : a) {
+            auto it = b.find(v.first);
+            if (it == b.end() || !(it->second == v.second))
+                return false;
+        }
+        return true;
+    }
+
+    friend bool operator!=(const flat_string_map& a, const flat_string_map& b) { return !(a == b); }
+
+    friend void swap(flat_string_map& a, flat_string_map& b) noexcept { a.swap(b); }
+
+private:
+    Index              index_;
+    priv::string_arena arena_;
+    hasher             hash_;
+};
+
+}  // namespace phmap
+
+#endif // phmap_string_h_guard_
@@ -31,6 +31,7 @@
 #include <cstdint>
 #include <functional>
 #include <tuple>
+#include <type_traits>
 #include "phmap_bits.h"
 
 // ---------------------------------------------------------------
@@ -67,9 +68,10 @@ struct phmap_mix<4>
     struct phmap_mix<8>
     {
         // Very fast mixing (similar to Abseil)
+        static constexpr uint64_t k = 0xde5fb9d2630458e9ULL;
+
         inline size_t operator()(size_t a) const
         {
-            static constexpr uint64_t k = 0xde5fb9d2630458e9ULL;
             uint64_t h;
             uint64_t l = umul128(a, k, &h);
             return static_cast<size_t>(h + l);
@@ -118,6 +120,136 @@ struct fold_if_needed<8>
     }
 };
 
+#if defined(PHMAP_HAS_UMUL128)
+// ---------------------------------------------------------------
+// phmap_mix_many: out[i] = phmap_mix<8>()(size_t(in[i]) ^ seed), for
+// 32 and 64 bit integers. With AVX-512F or AVX2, eight or four values
+// are mixed at a time: there is no 64x64->128 bit vector multiply, so it
+// is done on 32 bit halves with mul_epu32.
+// ---------------------------------------------------------------
+#define PHMAP_HAVE_MIX_MANY 1
+
+#if PHMAP_HAVE_AVX512F && defined(__GNUC__) && !defined(__clang__)
+    // gcc 12 warns about the _mm512_undefined_epi32() used by the intrinsics
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+namespace mix_many_internal {
+
+#if PHMAP_HAVE_AVX2
+    inline __m256i load4(const uint64_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    inline __m256i load4(const int64_t* p)  { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    inline __m256i load4(const uint32_t* p) { return _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))); }
+    inline __m256i load4(const int32_t* p)  { return _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))); }
+
+    inline __m256i mix4(__m256i a)
+    {
+        const __m256i k0  = _mm256_set1_epi64x(static_cast<long long>(phmap_mix<8>::k & 0xffffffff));
+        const __m256i k1  = _mm256_set1_epi64x(static_cast<long long>(phmap_mix<8>::k >> 32));
+        const __m256i m32 = _mm256_set1_epi64x(0xffffffff);
+        __m256i a1  = _mm256_srli_epi64(a, 32);
+        __m256i p00 = _mm256_mul_epu32(a, k0);
+        __m256i p01 = _mm256_mul_epu32(a, k1);
+        __m256i p10 = _mm256_mul_epu32(a1, k0);
+        __m256i p11 = _mm256_mul_epu32(a1, k1);
+        __m256i mid = _mm256_add_epi64(_mm256_add_epi64(_mm256_srli_epi64(p00, 32), _mm256_and_si256(p10, m32)),
+                                       _mm256_and_si256(p01, m32));
+        __m256i lo  = _mm256_or_si256(_mm256_and_si256(p00, m32), _mm256_slli_epi64(mid, 32));
+        __m256i hi  = _mm256_add_epi64(_mm256_add_epi64(p11, _mm256_srli_epi64(p10, 32)),
+                                       _mm256_add_epi64(_mm256_srli_epi64(p01, 32), _mm256_srli_epi64(mid, 32)));
+        return _mm256_add_epi64(hi, lo);
+    }
+#endif
+
+#if PHMAP_HAVE_AVX512F
+    inline __m512i load8(const uint64_t* p) { return _mm512_loadu_si512(p); }
+    inline __m512i load8(const int64_t* p)  { return _mm512_loadu_si512(p); }
+    inline __m512i load8(const uint32_t* p) { return _mm512_cvtepu32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))); }
+    inline __m512i load8(const int32_t* p)  { return _mm512_cvtepi32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))); }
+
+    inline __m512i mix8(__m512i a)
+    {
+        const __m512i k0  = _mm512_set1_epi64(static_cast<long long>(phmap_mix<8>::k & 0xffffffff));
+        const __m512i k1  = _mm512_set1_epi64(static_cast<long long>(phmap_mix<8>::k >> 32));
+        const __m512i m32 = _mm512_set1_epi64(0xffffffff);
+        __m512i a1  = _mm512_srli_epi64(a, 32);
+        __m512i p00 = _mm512_mul_epu32(a, k0);
+        __m512i p01 = _mm512_mul_epu32(a, k1);
+        __m512i p10 = _mm512_mul_epu32(a1, k0);
+        __m512i p11 = _mm512_mul_epu32(a1, k1);
+        __m512i mid = _mm512_add_epi64(_mm512_add_epi64(_mm512_srli_epi64(p00, 32), _mm512_and_si512(p10, m32)),
+                                       _mm512_and_si512(p01, m32));
+        __m512i lo  = _mm512_or_si512(_mm512_and_si512(p00, m32), _mm512_slli_epi64(mid, 32));
+        __m512i hi  = _mm512_add_epi64(_mm512_add_epi64(p11, _mm512_srli_epi64(p10, 32)),
+                                       _mm512_add_epi64(_mm512_srli_epi64(p01, 32), _mm512_srli_epi64(mid, 32)));
+        return _mm512_add_epi64(hi, lo);
+    }
+#endif
+
+}  // namespace mix_many_internal
+
+template <class K>
+inline void phmap_mix_many(const K* in, size_t n, size_t seed, size_t* out)
+{
+    static_assert(std::is_integral<K>::value && (sizeof(K) == 4 || sizeof(K) == 8),
+                  "phmap_mix_many() mixes 32 or 64 bit integers");
+    size_t i = 0;
+#if PHMAP_HAVE_AVX512F
+    const __m512i s8 = _mm512_set1_epi64(static_cast<long long>(seed));
+    for (; i + 8 <= n; i += 8) {
+        __m512i a = _mm512_xor_si512(mix_many_internal::load8(in + i), s8);
+        _mm512_storeu_si512(out + i, mix_many_internal::mix8(a));
+    }
+#endif
+#if PHMAP_HAVE_AVX2
+    const __m256i s4 = _mm256_set1_epi64x(static_cast<long long>(seed));
+    for (; i + 4 <= n; i += 4) {
+        __m256i a = _mm256_xor_si256(mix_many_internal::load4(in + i), s4);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), mix_many_internal::mix4(a));
+    }
+#endif
+    for (; i < n; ++i)
+        out[i] = phmap_mix<8>()(static_cast<size_t>(in[i]) ^ seed);
+}
+
+#if PHMAP_HAVE_AVX512F && defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic pop
+#endif
+#endif
+
+// ---------------------------------------------------------------
+// hw_mix64: mixes all the bits of a 64 bit value with two AES rounds
+// (AES-NI), or with the crc32 instruction (SSE4.2), or else with the
+// MurmurHash3 finalizer. Used by phmap::HwHash, and when PHMAP_USE_HW_HASH
+// is defined, by phmap::Hash for the 32 and 64 bit integers and by
+// HashState::combine.
+// ---------------------------------------------------------------
+inline uint64_t hw_mix64(uint64_t v)
+{
+#if PHMAP_HAVE_AESNI
+    const __m128i k0 = _mm_set_epi64x(0x243f6a8885a308d3LL, 0x13198a2e03707344LL);
+    const __m128i k1 = _mm_set_epi64x(0x0a4093822299f31dLL, 0x082efa98ec4e6c89LL);
+    __m128i x = _mm_cvtsi64_si128(static_cast<long long>(v));
+    x = _mm_aesenc_si128(x, k0);
+    x = _mm_aesenc_si128(x, k1);
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(x));
+#elif PHMAP_HAVE_SSE42
+    // crc32 is linear, so the two halves are computed from v and from a
+    // product of v
+    uint64_t lo = _mm_crc32_u64(0, v);
+    uint64_t hi = _mm_crc32_u64(0xffffffff, v * 0x9e3779b97f4a7c15ULL);
+    return (hi << 32) | lo;
+#else
+    v ^= v >> 33;
+    v *= 0xff51afd7ed558ccdULL;
+    v ^= v >> 33;
+    v *= 0xc4ceb9fe1a85ec53ULL;
+    v ^= v >> 33;
+    return v;
+#endif
+}
+
 // ---------------------------------------------------------------
 // see if class T has a hash_value() friend method
 // ---------------------------------------------------------------
@@ -225,28 +357,52 @@ template <>
 struct Hash<int32_t> : public phmap_unary_function<int32_t, size_t>
 {
     inline size_t operator()(int32_t val) const noexcept
-    { return static_cast<size_t>(val); }
+    {
+#ifdef PHMAP_USE_HW_HASH
+        return fold_if_needed<sizeof(size_t)>()(hw_mix64(static_cast<uint64_t>(val)));
+#else
+        return static_cast<size_t>(val);
+#endif
+    }
 };
 
 template <>
 struct Hash<uint32_t> : public phmap_unary_function<uint32_t, size_t>
 {
     inline size_t operator()(uint32_t val) const noexcept
-    { return static_cast<size_t>(val); }
+    {
+#ifdef PHMAP_USE_HW_HASH
+        return fold_if_needed<sizeof(size_t)>()(hw_mix64(static_cast<uint64_t>(val)));
+#else
+        return static_cast<size_t>(val);
+#endif
+    }
 };
 
 template <>
 struct Hash<int64_t> : public phmap_unary_function<int64_t, size_t>
 {
     inline size_t operator()(int64_t val) const noexcept
-    { return fold_if_needed<sizeof(size_t)>()(static_cast<uint64_t>(val)); }
+    {
+#ifdef PHMAP_USE_HW_HASH
+        return fold_if_needed<sizeof(size_t)>()(hw_mix64(static_cast<uint64_t>(val)));
+#else
+        return fold_if_needed<sizeof(size_t)>()(static_cast<uint64_t>(val));
+#endif
+    }
 };
 
 template <>
 struct Hash<uint64_t> : public phmap_unary_function<uint64_t, size_t>
 {
     inline size_t operator()(uint64_t val) const noexcept
-    { return fold_if_needed<sizeof(size_t)>()(val); }
+    {
+#ifdef PHMAP_USE_HW_HASH
+        return fold_if_needed<sizeof(size_t)>()(hw_mix64(val));
+#else
+        return fold_if_needed<sizeof(size_t)>()(val);
+#endif
+    }
 };
 
 template <>
@@ -275,6 +431,37 @@ struct Hash<double> : public phmap_unary_function<double, size_t>
 
 #endif
 
+// ---------------------------------------------------------------
+//               phmap::HwHash
+// ---------------------------------------------------------------
+// A hasher which passes the integers, enums and pointers through
+// hw_mix64(), for keys with a structure that the mixing done by the tables
+// spreads poorly (e.g. pointers, ids with a large power of two stride).
+// Other types are hashed with phmap::Hash.
+//
+//    phmap::flat_hash_map<Node*, int, phmap::HwHash<Node*>> m;
+// ---------------------------------------------------------------
+template <class T, class Enable = void>
+struct HwHash : public phmap::Hash<T> {};
+
+template <class T>
+struct HwHash<T, typename std::enable_if<std::is_integral<T>::value ||
+                                         std::is_enum<T>::value ||
+                                         std::is_pointer<T>::value>::type>
+{
+    inline size_t operator()(T val) const noexcept
+    {
+        return fold_if_needed<sizeof(size_t)>()(hw_mix64(to_u64(val)));
+    }
+
+private:
+    template <class U, typename std::enable_if<std::is_pointer<U>::value, int>::type = 0>
+    static uint64_t to_u64(U val) { return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(val)); }
+
+    template <class U, typename std::enable_if<!std::is_pointer<U>::value, int>::type = 0>
+    static uint64_t to_u64(U val) { return static_cast<uint64_t>(val); }
+};
+
 #if defined(_MSC_VER)
 #   define PHMAP_HASH_ROTL32(x, r) _rotl(x,r)
 #else
@@ -310,10 +497,37 @@ template <class H> struct Combiner<H, 4>
     }
 };
 
+// ---------------------------------------------------------------
+// Unless PHMAP_LEGACY_COMBINER is defined, the 64 bit combiner folds each
+// value into the state with a single 128 bit multiply (as in wyhash),
+// instead of the Murmur2 steps. Define PHMAP_LEGACY_COMBINER to get the
+// hash values of the previous versions for std::pair, std::tuple and
+// HashState, e.g. to load tables dumped by them.
+// ---------------------------------------------------------------
+#if defined(PHMAP_HAS_UMUL128) && !defined(PHMAP_LEGACY_COMBINER) && !defined(PHMAP_USE_HW_HASH)
+    #define PHMAP_WIDE_COMBINER 1
+
+    // high and low halves of (a ^ s0) * (b ^ s1), xored with a and b. The
+    // product is zero when a == s0 or b == s1: xoring the operands back in
+    // (wyhash's "condom" mode) keeps such values from wiping out the state.
+    inline uint64_t wide_mix(uint64_t a, uint64_t b)
+    {
+        uint64_t h;
+        uint64_t l = umul128(a ^ 0xa0761d6478bd642fULL, b ^ 0xe7037ed1a0b428dbULL, &h);
+        return h ^ l ^ a ^ b;
+    }
+#endif
+
 template <class H> struct Combiner<H, 8>
 {
     H operator()(H h, size_t k)
     {
+#if defined(PHMAP_USE_HW_HASH)
+        // the multiply makes the combination depend on the order of the values
+        return static_cast<H>(hw_mix64((static_cast<uint64_t>(h) * 0x9e3779b97f4a7c15ULL) ^ k));
+#elif defined(PHMAP_WIDE_COMBINER)
+        return static_cast<H>(wide_mix(h, k));
+#else
         // Copyright 2005-2014 Daniel James.
         // Distributed under the Boost Software License, Version 1.0. (See accompanying
         // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
@@ -332,6 +546,7 @@ template <class H> struct Combiner<H, 8>
         h += 0xe6546b64;
 
         return h;
+#endif
     }
 };
 
@@ -384,14 +599,35 @@ private:
     typename std::enable_if<I == std::tuple_size<TUP>::value, size_t>::type
     _hash_helper(size_t seed, const TUP &) const noexcept { return seed; }
 
+    template<size_t I, class TUP>
+    static size_t _hash_element(const TUP &t) noexcept {
+        using el_type = typename std::decay<typename std::tuple_element<I, TUP>::type>::type;
+        return phmap::Hash<el_type>()(std::get<I>(t));
+    }
+
+#ifdef PHMAP_WIDE_COMBINER
+    // folds two elements per multiply. Their hashes don't depend on the
+    // state, so the only dependency chain is through the multiplies.
+    template<size_t I = 0, class TUP>
+    typename std::enable_if<I + 1 < std::tuple_size<TUP>::value, size_t>::type
+    _hash_helper(size_t seed, const TUP &t) const noexcept {
+        seed = static_cast<size_t>(wide_mix(seed ^ _hash_element<I>(t), _hash_element<I + 1>(t)));
+        return _hash_helper<I + 2>(seed, t);
+    }
+
+    template<size_t I = 0, class TUP>
+    typename std::enable_if<I + 1 == std::tuple_size<TUP>::value, size_t>::type
+    _hash_helper(size_t seed, const TUP &t) const noexcept {
+        return Combiner<size_t, sizeof(size_t)>()(seed, _hash_element<I>(t));
+    }
+#else
     template<size_t I = 0, class TUP>
     typename std::enable_if<I < std::tuple_size<TUP>::value, size_t>::type
     _hash_helper(size_t seed, const TUP &t) const noexcept {
-        const auto &el = std::get<I>(t);
-        using el_type = typename std::remove_cv<typename std::remove_reference<decltype(el)>::type>::type;
-        seed = Combiner<size_t, sizeof(size_t)>()(seed, phmap::Hash<el_type>()(el));
+        seed = Combiner<size_t, sizeof(size_t)>()(seed, _hash_element<I>(t));
         return _hash_helper<I + 1>(seed, t);
     }
+#endif
 };
 
 
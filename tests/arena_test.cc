@@ -0,0 +1,114 @@
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "parallel_hashmap/phmap.h"
+
+namespace phmap {
+namespace priv {
+namespace {
+
+TEST(Arena, AllocateAligned) {
+    phmap::arena a(256);
+    void* p1 = a.allocate(3, 1);
+    void* p2 = a.allocate(8, 64);
+    EXPECT_TRUE(p1 != nullptr);
+    EXPECT_TRUE(reinterpret_cast<uintptr_t>(p2) % 64 == 0);
+
+    // larger than the chunk size
+    void* p3 = a.allocate(10000, 16);
+    EXPECT_TRUE(reinterpret_cast<uintptr_t>(p3) % 16 == 0);
+    EXPECT_TRUE(a.bytes_used() == 3 + 8 + 10000);
+    EXPECT_TRUE(a.bytes_reserved() >= a.bytes_used());
+}
+
+TEST(Arena, AlignmentPastChunkEnd) {
+    // the end of the first chunk is 64 aligned for some of the arenas only
+    std::vector<std::unique_ptr<phmap::arena>> arenas;
+    for (int i = 0; i < 16; ++i) {
+        arenas.emplace_back(new phmap::arena(256));
+        phmap::arena& a = *arenas.back();
+        a.allocate(1, 1);
+        a.allocate(239, 1);   // fills the first chunk
+        EXPECT_TRUE(a.bytes_reserved() == 256);
+
+        // the alignment padding alone may go past the end of the chunk
+        char* p = static_cast<char*>(a.allocate(8, 64));
+        EXPECT_TRUE(reinterpret_cast<uintptr_t>(p) % 64 == 0);
+        EXPECT_TRUE(a.bytes_reserved() > 256);
+        memset(p, 0, 8);
+    }
+}
+
+TEST(Arena, ResetReusesMemory) {
+    phmap::arena a(256);
+    for (int i = 0; i < 100; ++i)
+        a.allocate(100);
+    size_t reserved = a.bytes_reserved();
+
+    a.reset();
+    EXPECT_TRUE(a.bytes_used() == 0);
+    EXPECT_TRUE(a.bytes_reserved() == reserved);
+
+    // coalesced into one chunk: same workload doesn't grow the arena
+    for (int i = 0; i < 100; ++i)
+        a.allocate(100);
+    EXPECT_TRUE(a.bytes_reserved() == reserved);
+
+    a.release();
+    EXPECT_TRUE(a.bytes_reserved() == 0);
+}
+
+TEST(Arena, FlatHashMap) {
+    phmap::arena a;
+    using Map = phmap::arena_flat_hash_map<uint32_t, uint32_t>;
+
+    for (int cycle = 0; cycle < 3; ++cycle) {
+        {
+            Map m(a);
+            for (uint32_t i = 0; i < 1000; ++i)
+                m[i] = i * 2;
+            EXPECT_TRUE(m.size() == 1000);
+            for (uint32_t i = 0; i < 1000; ++i)
+                EXPECT_TRUE(m[i] == i * 2);
+            EXPECT_TRUE(a.bytes_used() > 0);
+
+            // trivially destructible flat map: clear() just drops the storage
+            m.clear();
+            EXPECT_TRUE(m.empty());
+            EXPECT_TRUE(m.capacity() == 0);
+            EXPECT_TRUE(m.find(3) == m.end());
+
+            m[3] = 4;
+            EXPECT_TRUE(m.size() == 1 && m[3] == 4);
+        }
+        a.reset();
+    }
+}
+
+TEST(Arena, FlatHashSetString) {
+    phmap::arena a;
+    phmap::arena_flat_hash_set<std::string> s(a);
+    for (int i = 0; i < 100; ++i)
+        s.insert(std::to_string(i));
+    EXPECT_TRUE(s.size() == 100);
+
+    // not trivially destructible: clear() keeps the capacity
+    size_t cap = s.capacity();
+    s.clear();
+    EXPECT_TRUE(s.empty());
+    EXPECT_TRUE(s.capacity() == cap);
+
+    phmap::arena_flat_hash_set<std::string> s2(a);
+    s2.insert("a");
+    s.swap(s2);
+    EXPECT_TRUE(s.size() == 1 && s.count("a") == 1);
+}
+
+}
+}
+}
@@ -0,0 +1,42 @@
+#define THIS_HASH_MAP  cached_hash_flat_hash_map
+#define THIS_TEST_NAME CachedHashFlatHashMap
+
+#include "flat_hash_map_test.cc"
+
+namespace phmap {
+namespace priv {
+namespace {
+
+struct CountingHash {
+    size_t operator()(const std::string& s) const {
+        ++*count;
+        return std::hash<std::string>()(s);
+    }
+    size_t* count;
+};
+
+TEST(CachedHashFlatHashMap, NoRehashOnGrowth) {
+    size_t count = 0;
+    phmap::cached_hash_flat_hash_map<std::string, int, CountingHash> m(0, CountingHash{&count});
+    const int n = 1000;
+    for (int i = 0; i < n; ++i)
+        m.emplace(std::to_string(i), i);
+    // one hash per insertion, none when resizing
+    EXPECT_EQ(count, (size_t)n);
+
+    for (int i = 0; i < n; i += 2)
+        m.erase(std::to_string(i));
+    count = 0;
+    m.rehash(0);
+    EXPECT_EQ(count, 0u);
+
+    auto m2 = m;
+    EXPECT_EQ(count, 0u);
+    EXPECT_EQ(m2.size(), (size_t)n / 2);
+    for (int i = 0; i < n; ++i)
+        EXPECT_EQ(m2.count(std::to_string(i)), (size_t)(i & 1));
+}
+
+}  // namespace
+}  // namespace priv
+}  // namespace phmap
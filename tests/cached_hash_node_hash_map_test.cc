@@ -0,0 +1,4 @@
+#define THIS_HASH_MAP  cached_hash_node_hash_map
+#define THIS_TEST_NAME CachedHashNodeHashMap
+
+#include "node_hash_map_test.cc"
@@ -0,0 +1,97 @@
+#define PHMAP_CPU_DISPATCH 1
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "parallel_hashmap/phmap.h"
+
+namespace phmap {
+namespace priv {
+namespace {
+
+// the control bytes of a table of the given capacity (at least
+// Group::kWidth - 1), with a random mix of empty, deleted and full slots
+std::vector<ctrl_t> RandomCtrl(size_t capacity, std::mt19937& rng) {
+    std::vector<ctrl_t> ctrl(capacity + 1 + Group::kWidth);
+    for (size_t i = 0; i != capacity; ++i) {
+        switch (rng() % 4) {
+        case 0:  ctrl[i] = kEmpty; break;
+        case 1:  ctrl[i] = kDeleted; break;
+        default: ctrl[i] = static_cast<ctrl_t>(rng() & 0x7f); break;
+        }
+    }
+    ctrl[capacity] = kSentinel;
+    std::copy(ctrl.begin(), ctrl.begin() + Group::kWidth, ctrl.begin() + capacity + 1);
+    return ctrl;
+}
+
+std::vector<ctrl_t> Expected(std::vector<ctrl_t> ctrl, size_t capacity) {
+    for (size_t i = 0; i != ctrl.size(); ++i)
+        ctrl[i] = IsFull(ctrl[i]) ? kDeleted : kEmpty;
+    ctrl[capacity] = kSentinel;
+    return ctrl;
+}
+
+TEST(CpuDispatch, ConvertDeletedToEmptyAndFullToDeleted) {
+    std::mt19937 rng(42);
+    for (size_t capacity = Group::kWidth - 1; capacity < 100000; capacity = capacity * 2 + 1) {
+        std::vector<ctrl_t> ctrl = RandomCtrl(capacity, rng);
+        std::vector<ctrl_t> expected = Expected(ctrl, capacity);
+        ConvertDeletedToEmptyAndFullToDeleted(ctrl.data(), capacity);
+        EXPECT_EQ(ctrl, expected) << capacity;
+    }
+}
+
+#if PHMAP_HAVE_CPU_DISPATCH
+// each version on its own, as long as this cpu supports it
+TEST(CpuDispatch, EachVersion) {
+    using namespace cpu_dispatch_internal;
+    const int level = GetCpuLevel();
+    std::mt19937 rng(42);
+    for (size_t capacity = 31; capacity < 100000; capacity = capacity * 2 + 1) {
+        std::vector<ctrl_t> ctrl = RandomCtrl(capacity, rng);
+        std::vector<ctrl_t> expected = Expected(ctrl, capacity);
+        for (size_t i = capacity + 1; i != ctrl.size(); ++i)
+            expected[i] = ctrl[i];   // not touched, the clones are copied afterwards
+        if (level >= kCpuSsse3) {
+            std::vector<ctrl_t> c = ctrl;
+            ConvertSpecialToEmptyAndFullToDeletedSsse3(c.data(), capacity + 1);
+            c[capacity] = kSentinel;
+            EXPECT_EQ(c, expected) << capacity;
+        }
+        if (level >= kCpuAvx2) {
+            std::vector<ctrl_t> c = ctrl;
+            ConvertSpecialToEmptyAndFullToDeletedAvx2(c.data(), capacity + 1);
+            c[capacity] = kSentinel;
+            EXPECT_EQ(c, expected) << capacity;
+        }
+    }
+}
+#endif
+
+// erasing and inserting without growing the table goes through
+// drop_deletes_without_resize()
+TEST(CpuDispatch, Churn) {
+    phmap::flat_hash_set<int64_t> s;
+    s.reserve(20000);
+    const size_t capacity = s.capacity();
+    int64_t first = 0, last = 0;
+    for (; last < 20000; ++last)
+        s.insert(last);
+    for (int i = 0; i < 200000; ++i) {
+        s.erase(first++);
+        s.insert(last++);
+    }
+    EXPECT_EQ(s.capacity(), capacity);
+    EXPECT_EQ(s.size(), 20000u);
+    for (int64_t k = 0; k < last; ++k)
+        ASSERT_EQ(s.count(k), k >= first ? 1u : 0u) << k;
+}
+
+}  // namespace
+}  // namespace priv
+}  // namespace phmap
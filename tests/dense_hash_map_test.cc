@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "parallel_hashmap/phmap_dense.h"
+
+namespace phmap {
+namespace priv {
+namespace {
+
+template <class Map>
+std::vector<typename Map::key_type> keys(const Map& m) {
+    std::vector<typename Map::key_type> res;
+    for (auto& p : m)
+        res.push_back(p.first);
+    return res;
+}
+
+// checks that every entry is found at its position
+template <class Map>
+void check_index(const Map& m) {
+    for (size_t i = 0; i < m.size(); ++i)
+        EXPECT_EQ(m.find(m.nth(i).first), m.begin() + i);
+}
+
+TEST(DenseHashMap, InsertionOrder) {
+    phmap::dense_hash_map<std::string, int> m;
+    EXPECT_TRUE(m.empty());
+    EXPECT_TRUE(m.begin() == m.end());
+    EXPECT_TRUE(m.find("a") == m.end());
+
+    m.insert({"c", 1});
+    m.emplace("a", 2);
+    m["b"] = 3;
+    EXPECT_TRUE(m.try_emplace("d", 4).second);
+    EXPECT_FALSE(m.try_emplace("a", 5).second);
+    EXPECT_FALSE(m.insert_or_assign("c", 6).second);
+
+    EXPECT_EQ(m.size(), 4u);
+    EXPECT_EQ(keys(m), (std::vector<std::string>{"c", "a", "b", "d"}));
+    EXPECT_EQ(m.at("a"), 2);
+    EXPECT_EQ(m["c"], 6);
+    EXPECT_EQ(m.count("b"), 1u);
+    EXPECT_FALSE(m.contains("e"));
+    EXPECT_EQ(m.nth(3).second, 4);
+    EXPECT_EQ(m.data(), &*m.begin());
+#ifdef PHMAP_HAVE_EXCEPTIONS
+    EXPECT_THROW(m.at("e"), std::out_of_range);
+#endif
+    check_index(m);
+}
+
+TEST(DenseHashMap, EraseSwapsWithLast) {
+    phmap::dense_hash_map<int, int> m;
+    for (int i = 0; i < 10; ++i)
+        m[i] = i * 10;
+
+    EXPECT_EQ(m.erase(3), 1u);
+    EXPECT_EQ(m.erase(3), 0u);
+    EXPECT_EQ(keys(m), (std::vector<int>{0, 1, 2, 9, 4, 5, 6, 7, 8}));
+
+    // erasing the last entry doesn't move anything
+    EXPECT_EQ(m.erase(8), 1u);
+    m.pop_back();
+    EXPECT_EQ(keys(m), (std::vector<int>{0, 1, 2, 9, 4, 5, 6}));
+    check_index(m);
+
+    // erase while iterating
+    for (auto it = m.begin(); it != m.end(); ) {
+        if (it->first % 2 == 0)
+            it = m.erase(it);
+        else
+            ++it;
+    }
+    EXPECT_EQ(keys(m), (std::vector<int>{5, 1, 9}));
+    EXPECT_EQ(m[9], 90);
+    check_index(m);
+
+    m.clear();
+    EXPECT_TRUE(m.empty());
+    m[1] = 2;
+    EXPECT_EQ(m.size(), 1u);
+}
+
+TEST(DenseHashMap, Large) {
+    phmap::dense_hash_map<int, std::string> m;
+    const int n = 100000;
+    for (int i = 0; i < n; ++i)
+        m.emplace(i, std::to_string(i));
+    EXPECT_EQ(m.size(), (size_t)n);
+    for (int i = 0; i < n; i += 3)
+        EXPECT_EQ(m.erase(i), 1u);
+    for (int i = 0; i < n; ++i) {
+        auto it = m.find(i);
+        if (i % 3 == 0)
+            EXPECT_TRUE(it == m.end());
+        else
+            EXPECT_EQ(it->second, std::to_string(i));
+    }
+    check_index(m);
+}
+
+TEST(DenseHashMap, CopyMoveSwap) {
+    phmap::dense_hash_map<int, int> m{{1, 10}, {2, 20}, {3, 30}};
+    phmap::dense_hash_map<int, int> c(m);
+    EXPECT_EQ(c, m);
+    c[4] = 40;
+    EXPECT_NE(c, m);
+    EXPECT_EQ(m.size(), 3u);
+    check_index(c);
+
+    phmap::dense_hash_map<int, int> mv(std::move(c));
+    EXPECT_EQ(mv.size(), 4u);
+    EXPECT_EQ(mv[4], 40);
+    check_index(mv);
+
+    // the moved-from map is usable again
+    EXPECT_TRUE(c.empty());
+    c[5] = 50;
+    EXPECT_EQ(keys(c), (std::vector<int>{5}));
+    EXPECT_EQ(mv.size(), 4u);
+    check_index(c);
+    check_index(mv);
+
+    swap(mv, m);
+    EXPECT_EQ(m.size(), 4u);
+    EXPECT_EQ(mv.size(), 3u);
+    mv[6] = 60;
+    m.erase(1);
+    check_index(m);
+    check_index(mv);
+
+    c = m;
+    EXPECT_EQ(c, m);
+    check_index(c);
+}
+
+}  // namespace
+}  // namespace priv
+}  // namespace phmap
@@ -291,6 +291,119 @@ TEST(THIS_TEST_NAME, Any) {
 }
 #endif  // __ANDROID__
 
+TEST(THIS_TEST_NAME, TupleKeys) {
+  using Key = std::tuple<int, int, int, int, int>;
+  phmap::Hash<Key> hasher;
+  EXPECT_NE(hasher(Key(1, 2, 3, 4, 5)), hasher(Key(2, 1, 3, 4, 5)));
+  EXPECT_NE(hasher(Key(1, 2, 3, 4, 5)), hasher(Key(1, 2, 3, 5, 4)));
+  using Key2 = std::tuple<int, int>;
+  using Key3 = std::tuple<int, int, int>;
+  EXPECT_NE(phmap::Hash<Key2>()(Key2(0, 0)), phmap::Hash<Key3>()(Key3(0, 0, 0)));
+  using Pair = std::pair<int, int>;
+  EXPECT_EQ(phmap::Hash<Pair>()(Pair(3, 4)), phmap::HashState::combine(phmap::Hash<int>()(3), 4));
+
+  ThisMap<Key, int> m;
+  phmap::flat_hash_set<size_t> hashes;
+  int n = 0;
+  for (int i = 0; i < 10; ++i)
+    for (int j = 0; j < 10; ++j)
+      for (int k = 0; k < 10; ++k)
+        for (int l = 0; l < 10; ++l) {
+          Key key(i, j, k, l, i + j);
+          EXPECT_TRUE(m.emplace(key, n++).second);
+          hashes.insert(hasher(key));
+        }
+  EXPECT_EQ(hashes.size(), 10000u);
+  n = 0;
+  for (int i = 0; i < 10; ++i)
+    for (int j = 0; j < 10; ++j)
+      for (int k = 0; k < 10; ++k)
+        for (int l = 0; l < 10; ++l)
+          EXPECT_EQ(m[Key(i, j, k, l, i + j)], n++);
+}
+
+TEST(THIS_TEST_NAME, TupleKeysWithMixerConstants) {
+  // values equal to the constants xored in by the combiner must not cancel
+  // the hash of the other members
+  const uint64_t c0 = 0xa0761d6478bd642fULL;
+  const uint64_t c1 = 0xe7037ed1a0b428dbULL;
+  using Pair = std::pair<uint64_t, uint64_t>;
+  using Key3 = std::tuple<uint64_t, uint64_t, uint64_t>;
+  phmap::flat_hash_set<size_t> hashes;
+  for (uint64_t i = 0; i < 1000; ++i) {
+    hashes.insert(phmap::Hash<Pair>()(Pair(i, c1)));
+    hashes.insert(phmap::Hash<Pair>()(Pair(c0, i)));
+    hashes.insert(phmap::Hash<Key3>()(Key3(i, i + 1, c1)));
+    hashes.insert(phmap::Hash<Key3>()(Key3(c0, i, c1)));
+  }
+  EXPECT_GT(hashes.size(), 3990u);
+  EXPECT_NE(phmap::Hash<Pair>()(Pair(1, c1)), 0u);
+}
+
+TEST(THIS_TEST_NAME, ForEachLookup) {
+  using M = ThisMap<int64_t, int64_t>;
+  M m;
+  std::vector<int64_t> keys;
+  for (int64_t i = 0; i < 20000; ++i) {
+    keys.push_back(i * 7919);
+    if (i % 3) m[i * 7919] = i;
+  }
+
+  for (size_t group_size : {1, 5, 16, 64, 1000}) {
+    std::vector<int> seen(keys.size());
+    m.for_each_lookup(keys, [&](const int64_t& k, M::value_type* p) {
+      int64_t i = k / 7919;
+      ++seen[i];
+      if (i % 3) {
+        ASSERT_NE(p, nullptr);
+        EXPECT_EQ(p->first, k);
+        EXPECT_EQ(p->second, i);
+      } else {
+        EXPECT_EQ(p, nullptr);
+      }
+    }, group_size);
+    for (int n : seen) ASSERT_EQ(n, 1);
+  }
+
+  // the values can be changed through the pointers
+  m.for_each_lookup(keys.data(), keys.size(), [](const int64_t&, M::value_type* p) {
+    if (p) p->second = -p->second;
+  });
+  const M& cm = m;
+  size_t found = 0;
+  cm.for_each_lookup(keys, [&](const int64_t& k, const M::value_type* p) {
+    if (p) {
+      EXPECT_EQ(p->second, -(k / 7919));
+      ++found;
+    }
+  });
+  EXPECT_EQ(found, m.size());
+
+  M empty;
+  found = 0;
+  empty.for_each_lookup(keys, [&](const int64_t&, M::value_type* p) { found += p != nullptr; });
+  EXPECT_EQ(found, 0u);
+}
+
+// f may look up other keys of the map (for the parallel maps, it is not
+// called while holding their locks)
+TEST(THIS_TEST_NAME, ForEachLookupReentrant) {
+  using M = ThisMap<int64_t, int64_t>;
+  M m;
+  std::vector<int64_t> keys;
+  for (int64_t i = 0; i < 3000; ++i) {
+    keys.push_back(i);
+    if (i % 2) m[i] = i;
+  }
+  size_t found = 0, next_found = 0;
+  m.for_each_lookup(keys, [&](const int64_t& k, M::value_type* p) {
+    found += p != nullptr;
+    next_found += m.contains(k + 1);
+  });
+  EXPECT_EQ(found, 1500u);
+  EXPECT_EQ(next_found, 1500u);
+}
+
 }  // namespace
 }  // namespace priv
 }  // namespace phmap
@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "parallel_hashmap/phmap_multimap.h"
+
+namespace phmap {
+namespace priv {
+namespace {
+
+template <class It>
+std::vector<typename std::iterator_traits<It>::value_type> values(const std::pair<It, It>& r) {
+    return { r.first, r.second };
+}
+
+TEST(FlatHashMultimap, InsertEqualRange) {
+    phmap::flat_hash_multimap<int, std::string> m;
+    EXPECT_TRUE(m.empty());
+    m.insert(1, "a");
+    m.emplace(2, "b");
+    m.insert(1, std::string("c"));
+    m.emplace(1, 3, 'd');
+    EXPECT_EQ(m.size(), 4u);
+    EXPECT_EQ(m.key_count(), 2u);
+    EXPECT_EQ(m.count(1), 3u);
+    EXPECT_EQ(m.count(2), 1u);
+    EXPECT_EQ(m.count(3), 0u);
+    EXPECT_TRUE(m.contains(2));
+
+    // values are kept in insertion order
+    EXPECT_EQ(values(m.equal_range(1)), (std::vector<std::string>{ "a", "c", "ddd" }));
+    EXPECT_EQ(values(m.equal_range(2)), (std::vector<std::string>{ "b" }));
+    auto r = m.equal_range(3);
+    EXPECT_TRUE(r.first == r.second);
+
+    const auto& cm = m;
+    auto cr = cm.equal_range(1);
+    EXPECT_EQ(std::distance(cr.first, cr.second), 3);
+
+    for (auto it = m.equal_range(1).first; it != m.equal_range(1).second; ++it)
+        *it += "!";
+    EXPECT_EQ(values(cm.equal_range(1)), (std::vector<std::string>{ "a!", "c!", "ddd!" }));
+}
+
+TEST(FlatHashMultimap, EraseReusesSlots) {
+    phmap::flat_hash_multimap<int, int> m;
+    for (int k = 0; k < 100; ++k)
+        for (int v = 0; v < 10; ++v)
+            m.insert(k, k * 100 + v);
+    EXPECT_EQ(m.size(), 1000u);
+
+    for (int k = 0; k < 100; k += 2)
+        EXPECT_EQ(m.erase(k), 10u);
+    EXPECT_EQ(m.erase(0), 0u);
+    EXPECT_EQ(m.size(), 500u);
+    EXPECT_EQ(m.key_count(), 50u);
+    EXPECT_FALSE(m.contains(4));
+
+    // new values reuse the erased ones
+    for (int v = 0; v < 500; ++v)
+        m.insert(1000, v);
+    EXPECT_EQ(m.size(), 1000u);
+    EXPECT_EQ(m.count(1000), 500u);
+
+    for (int k = 1; k < 100; k += 2) {
+        std::vector<int> expected;
+        for (int v = 0; v < 10; ++v)
+            expected.push_back(k * 100 + v);
+        EXPECT_EQ(values(m.equal_range(k)), expected);
+    }
+
+    size_t sum = 0, cnt = 0;
+    EXPECT_EQ(m.for_each_of(1000, [&](int v) { sum += (size_t)v; }), 500u);
+    EXPECT_EQ(sum, 499u * 500u / 2);
+    m.for_each([&](int, int) { ++cnt; });
+    EXPECT_EQ(cnt, 1000u);
+
+    m.clear();
+    EXPECT_TRUE(m.empty());
+    EXPECT_EQ(m.count(1), 0u);
+}
+
+TEST(FlatHashMultimap, CopyCompare) {
+    phmap::flat_hash_multimap<int, int> a = { { 1, 1 }, { 1, 2 }, { 2, 3 } };
+    phmap::flat_hash_multimap<int, int> b;
+    b.insert(2, 3);
+    b.insert(1, 2);
+    b.insert(1, 1);
+    EXPECT_TRUE(a == b);     // the order of a key's values doesn't matter
+    auto c = a;
+    EXPECT_TRUE(c == a);
+    c.insert(2, 3);
+    EXPECT_TRUE(c != a);
+    c.swap(b);
+    EXPECT_EQ(b.count(2), 2u);
+    EXPECT_EQ(c.count(2), 1u);
+}
+
+// the inserted value may refer to a value of the map, which the insertion moves
+TEST(FlatHashMultimap, InsertOwnValue) {
+    phmap::flat_hash_multimap<int, std::string> m;
+    const std::string s(40, 'x');
+    m.insert(1, s);
+    for (int i = 0; i < 20; ++i) {
+        m.insert(1, *m.equal_range(1).first);
+        m.insert(2, *(m.equal_range(1).second - 1));
+    }
+    EXPECT_EQ(m.count(1), 21u);
+    EXPECT_EQ(m.count(2), 20u);
+    m.for_each([&](int, const std::string& v) { EXPECT_EQ(v, s); });
+}
+
+TEST(ParallelFlatHashMultimap, Basic) {
+    phmap::parallel_flat_hash_multimap<int, int> m = { { 1, 10 }, { 1, 11 }, { 7, 70 } };
+    EXPECT_EQ(m.size(), 3u);
+    EXPECT_EQ(m.key_count(), 2u);
+    EXPECT_EQ(m.count(1), 2u);
+
+    std::vector<int> v;
+    EXPECT_EQ(m.for_each_of(1, [&](const int& x) { v.push_back(x); }), 2u);
+    EXPECT_EQ(v, (std::vector<int>{ 10, 11 }));
+
+    m.for_each_of_m(1, [](int& x) { x += 1; });
+    v.clear();
+    m.for_each_of(1, [&](const int& x) { v.push_back(x); });
+    EXPECT_EQ(v, (std::vector<int>{ 11, 12 }));
+
+    size_t cnt = 0;
+    m.for_each([&](const int&, const int&) { ++cnt; });
+    EXPECT_EQ(cnt, 3u);
+
+    EXPECT_EQ(m.erase(1), 2u);
+    EXPECT_EQ(m.size(), 1u);
+    m.clear();
+    EXPECT_TRUE(m.empty());
+}
+
+TEST(ParallelFlatHashMultimap, Concurrent) {
+    static constexpr int kThreads = 8;
+    static constexpr int kKeys    = 1000;
+
+    phmap::parallel_flat_hash_multimap<int, int, phmap::Hash<int>, phmap::EqualTo<int>,
+                                       std::allocator<std::pair<const int, int>>, 4, std::mutex> m;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t)
+        threads.emplace_back([&m, t]() {
+            for (int k = 0; k < kKeys; ++k)
+                m.insert(k, t);
+        });
+    for (auto& t : threads)
+        t.join();
+
+    EXPECT_EQ(m.size(), size_t(kThreads * kKeys));
+    for (int k = 0; k < kKeys; ++k) {
+        std::vector<int> v;
+        m.for_each_of(k, [&](int x) { v.push_back(x); });
+        std::sort(v.begin(), v.end());
+        ASSERT_EQ(v.size(), size_t(kThreads));
+        for (int t = 0; t < kThreads; ++t)
+            EXPECT_EQ(v[(size_t)t], t);
+    }
+}
+
+}  // namespace
+}  // namespace priv
+}  // namespace phmap
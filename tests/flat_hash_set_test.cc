@@ -128,6 +128,63 @@ TEST(THIS_TEST_NAME, MergeExtractInsert) {
   EXPECT_THAT(set2, UnorderedElementsAre(Pointee(7), Pointee(23)));
 }
 
+TEST(THIS_TEST_NAME, HwHash) {
+  enum class Color { red, green, blue };
+  EXPECT_NE(phmap::HwHash<Color>()(Color::red), phmap::HwHash<Color>()(Color::green));
+  EXPECT_EQ(phmap::HwHash<std::string>()("abc"), phmap::Hash<std::string>()("abc"));
+
+  // keys which differ only in their high bits
+  std::vector<uint64_t> keys;
+  for (uint64_t i = 0; i < 1000; ++i) keys.push_back(i << 40);
+  THIS_HASH_SET<size_t> hashes;
+  for (auto k : keys) hashes.insert(phmap::HwHash<uint64_t>()(k) & 0xffff);
+  EXPECT_GT(hashes.size(), 950u);
+
+  int objs[100];
+  THIS_HASH_SET<int*, phmap::HwHash<int*>> s;
+  for (auto& o : objs) EXPECT_TRUE(s.insert(&o).second);
+  for (auto& o : objs) EXPECT_TRUE(s.contains(&o));
+  EXPECT_EQ(s.size(), 100u);
+}
+
+template <class T>
+void TestHashMany(size_t n) {
+  std::vector<T> keys;
+  for (size_t i = 0; i < n; ++i)
+    keys.push_back(static_cast<T>(i * 0x9e3779b97f4a7c15ULL));
+
+  THIS_HASH_SET<T> s;
+  std::vector<size_t> hashes(n);
+  s.hash_many(keys.data(), n, hashes.data());
+  for (size_t i = 0; i < n; ++i)
+    EXPECT_EQ(hashes[i], s.hash(keys[i]));
+
+  s.insert(keys.begin(), keys.end());
+  THIS_HASH_SET<T> s2;
+  s2.insert(keys.data(), keys.data() + n);
+  EXPECT_EQ(s.size(), n);
+  EXPECT_EQ(s2.size(), n);
+  for (auto k : keys) {
+    EXPECT_TRUE(s.contains(k));
+    EXPECT_TRUE(s2.contains(k));
+  }
+}
+
+TEST(THIS_TEST_NAME, HashMany) {
+  TestHashMany<int32_t>(1000);
+  TestHashMany<uint32_t>(1001);
+  TestHashMany<int64_t>(1002);
+  TestHashMany<uint64_t>(1003);
+  TestHashMany<uint64_t>(3);
+
+  std::vector<std::string> strs = {"a", "b", "c"};
+  THIS_HASH_SET<std::string> s;
+  size_t hashes[3];
+  s.hash_many(strs.data(), strs.size(), hashes);
+  for (size_t i = 0; i < strs.size(); ++i)
+    EXPECT_EQ(hashes[i], s.hash(strs[i]));
+}
+
 }  // namespace
 }  // namespace priv
 }  // namespace phmap
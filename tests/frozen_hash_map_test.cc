@@ -0,0 +1,140 @@
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "parallel_hashmap/phmap.h"
+#include "parallel_hashmap/phmap_frozen.h"
+
+namespace phmap {
+namespace priv {
+namespace {
+
+using Frozen = phmap::frozen_hash_map<uint64_t, uint32_t>;
+
+TEST(FrozenHashMap, Empty) {
+    Frozen m;
+    EXPECT_TRUE(m.empty());
+    EXPECT_EQ(m.begin(), m.end());
+    EXPECT_FALSE(m.contains(1));
+
+    Frozen m2(std::vector<std::pair<uint64_t, uint32_t>>{});
+    EXPECT_TRUE(m2.empty());
+    EXPECT_TRUE(m2.find(0) == m2.end());
+}
+
+TEST(FrozenHashMap, FromFlatHashMap) {
+    for (size_t n : { 1, 2, 3, 10, 100, 1000, 100000 }) {
+        phmap::flat_hash_map<uint64_t, uint32_t> src;
+        for (size_t i = 0; i < n; ++i)
+            src.emplace(i * 7919 + 3, (uint32_t)i);
+
+        Frozen m(src);
+        ASSERT_EQ(m.size(), n);
+        for (auto& p : src) {
+            auto it = m.find(p.first);
+            ASSERT_TRUE(it != m.end());
+            EXPECT_EQ(it->second, p.second);
+        }
+        for (size_t i = 0; i < n; ++i)
+            EXPECT_FALSE(m.contains(i * 7919 + 4));
+
+        // minimal: the values are stored in an array of exactly n entries
+        size_t cnt = 0;
+        for (auto& p : m) {
+            EXPECT_EQ(src.at(p.first), p.second);
+            ++cnt;
+        }
+        EXPECT_EQ(cnt, n);
+        EXPECT_EQ((size_t)std::distance(m.begin(), m.end()), n);
+    }
+}
+
+TEST(FrozenHashMap, SortedRangeWithDuplicates) {
+    std::vector<std::pair<std::string, int>> v = {
+        { "apple", 1 }, { "banana", 2 }, { "banana", 3 }, { "cherry", 4 }
+    };
+    phmap::frozen_hash_map<std::string, int> m(v.begin(), v.end());
+    EXPECT_EQ(m.size(), 3u);
+    EXPECT_EQ(m.at("apple"), 1);
+    EXPECT_EQ(m.at("banana"), 2);   // the first one is kept
+    EXPECT_EQ(m.count("cherry"), 1u);
+    EXPECT_EQ(m.count("durian"), 0u);
+#ifdef PHMAP_HAVE_EXCEPTIONS
+    EXPECT_THROW(m.at("durian"), std::out_of_range);
+#endif
+}
+
+struct BadHash {
+    size_t operator()(int) const { return 42; }
+};
+
+TEST(FrozenHashMap, HashCollision) {
+#ifdef PHMAP_HAVE_EXCEPTIONS
+    std::vector<std::pair<int, int>> v = { { 1, 1 }, { 2, 2 } };
+    using F = phmap::frozen_hash_map<int, int, BadHash>;
+    EXPECT_THROW(F(v.begin(), v.end()), std::invalid_argument);
+#endif
+}
+
+TEST(FrozenHashMap, CopyMoveSwap) {
+    Frozen a = { { 1, 10 }, { 2, 20 }, { 3, 30 } };
+    Frozen b(a);
+    EXPECT_TRUE(a == b);
+    Frozen c(std::move(a));
+    EXPECT_TRUE(a.empty());
+    EXPECT_EQ(c.at(2), 20u);
+
+    Frozen d = { { 4, 40 } };
+    d.swap(c);
+    EXPECT_EQ(d.at(3), 30u);
+    EXPECT_EQ(c.at(4), 40u);
+    c = d;
+    EXPECT_TRUE(c == d);
+    EXPECT_TRUE(c != b ? false : true);
+}
+
+TEST(FrozenHashMap, DumpLoadAttach) {
+    phmap::flat_hash_map<uint64_t, uint32_t> src;
+    for (uint32_t i = 0; i < 5000; ++i)
+        src.emplace(uint64_t(i) * 0x9E3779B97F4A7C15ull, i);
+    Frozen m(src);
+
+    std::stringstream ss;
+    {
+        phmap::BinaryOutputArchive ar_out(ss);
+        EXPECT_TRUE(m.phmap_dump(ar_out));
+    }
+    std::string bytes = ss.str();
+
+    Frozen loaded;
+    {
+        phmap::BinaryInputArchive ar_in(ss);
+        EXPECT_TRUE(loaded.phmap_load(ar_in));
+    }
+    EXPECT_TRUE(loaded == m);
+
+    // attach in place (as from an mmap'ed file), from an 8 byte aligned buffer
+    std::vector<uint64_t> buf((bytes.size() + 7) / 8);
+    std::memcpy(buf.data(), bytes.data(), bytes.size());
+    Frozen attached;
+    EXPECT_TRUE(attached.attach(buf.data(), bytes.size()));
+    EXPECT_TRUE(attached == m);
+    for (auto& p : src)
+        EXPECT_EQ(attached.at(p.first), p.second);
+    EXPECT_FALSE(attached.contains(1));
+
+    Frozen copy(attached);
+    EXPECT_TRUE(copy == m);
+
+    EXPECT_FALSE(attached.attach(buf.data(), bytes.size() - 8));    // truncated
+    buf[0] = 0;
+    EXPECT_FALSE(attached.attach(buf.data(), bytes.size()));        // bad version
+    EXPECT_TRUE(attached == m);                                      // unchanged on failure
+}
+
+}  // namespace
+}  // namespace priv
+}  // namespace phmap
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "parallel_hashmap/phmap_indirect.h"
+
+namespace phmap {
+namespace priv {
+namespace {
+
+TEST(IndirectFlatHashMap, Basic) {
+    phmap::indirect_flat_hash_map<std::string, int> m;
+    EXPECT_TRUE(m.empty());
+    EXPECT_TRUE(m.begin() == m.end());
+    EXPECT_TRUE(m.find("a") == m.end());
+
+    EXPECT_TRUE(m.insert({"a", 1}).second);
+    EXPECT_TRUE(m.emplace("b", 2).second);
+    EXPECT_FALSE(m.emplace("b", 3).second);
+    EXPECT_TRUE(m.try_emplace("c", 3).second);
+    EXPECT_FALSE(m.try_emplace("c", 4).second);
+    m["d"] = 4;
+    EXPECT_FALSE(m.insert_or_assign("a", 10).second);
+
+    EXPECT_EQ(m.size(), 4u);
+    EXPECT_EQ(m.at("a"), 10);
+    EXPECT_EQ(m["b"], 2);
+    EXPECT_EQ(m.count("c"), 1u);
+    EXPECT_FALSE(m.contains("e"));
+#ifdef PHMAP_HAVE_EXCEPTIONS
+    EXPECT_THROW(m.at("e"), std::out_of_range);
+#endif
+
+    int sum = 0;
+    for (auto& p : m)
+        sum += p.second;
+    EXPECT_EQ(sum, 19);
+
+    const auto& cm = m;
+    auto it = cm.find("d");
+    ASSERT_TRUE(it != cm.end());
+    EXPECT_EQ(it->first, "d");
+
+    EXPECT_EQ(m.erase("a"), 1u);
+    EXPECT_EQ(m.erase("a"), 0u);
+    EXPECT_EQ(m.size(), 3u);
+
+    m.clear();
+    EXPECT_TRUE(m.empty());
+    m["x"] = 1;
+    EXPECT_EQ(m.size(), 1u);
+}
+
+TEST(IndirectFlatHashMap, PointerStability) {
+    phmap::indirect_flat_hash_map<int, std::string> m;
+    std::vector<const std::string*> ptrs;
+    const int n = 10000;
+    for (int i = 0; i < n; ++i)
+        ptrs.push_back(&m.try_emplace(i, std::to_string(i)).first->second);
+
+    // erase every other element, and insert new ones reusing their storage
+    for (int i = 0; i < n; i += 2)
+        EXPECT_EQ(m.erase(i), 1u);
+    for (int i = n; i < 2 * n; ++i)
+        m[i] = std::to_string(i);
+    m.rehash(m.bucket_count() * 4);
+
+    for (int i = 1; i < n; i += 2) {
+        EXPECT_EQ(&m.at(i), ptrs[i]);
+        EXPECT_EQ(*ptrs[i], std::to_string(i));
+    }
+    for (int i = 0; i < 2 * n; ++i)
+        EXPECT_EQ(m.contains(i), i >= n || i % 2 == 1);
+    EXPECT_EQ(m.size(), (size_t)(n + n / 2));
+    // erased positions were reused
+    EXPECT_LE(m.value_capacity(), (size_t)(4 * n));
+}
+
+TEST(IndirectFlatHashMap, EraseWhileIterating) {
+    phmap::indirect_flat_hash_map<int, std::unique_ptr<int>> m;
+    for (int i = 0; i < 1000; ++i)
+        m.emplace(i, std::unique_ptr<int>(new int(i)));
+    size_t visited = 0;
+    for (auto it = m.begin(); it != m.end(); ) {
+        ++visited;
+        if (*it->second % 3 == 0)
+            it = m.erase(it);
+        else
+            ++it;
+    }
+    EXPECT_EQ(visited, 1000u);
+    EXPECT_EQ(m.size(), 666u);
+    for (auto& p : m)
+        EXPECT_NE(p.first % 3, 0);
+}
+
+TEST(IndirectFlatHashMap, CopyMoveSwap) {
+    phmap::indirect_flat_hash_map<int, std::string> m{{1, "a"}, {2, "b"}, {3, "c"}};
+    auto c(m);
+    EXPECT_EQ(c, m);
+    c[4] = "d";
+    EXPECT_NE(c, m);
+    EXPECT_EQ(c.at(2), "b");
+
+    auto mv(std::move(c));
+    EXPECT_EQ(mv.size(), 4u);
+    EXPECT_EQ(mv.at(4), "d");
+
+    swap(mv, m);
+    EXPECT_EQ(m.size(), 4u);
+    EXPECT_EQ(mv.size(), 3u);
+
+    c = m;
+    EXPECT_EQ(c, m);
+    c.erase(1);
+    EXPECT_EQ(m.size(), 4u);
+    EXPECT_EQ(c.size(), 3u);
+}
+
+}  // namespace
+}  // namespace priv
+}  // namespace phmap
@@ -0,0 +1,122 @@
+#include "parallel_hashmap/phmap.h"
+
+namespace phmap {
+    // run the flat_hash_map tests with a small inline capacity, so that both
+    // the inline and the heap layouts are exercised.
+    template <class K, class V,
+              class H     = phmap::priv::hash_default_hash<K>,
+              class Eq    = phmap::priv::hash_default_eq<K>,
+              class Alloc = phmap::priv::Allocator<phmap::priv::Pair<const K, V>>>
+    using inline_flat_hash_map_4 = inline_flat_hash_map<K, V, 4, H, Eq, Alloc>;
+}
+
+#define THIS_HASH_MAP  inline_flat_hash_map_4
+#define THIS_TEST_NAME InlineFlatHashMap
+
+#include "flat_hash_map_test.cc"
+
+namespace phmap {
+namespace priv {
+namespace {
+
+// counts the allocations done through it
+template <class T>
+struct CountingAlloc : std::allocator<T> {
+    template <class U> struct rebind { using other = CountingAlloc<U>; };
+
+    CountingAlloc(size_t* count = nullptr) : count_(count) {}
+    template <class U>
+    CountingAlloc(const CountingAlloc<U>& o) : count_(o.count_) {}
+
+    T* allocate(size_t n) {
+        if (count_) ++*count_;
+        return std::allocator<T>::allocate(n);
+    }
+
+    template <class U> bool operator==(const CountingAlloc<U>& o) const { return count_ == o.count_; }
+    template <class U> bool operator!=(const CountingAlloc<U>& o) const { return count_ != o.count_; }
+
+    size_t* count_;
+};
+
+using IMap = phmap::inline_flat_hash_map<int, std::string, 8, phmap::Hash<int>, phmap::EqualTo<int>,
+                                         CountingAlloc<std::pair<const int, std::string>>>;
+
+TEST(InlineFlatHashMap, NoAllocationWhenSmall) {
+    size_t count = 0;
+    IMap m(CountingAlloc<std::pair<const int, std::string>>{&count});
+    for (int i = 0; i < 8; ++i)
+        m.emplace(i, std::to_string(i));
+    EXPECT_EQ(count, 0u);
+    EXPECT_EQ(m.size(), 8u);
+    for (int i = 0; i < 8; ++i)
+        EXPECT_EQ(m[i], std::to_string(i));
+
+    m.reserve(4);
+    m.rehash(0);
+    EXPECT_EQ(count, 0u);
+
+    // spill to the heap
+    for (int i = 8; i < 100; ++i)
+        m.emplace(i, std::to_string(i));
+    EXPECT_GT(count, 0u);
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ(m[i], std::to_string(i));
+
+    // and back to the inline storage
+    for (int i = 4; i < 100; ++i)
+        m.erase(i);
+    m.rehash(0);
+    EXPECT_EQ(m.size(), 4u);
+    for (int i = 0; i < 4; ++i)
+        EXPECT_EQ(m[i], std::to_string(i));
+}
+
+TEST(InlineFlatHashMap, MoveAndSwap) {
+    for (int big : { 0, 1 }) {
+        IMap a, b;
+        int na = big ? 50 : 3;
+        for (int i = 0; i < na; ++i)
+            a.emplace(i, std::to_string(i));
+        b.emplace(1000, "x");
+
+        IMap c(std::move(a));
+        EXPECT_TRUE(a.empty());
+        EXPECT_EQ(c.size(), (size_t)na);
+        EXPECT_EQ(c[na - 1], std::to_string(na - 1));
+
+        c.swap(b);
+        EXPECT_EQ(b.size(), (size_t)na);
+        EXPECT_EQ(c.size(), 1u);
+        EXPECT_EQ(c[1000], "x");
+        for (int i = 0; i < na; ++i)
+            EXPECT_EQ(b[i], std::to_string(i));
+
+        a = std::move(b);
+        EXPECT_EQ(a.size(), (size_t)na);
+        IMap d(a);
+        EXPECT_TRUE(d == a);
+        a.clear();
+        EXPECT_TRUE(a.empty());
+        EXPECT_EQ(d.size(), (size_t)na);
+    }
+}
+
+TEST(InlineFlatHashSet, Basic) {
+    phmap::inline_flat_hash_set<std::string, 4> s1 = { "a", "b" }, s2;
+    EXPECT_EQ(s1.size(), 2u);
+    EXPECT_TRUE(s1.contains("a"));
+    EXPECT_FALSE(s1.contains("c"));
+    s1.swap(s2);
+    EXPECT_TRUE(s1.empty());
+    EXPECT_TRUE(s2.contains("b"));
+    for (int i = 0; i < 20; ++i)
+        s2.insert(std::to_string(i));
+    EXPECT_EQ(s2.size(), 22u);
+    s1 = s2;
+    EXPECT_TRUE(s1 == s2);
+}
+
+}  // namespace
+}  // namespace priv
+}  // namespace phmap
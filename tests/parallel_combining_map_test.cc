@@ -0,0 +1,123 @@
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "parallel_hashmap/phmap_combining.h"
+
+namespace phmap {
+namespace priv {
+namespace {
+
+TEST(ParallelCombiningMap, Upsert) {
+    phmap::parallel_combining_map<std::string, int> m;
+    EXPECT_TRUE(m.upsert("a", [](int& v) { v += 1; }));
+    EXPECT_FALSE(m.upsert("a", [](int& v) { v += 2; }));
+    EXPECT_TRUE(m.upsert("b", [](int& v) { EXPECT_EQ(v, 0); v = 10; }));
+    EXPECT_EQ(m.size(), 2u);
+    EXPECT_EQ(m["a"], 3);
+    EXPECT_EQ(m["b"], 10);
+
+    // the regular map interface is still available
+    m.try_emplace_l("c", [](phmap::parallel_combining_map<std::string, int>::value_type&) {}, 5);
+    EXPECT_FALSE(m.upsert("c", [](int& v) { v *= 2; }));
+    EXPECT_EQ(m["c"], 10);
+}
+
+TEST(ParallelCombiningMap, UpsertAsync) {
+    phmap::parallel_combining_map<std::string, std::string> m;
+    std::string key = "k";
+    m.upsert_async(key, [](std::string& v) { v += "a"; });
+    key = "other";   // copied by upsert_async
+    std::future<bool> f1 = m.upsert_async("k", [](std::string& v) { v += "b"; }, phmap::with_future);
+    std::future<bool> f2 = m.upsert_async("n", [](std::string& v) { v += "c"; }, phmap::with_future);
+    EXPECT_FALSE(f1.get());
+    EXPECT_TRUE(f2.get());
+    EXPECT_EQ(m.size(), 2u);
+    EXPECT_EQ(m["k"], "ab");
+    EXPECT_EQ(m["n"], "c");
+}
+
+// the upserts posted by a thread are applied once it is joined, in the order
+// in which it posted them for each key
+TEST(ParallelCombiningMap, Concurrent) {
+    static constexpr int kThreads = 8;
+    static constexpr int kIters   = 20000;
+    static constexpr int kKeys    = 20;
+
+    struct value
+    {
+        int count = 0;
+        int last[kThreads] = {};   // last i upserted by each thread
+    };
+
+    phmap::parallel_combining_map<int, value, phmap::priv::hash_default_hash<int>,
+                                  phmap::priv::hash_default_eq<int>,
+                                  phmap::priv::Allocator<phmap::priv::Pair<const int, value>>, 1> m;
+    std::vector<std::thread> threads;
+    std::vector<int> out_of_order(kThreads);
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 1; i <= kIters; ++i) {
+                auto fn = [&, t, i](value& v) {
+                    ++v.count;
+                    if (v.last[t] >= i)
+                        ++out_of_order[t];
+                    v.last[t] = i;
+                };
+                if (i % 3 == 0)
+                    m.upsert(i % kKeys, fn);
+                else
+                    m.upsert_async(i % kKeys, fn);
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+
+    EXPECT_EQ(m.size(), size_t(kKeys));
+    int total = 0;
+    for (auto& p : m)
+        total += p.second.count;
+    EXPECT_EQ(total, kThreads * kIters);
+    for (int n : out_of_order)
+        EXPECT_EQ(n, 0);
+}
+
+// the upserts posted while the submap is locked by another operation are
+// applied by one of the posting threads once it gets the lock
+TEST(ParallelCombiningMap, Delegated) {
+    phmap::parallel_combining_map<int, int, phmap::priv::hash_default_hash<int>,
+                                  phmap::priv::hash_default_eq<int>,
+                                  phmap::priv::Allocator<phmap::priv::Pair<const int, int>>, 0> m;
+    std::vector<std::thread> threads;
+    std::vector<std::future<bool>> futures(4);
+    m.with_submap_m(0, [&](auto& set) {
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&, t]() {
+                if (t == 0)
+                    futures[t] = m.upsert_async(t, [](int& v) { v += 1; }, phmap::with_future);
+                else if (t == 1)
+                    m.upsert_async(t, [](int& v) { v += 2; });
+                else
+                    m.upsert(t, [t](int& v) { v += t; });
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        EXPECT_EQ(set.size(), 0u);
+    });
+    for (auto& t : threads)
+        t.join();
+    EXPECT_TRUE(futures[0].get());
+    EXPECT_EQ(m.size(), 4u);
+    EXPECT_EQ(m[0], 1);
+    EXPECT_EQ(m[1], 2);
+    EXPECT_EQ(m[2], 2);
+    EXPECT_EQ(m[3], 3);
+}
+
+}  // namespace
+}  // namespace priv
+}  // namespace phmap
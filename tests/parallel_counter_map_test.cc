@@ -0,0 +1,99 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "parallel_hashmap/phmap_counter.h"
+
+namespace phmap {
+namespace priv {
+namespace {
+
+using CounterMap = phmap::parallel_counter_map<std::string, size_t>;
+
+TEST(ParallelCounterMap, Add) {
+    CounterMap m;
+    EXPECT_EQ(m.add("a"), 1u);
+    EXPECT_EQ(m.add("a"), 2u);
+    EXPECT_EQ(m.add("b", 5), 5u);
+    EXPECT_EQ(m.add("a", 10), 12u);
+    EXPECT_EQ(m.size(), 2u);
+    EXPECT_EQ(m.get("a"), 12u);
+    EXPECT_EQ(m.get("b"), 5u);
+    EXPECT_EQ(m.get("c"), 0u);
+
+    // the regular map interface is still available
+    auto it = m.find("b");
+    ASSERT_TRUE(it != m.end());
+    EXPECT_EQ(size_t(it->second), 5u);
+}
+
+TEST(ParallelCounterMap, AddAll) {
+    CounterMap m;
+    m.add("x", 3);
+    std::vector<std::string> words = { "x", "y", "z", "y", "x", "x" };
+    m.add_all(words);
+    EXPECT_EQ(m.size(), 3u);
+    EXPECT_EQ(m.get("x"), 6u);
+    EXPECT_EQ(m.get("y"), 2u);
+    EXPECT_EQ(m.get("z"), 1u);
+
+    m.add_all(words.begin(), words.begin() + 1);
+    EXPECT_EQ(m.get("x"), 7u);
+}
+
+TEST(ParallelCounterMap, TopK) {
+    phmap::parallel_counter_map<int, int> m;
+    for (int i = 0; i < 1000; ++i)
+        m.add(i, i % 100);
+
+    EXPECT_TRUE(m.top_k(0).empty());
+
+    for (size_t threads : { 1, 3, 0 }) {
+        auto top = m.top_k(5, threads);
+        ASSERT_EQ(top.size(), 5u);
+        for (auto& p : top)
+            EXPECT_EQ(p.second, 99);
+        EXPECT_EQ(top[0].first % 100, 99);
+    }
+
+    auto top = m.top_k(20);
+    ASSERT_EQ(top.size(), 20u);
+    for (size_t i = 1; i < top.size(); ++i)
+        EXPECT_GE(top[i - 1].second, top[i].second);
+    EXPECT_EQ(top[10].second, 98);
+
+    auto all = m.top_k(5000);
+    EXPECT_EQ(all.size(), 1000u);
+}
+
+TEST(ParallelCounterMap, ConcurrentAdd) {
+    static constexpr int kThreads = 8;
+    static constexpr int kIters   = 20000;
+    static constexpr int kKeys    = 100;
+
+    phmap::parallel_counter_map<int, int> m;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&m, t]() {
+            std::vector<int> batch;
+            for (int i = 0; i < kIters; ++i) {
+                if (t % 2)
+                    m.add(i % kKeys);
+                else
+                    batch.push_back(i % kKeys);
+            }
+            m.add_all(batch);
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+
+    EXPECT_EQ(m.size(), size_t(kKeys));
+    for (int k = 0; k < kKeys; ++k)
+        EXPECT_EQ(m.get(k), kThreads * kIters / kKeys);
+}
+
+}  // namespace
+}  // namespace priv
+}  // namespace phmap
@@ -0,0 +1,131 @@
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "parallel_hashmap/phmap_filter.h"
+
+namespace phmap {
+namespace priv {
+namespace {
+
+TEST(ParallelFilteredHashSet, Basic) {
+    phmap::parallel_filtered_flat_hash_set<std::string> s;
+    EXPECT_TRUE(s.empty());
+    EXPECT_FALSE(s.contains("a"));
+    EXPECT_EQ(s.filter_bytes(), 0u);
+
+    EXPECT_TRUE(s.insert("a"));
+    EXPECT_FALSE(s.insert(std::string("a")));
+    EXPECT_TRUE(s.emplace(3, 'b'));
+    EXPECT_EQ(s.size(), 2u);
+    EXPECT_TRUE(s.contains("bbb"));
+    EXPECT_EQ(s.count("a"), 1u);
+    EXPECT_FALSE(s.contains("c"));
+    EXPECT_GT(s.filter_bytes(), 0u);
+
+    EXPECT_EQ(s.erase("a"), 1u);
+    EXPECT_EQ(s.erase("a"), 0u);
+    EXPECT_FALSE(s.contains("a"));
+
+    s.clear();
+    EXPECT_TRUE(s.empty());
+    EXPECT_FALSE(s.contains("bbb"));
+    EXPECT_TRUE(s.insert("bbb"));
+    EXPECT_TRUE(s.contains("bbb"));
+}
+
+TEST(ParallelFilteredHashSet, GrowAndErase) {
+    phmap::parallel_filtered_flat_hash_set<int> s;
+    const int n = 100000;
+    for (int i = 0; i < n; ++i)
+        EXPECT_TRUE(s.insert(i));
+    for (int i = 0; i < n; ++i)
+        EXPECT_TRUE(s.contains(i));
+
+    // most misses are rejected by the filters, some are false positives
+    size_t found = 0;
+    for (int i = n; i < 2 * n; ++i)
+        found += s.count(i);
+    EXPECT_EQ(found, 0u);
+
+    // erasing rebuilds the filters, which must keep the remaining keys
+    for (int i = 0; i < n; ++i) {
+        if (i % 10) {
+            EXPECT_EQ(s.erase(i), 1u);
+        }
+    }
+    EXPECT_EQ(s.size(), (size_t)n / 10);
+    for (int i = 0; i < n; ++i)
+        EXPECT_EQ(s.contains(i), i % 10 == 0);
+
+    s.reserve(4 * n);
+    for (int i = 0; i < n; i += 10)
+        EXPECT_TRUE(s.contains(i));
+}
+
+TEST(ParallelFilteredHashMap, Basic) {
+    phmap::parallel_filtered_flat_hash_map<std::string, int> m;
+    EXPECT_TRUE(m.try_emplace("a", 1));
+    EXPECT_FALSE(m.try_emplace("a", 2));
+    EXPECT_TRUE(m.insert({"b", 2}));
+    EXPECT_TRUE(m.insert_or_assign("c", 3));
+    EXPECT_FALSE(m.insert_or_assign("a", 10));
+    EXPECT_EQ(m.size(), 3u);
+
+    int v = 0;
+    EXPECT_TRUE(m.if_contains("a", [&](const std::pair<const std::string, int>& p) { v = p.second; }));
+    EXPECT_EQ(v, 10);
+    EXPECT_FALSE(m.if_contains("d", [&](const std::pair<const std::string, int>&) { v = -1; }));
+    EXPECT_EQ(v, 10);
+
+    int sum = 0;
+    m.for_each([&](const std::pair<const std::string, int>& p) { sum += p.second; });
+    EXPECT_EQ(sum, 15);
+}
+
+// readers look up keys known to be present while writers insert and erase
+// other keys, which grows and rebuilds the filters
+TEST(ParallelFilteredHashSet, NoFalseNegativesUnderConcurrency) {
+    phmap::parallel_filtered_flat_hash_set<int, phmap::priv::hash_default_hash<int>,
+                                           phmap::priv::hash_default_eq<int>,
+                                           phmap::priv::Allocator<int>, 4, std::mutex> s;
+    const int num_present = 10000;
+    for (int i = 0; i < num_present; ++i)
+        s.insert(-1 - i);
+
+    std::atomic<bool> done{false};
+    std::atomic<size_t> false_negatives{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 2; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 200000; ++i) {
+                int k = t * 1000000 + i;
+                s.insert(k);
+                if (i % 3)
+                    s.erase(k);
+            }
+        });
+    }
+    for (int t = 0; t < 2; ++t) {
+        threads.emplace_back([&]() {
+            while (!done) {
+                for (int i = 0; i < num_present; ++i)
+                    if (!s.contains(-1 - i))
+                        ++false_negatives;
+            }
+        });
+    }
+    threads[0].join();
+    threads[1].join();
+    done = true;
+    threads[2].join();
+    threads[3].join();
+    EXPECT_EQ(false_negatives, 0u);
+}
+
+}  // namespace
+}  // namespace priv
+}  // namespace phmap
@@ -3,6 +3,9 @@
     #define THIS_TEST_NAME ParallelFlatHashMap
 #endif
 
+#include <list>
+#include <vector>
+
 #include "flat_hash_map_test.cc"
 
 namespace phmap {
@@ -163,6 +166,64 @@ TEST(THIS_TEST_NAME, EmplaceSingle) {
     EXPECT_EQ(m.count(11), 0);
 }
 
+TEST(THIS_TEST_NAME, ParallelBuild) {
+    // --------------------
+    // test parallel_build
+    // --------------------
+    using Map = ThisMap<int, int>;
+    std::vector<std::pair<int, int>> v;
+    for (int i=0; i<100000; ++i)
+        v.emplace_back(i % 60000, i);      // keys 0..39999 appear twice
+
+    Map m(phmap::parallel_build, v.begin(), v.end(), 4);
+    EXPECT_EQ(m.size(), 60000);
+    for (int i=0; i<60000; ++i)
+        EXPECT_EQ(m[i], i);                // the first one wins, as with insert()
+    EXPECT_TRUE(m == Map(v.begin(), v.end()));
+
+    // adds to the existing entries, and works with forward iterators
+    std::list<std::pair<int, int>> l = { {-1, 1}, {0, 1} };
+    m.parallel_build(l.begin(), l.end());
+    EXPECT_EQ(m.size(), 60001);
+    EXPECT_EQ(m[-1], 1);
+    EXPECT_EQ(m[0], 0);
+
+    m.parallel_build(v.begin(), v.begin(), 2);
+    EXPECT_EQ(m.size(), 60001);
+}
+
+TEST(THIS_TEST_NAME, ParallelReserveClearRelease) {
+    // -----------------------------------------------------------
+    // test parallel_reserve, parallel_rehash, parallel_clear and
+    // parallel_release
+    // -----------------------------------------------------------
+    using Map = ThisMap<int, int>;
+    Map m;
+    m.parallel_reserve(10000, 4);
+    EXPECT_GE(m.capacity(), 10000);
+    size_t cap = m.capacity();
+    for (int i=0; i<10000; ++i)
+        m[i] = i;
+    EXPECT_EQ(m.capacity(), cap);          // no resize after reserve
+
+    m.parallel_rehash(4 * cap, 3);
+    EXPECT_GE(m.capacity(), 4 * cap);
+    EXPECT_EQ(m.size(), 10000);
+    for (int i=0; i<10000; ++i)
+        EXPECT_EQ(m[i], i);
+
+    m.parallel_clear(4);
+    EXPECT_TRUE(m.empty());
+    EXPECT_GE(m.capacity(), 4 * cap);     // like clear(), keeps the memory
+    m[1] = 2;
+
+    m.parallel_release();
+    EXPECT_TRUE(m.empty());
+    EXPECT_EQ(m.capacity(), 0);
+    m[3] = 4;
+    EXPECT_EQ(m.size(), 1);
+}
+
 
 }  // namespace
 }  // namespace priv
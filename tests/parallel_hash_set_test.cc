@@ -3,6 +3,9 @@
     #define THIS_TEST_NAME ParallelFlatHashSet
 #endif
 
+#include <random>
+#include <vector>
+
 #include "flat_hash_set_test.cc"
 
 namespace phmap {
@@ -131,6 +134,88 @@ TEST(THIS_TEST_NAME, EmplaceSingle) {
     EXPECT_EQ(m.count(11), 0);
 }
 
+TEST(THIS_TEST_NAME, ParallelMergeAndSetAlgebra) {
+    using Set = phmap::THIS_HASH_SET<int>;
+
+    // ---------------------------------------------------------------
+    // test parallel_merge, set_union, set_intersection, set_difference
+    // ---------------------------------------------------------------
+    Set a, b;
+    for (int i=0; i<1000; ++i)
+        a.insert(i);              // [0, 1000)
+    for (int i=500; i<2000; ++i)
+        b.insert(i);              // [500, 2000)
+
+    Set u = a;
+    u.set_union(b, 4);
+    EXPECT_EQ(u.size(), 2000);
+    EXPECT_EQ(b.size(), 1500);
+
+    Set x = a;
+    x.set_intersection(b, 4);
+    EXPECT_EQ(x.size(), 500);
+    for (int i=500; i<1000; ++i)
+        EXPECT_EQ(x.count(i), 1);
+
+    Set d = a;
+    d.set_difference(b);
+    EXPECT_EQ(d.size(), 500);
+    for (int i=0; i<500; ++i)
+        EXPECT_EQ(d.count(i), 1);
+
+    d.set_difference(d);
+    EXPECT_TRUE(d.empty());
+
+    // parallel_merge moves the nodes whose key is not present, like merge
+    Set m = a;
+    m.parallel_merge(b, 3);
+    EXPECT_EQ(m.size(), 2000);
+    EXPECT_EQ(b.size(), 500);
+    for (int i=500; i<1000; ++i)
+        EXPECT_EQ(b.count(i), 1);
+}
+
+TEST(THIS_TEST_NAME, CompactStep) {
+    using Set = phmap::THIS_HASH_SET<int>;
+
+    // -------------------------------------------------------------
+    // test tombstones and compact_step, after random erase/insert churn
+    // -------------------------------------------------------------
+    Set s;
+    EXPECT_EQ(s.tombstones(), 0);
+    EXPECT_EQ(s.compact_step(), 0);
+
+    std::vector<int> keys;
+    int i = 0;
+    for (; i<10000; ++i) {
+        s.insert(i);
+        keys.push_back(i);
+    }
+    std::mt19937 gen(3);
+    for (; i<22000; ++i) {
+        int& k = keys[gen() % keys.size()];
+        EXPECT_EQ(s.erase(k), 1);
+        k = i;
+        s.insert(i);
+    }
+    const size_t capacity = s.capacity();
+    ASSERT_GT(s.tombstones(), 0);
+
+    // one submap per step
+    size_t pos = 0, num_steps = 0;
+    do {
+        pos = s.compact_step(1, pos);
+        ++num_steps;
+    } while (pos);
+    EXPECT_GT(num_steps, 1);
+    EXPECT_LE(num_steps, s.subcnt());
+    EXPECT_EQ(s.tombstones(), 0);
+    EXPECT_EQ(s.capacity(), capacity);
+    EXPECT_EQ(s.size(), keys.size());
+    for (int k : keys)
+        EXPECT_EQ(s.count(k), 1);
+}
+
 }  // namespace
 }  // namespace priv
 }  // namespace phmap
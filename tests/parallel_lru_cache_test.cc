@@ -0,0 +1,122 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "parallel_hashmap/phmap_lru_cache.h"
+
+namespace phmap {
+namespace priv {
+namespace {
+
+TEST(ParallelLruCache, GetPut) {
+    phmap::parallel_lru_cache<std::string, std::string> c(100);
+    EXPECT_GE(c.capacity(), 100u);
+    EXPECT_TRUE(c.empty());
+
+    std::string v;
+    EXPECT_FALSE(c.get("a", v));
+    EXPECT_TRUE(c.put("a", "1"));
+    EXPECT_TRUE(c.get("a", v));
+    EXPECT_EQ(v, "1");
+    EXPECT_FALSE(c.put("a", std::string("2")));
+    EXPECT_TRUE(c.get("a", v));
+    EXPECT_EQ(v, "2");
+    EXPECT_EQ(c.size(), 1u);
+    EXPECT_TRUE(c.contains("a"));
+
+    EXPECT_EQ(c.erase("a"), 1u);
+    EXPECT_FALSE(c.contains("a"));
+
+    auto s = c.stats();
+    EXPECT_EQ(s.hits, 2u);
+    EXPECT_EQ(s.misses, 1u);
+    EXPECT_EQ(s.evictions, 0u);
+}
+
+TEST(ParallelLruCache, CapacityBound) {
+    // a single submap, to check the exact bound
+    phmap::parallel_lru_cache<int, int, phmap::Hash<int>, phmap::EqualTo<int>,
+                              phmap::priv::Allocator<phmap::priv::Pair<const int, clock_entry<int>>>,
+                              0> c(50);
+    EXPECT_EQ(c.capacity(), 50u);
+    for (int i = 0; i < 1000; ++i) {
+        c.put(i, i);
+        EXPECT_LE(c.size(), 50u);
+    }
+    EXPECT_EQ(c.size(), 50u);
+    EXPECT_EQ(c.stats().evictions, 950u);
+    EXPECT_TRUE(c.contains(999));
+}
+
+TEST(ParallelLruCache, ClockKeepsReferencedEntries) {
+    phmap::parallel_lru_cache<int, int, phmap::Hash<int>, phmap::EqualTo<int>,
+                              phmap::priv::Allocator<phmap::priv::Pair<const int, clock_entry<int>>>,
+                              0> c(10);
+    for (int i = 0; i < 10; ++i)
+        c.put(i, i);
+
+    // keep reading key 3 while inserting new keys: it must never be evicted
+    int v;
+    for (int i = 10; i < 200; ++i) {
+        ASSERT_TRUE(c.get(3, v));
+        EXPECT_EQ(v, 3);
+        c.put(i, i);
+    }
+    EXPECT_EQ(c.size(), 10u);
+}
+
+TEST(ParallelLruCache, GetOrCompute) {
+    phmap::parallel_lru_cache<int, std::string> c(1000);
+    int calls = 0;
+    auto fn = [&](int k) { ++calls; return std::to_string(k); };
+
+    EXPECT_EQ(c.get_or_compute(5, fn), "5");
+    EXPECT_EQ(c.get_or_compute(5, fn), "5");
+    EXPECT_EQ(c.get_or_compute(6, fn), "6");
+    EXPECT_EQ(calls, 2);
+
+    auto s = c.stats();
+    EXPECT_EQ(s.hits, 1u);
+    EXPECT_EQ(s.misses, 2u);
+
+    c.reset_stats();
+    EXPECT_EQ(c.stats().hits, 0u);
+
+    c.clear();
+    EXPECT_TRUE(c.empty());
+    EXPECT_EQ(c.get_or_compute(5, fn), "5");
+    EXPECT_EQ(calls, 3);
+}
+
+TEST(ParallelLruCache, Concurrent) {
+    static constexpr int kThreads = 8;
+    static constexpr int kIters   = 20000;
+
+    phmap::parallel_lru_cache<int, int> c(500);
+    std::atomic<int> computed{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&c, &computed, t]() {
+            for (int i = 0; i < kIters; ++i) {
+                int k = (i * 7 + t) % 2000;
+                int v = c.get_or_compute(k, [&](int key) { ++computed; return key * 2; });
+                EXPECT_EQ(v, k * 2);
+                if (i % 16 == 0)
+                    c.put(k + 5000, k);
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+
+    EXPECT_LE(c.size(), c.capacity());
+    auto s = c.stats();
+    EXPECT_EQ(s.hits + s.misses, size_t(kThreads * kIters));
+    EXPECT_EQ(s.misses, size_t(computed.load()));
+    EXPECT_GT(s.evictions, 0u);
+}
+
+}  // namespace
+}  // namespace priv
+}  // namespace phmap
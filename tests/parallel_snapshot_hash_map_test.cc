@@ -0,0 +1,110 @@
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "parallel_hashmap/phmap_snapshot.h"
+#include "parallel_hashmap/phmap_dump.h"
+
+namespace phmap {
+namespace priv {
+namespace {
+
+using Map = phmap::parallel_snapshot_flat_hash_map<int, int>;
+
+TEST(ParallelSnapshotHashMap, PointInTime) {
+    Map m;
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_TRUE(m.try_emplace(i, i));
+
+    auto s1 = m.snapshot();
+    EXPECT_TRUE(m.insert_or_assign(1000, 1000));
+    EXPECT_FALSE(m.insert_or_assign(0, -1));
+    EXPECT_EQ(m.erase(1), 1u);
+    EXPECT_TRUE(m.modify_if(2, [](Map::value_type& v) { v.second = -2; }));
+    auto s2 = m.snapshot();
+    m.clear();
+
+    EXPECT_EQ(s1.size(), 1000u);
+    EXPECT_FALSE(s1.contains(1000));
+    EXPECT_TRUE(s1.contains(1));
+    int v = 0;
+    EXPECT_TRUE(s1.if_contains(0, [&](const Map::value_type& p) { v = p.second; }));
+    EXPECT_EQ(v, 0);
+    EXPECT_TRUE(s1.if_contains(2, [&](const Map::value_type& p) { v = p.second; }));
+    EXPECT_EQ(v, 2);
+
+    EXPECT_EQ(s2.size(), 1000u);
+    EXPECT_TRUE(s2.contains(1000));
+    EXPECT_FALSE(s2.contains(1));
+    EXPECT_TRUE(s2.if_contains(2, [&](const Map::value_type& p) { v = p.second; }));
+    EXPECT_EQ(v, -2);
+
+    long long sum = 0;
+    s1.for_each([&](const Map::value_type& p) { sum += p.second; });
+    EXPECT_EQ(sum, 999 * 1000 / 2);
+
+    EXPECT_TRUE(m.empty());
+    auto s3 = m.snapshot();
+    EXPECT_TRUE(s3.empty());
+}
+
+TEST(ParallelSnapshotHashMap, DumpLoad) {
+    Map m;
+    for (int i = 0; i < 100; ++i)
+        m.try_emplace(i, 2 * i);
+    auto s = m.snapshot();
+    for (int i = 0; i < 50; ++i)
+        m.erase(i);
+
+    char path[] = "./snapshot_test.bin";
+    {
+        phmap::BinaryOutputArchive ar_out(path);
+        EXPECT_TRUE(s.phmap_dump(ar_out));
+    }
+    phmap::parallel_flat_hash_map<int, int> loaded;
+    {
+        phmap::BinaryInputArchive ar_in(path);
+        EXPECT_TRUE(loaded.phmap_load(ar_in));
+    }
+    std::remove(path);
+    EXPECT_EQ(loaded.size(), 100u);
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ(loaded[i], 2 * i);
+}
+
+// a single writer inserts keys in increasing order, so any consistent
+// snapshot holds exactly the keys [0, size)
+TEST(ParallelSnapshotHashMap, ConsistentUnderConcurrentWrites) {
+    Map m;
+    const int n = 20000;
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+        for (int i = 0; i < n; ++i) {
+            m.try_emplace(i, i);
+            if (i % 7 == 0)
+                m.insert_or_assign(i / 2, -1);   // updates don't change the key set
+            if (i % 100 == 0)
+                std::this_thread::yield();       // let the reader interleave
+        }
+        done = true;
+    });
+
+    size_t num_snapshots = 0;
+    while (!done || num_snapshots == 0) {
+        auto s = m.snapshot();
+        size_t sz = s.size();
+        int max_key = -1;
+        s.for_each([&](const Map::value_type& p) { max_key = (std::max)(max_key, p.first); });
+        EXPECT_EQ(max_key + 1, (int)sz);
+        ++num_snapshots;
+    }
+    writer.join();
+    EXPECT_EQ(m.size(), (size_t)n);
+}
+
+}  // namespace
+}  // namespace priv
+}  // namespace phmap
@@ -49,6 +49,14 @@ struct RawHashSetTestOnlyAccess {
   static auto GetSlots(const C& c) -> decltype(c.slots_) {
     return c.slots_;
   }
+
+  template <typename C>
+  static size_t CountDeleted(const C& c) {
+    size_t n = 0;
+    for (size_t i = 0; i != c.capacity_; ++i)
+      n += IsDeleted(c.ctrl_[i]);
+    return n;
+  }
 };
 
 namespace {
@@ -139,6 +147,9 @@ TEST(BitMask, WithShift) {
 
   BitMask<uint64_t, 8, 3> b(mask);
   EXPECT_EQ(*b, 2u);
+
+  // one nibble per slot, as built by the NEON version of Group
+  EXPECT_THAT((BitMask<uint64_t, 16, 2>(0x0000000000880800)), ElementsAre(2, 4, 5));
 }
 
 TEST(BitMask, LeadingTrailing) {
@@ -159,12 +170,34 @@ TEST(BitMask, LeadingTrailing) {
 
   EXPECT_EQ((BitMask<uint64_t, 8, 3>(0x8000000000000000).LeadingZeros()), 0u);
   EXPECT_EQ((BitMask<uint64_t, 8, 3>(0x8000000000000000).TrailingZeros()), 7u);
+
+  EXPECT_EQ((BitMask<uint64_t, 16, 2>(0x0000000000880800).LeadingZeros()), 10u);
+  EXPECT_EQ((BitMask<uint64_t, 16, 2>(0x0000000000880800).TrailingZeros()), 2u);
+
+  EXPECT_EQ((BitMask<uint64_t, 16, 2>(0x0000000000000008).LeadingZeros()), 15u);
+  EXPECT_EQ((BitMask<uint64_t, 16, 2>(0x0000000000000008).TrailingZeros()), 0u);
+
+  EXPECT_EQ((BitMask<uint64_t, 16, 2>(0x8000000000000000).LeadingZeros()), 0u);
+  EXPECT_EQ((BitMask<uint64_t, 16, 2>(0x8000000000000000).TrailingZeros()), 15u);
 }
 
 TEST(Group, EmptyGroup) {
    for (h2_t h = 0; h != 128; ++h) EXPECT_FALSE(Group{EmptyGroup<std::true_type>()}.Match(h));
 }
 
+// 0, 1, ..., 63 with a few special bytes, for 64 wide groups
+std::vector<ctrl_t> Group64Example() {
+  std::vector<ctrl_t> group(64);
+  for (size_t i = 0; i != group.size(); ++i) group[i] = static_cast<ctrl_t>(i);
+  group[5] = kEmpty;
+  group[17] = kDeleted;
+  group[40] = kEmpty;
+  group[50] = 3;
+  group[62] = 3;
+  group[63] = kSentinel;
+  return group;
+}
+
 TEST(Group, Match) {
   PHMAP_IF_CONSTEXPR (Group::kWidth == 16) {
     ctrl_t group[] = {kEmpty, 1, kDeleted, 3, kEmpty, 5, kSentinel, 7,
@@ -179,6 +212,12 @@ TEST(Group, Match) {
     EXPECT_THAT(Group{group}.Match(0), ElementsAre());
     EXPECT_THAT(Group{group}.Match(1), ElementsAre(1, 5, 7));
     EXPECT_THAT(Group{group}.Match(2), ElementsAre(2, 4));
+  } else PHMAP_IF_CONSTEXPR (Group::kWidth == 64) {
+    auto group = Group64Example();
+    EXPECT_THAT(Group{group.data()}.Match(0), ElementsAre(0));
+    EXPECT_THAT(Group{group.data()}.Match(3), ElementsAre(3, 50, 62));
+    EXPECT_THAT(Group{group.data()}.Match(5), ElementsAre());
+    EXPECT_THAT(Group{group.data()}.Match(61), ElementsAre(61));
   } else {
     FAIL() << "No test coverage for Group::kWidth==" << Group::kWidth;
   }
@@ -192,6 +231,8 @@ TEST(Group, MatchEmpty) {
   } else PHMAP_IF_CONSTEXPR (Group::kWidth == 8) {
     ctrl_t group[] = {kEmpty, 1, 2, kDeleted, 2, 1, kSentinel, 1};
     EXPECT_THAT(Group{group}.MatchEmpty(), ElementsAre(0));
+  } else PHMAP_IF_CONSTEXPR (Group::kWidth == 64) {
+    EXPECT_THAT(Group{Group64Example().data()}.MatchEmpty(), ElementsAre(5, 40));
   } else {
     FAIL() << "No test coverage for Group::kWidth==" << Group::kWidth;
   }
@@ -205,6 +246,8 @@ TEST(Group, MatchEmptyOrDeleted) {
   } else PHMAP_IF_CONSTEXPR (Group::kWidth == 8) {
     ctrl_t group[] = {kEmpty, 1, 2, kDeleted, 2, 1, kSentinel, 1};
     EXPECT_THAT(Group{group}.MatchEmptyOrDeleted(), ElementsAre(0, 3));
+  } else PHMAP_IF_CONSTEXPR (Group::kWidth == 64) {
+    EXPECT_THAT(Group{Group64Example().data()}.MatchEmptyOrDeleted(), ElementsAre(5, 17, 40));
   } else {
     FAIL() << "No test coverage for Group::kWidth==" << Group::kWidth;
   }
@@ -1552,6 +1595,42 @@ TEST(Table, ReplacingDeletedSlotDoesNotRehash) {
   EXPECT_EQ(c, t.bucket_count()) << "rehashing threshold = " << n;
 }
 
+TEST(Table, TombstonesAndCompact) {
+  IntTable t;
+  EXPECT_EQ(0, t.tombstones());
+  t.compact();
+
+  // random erase/insert churn at a constant size leaves tombstones until the
+  // table is rehashed, into a twice larger one at this load factor.
+  std::vector<int64_t> keys;
+  int64_t i = 0;
+  for (; i < 26000; ++i) {
+    t.emplace(i);
+    keys.push_back(i);
+  }
+  const size_t capacity = t.capacity();
+  std::mt19937_64 gen(7);
+  size_t max_tombstones = 0;
+  for (; i < 200000; ++i) {
+    auto& k = keys[gen() % keys.size()];
+    ASSERT_EQ(1, t.erase(k));
+    k = i;
+    t.emplace(i);
+    max_tombstones = (std::max)(max_tombstones, t.tombstones());
+    if (t.tombstones() > 500) {
+      EXPECT_EQ(t.tombstones(), RawHashSetTestOnlyAccess::CountDeleted(t));
+      t.compact();
+      EXPECT_EQ(0, t.tombstones());
+      EXPECT_EQ(0, RawHashSetTestOnlyAccess::CountDeleted(t));
+    }
+  }
+  EXPECT_GT(max_tombstones, 500);
+  EXPECT_EQ(capacity, t.capacity());
+  EXPECT_EQ(keys.size(), t.size());
+  for (auto k : keys)
+    ASSERT_TRUE(t.find(k) != t.end()) << k;
+}
+
 #if PHMAP_HAVE_STD_STRING_VIEW
 TEST(Table, NoThrowMoveConstruct) {
   ASSERT_TRUE(
@@ -0,0 +1,223 @@
+#define PHMAP_SEEDED_HASH 1
+
+#include <cstdint>
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+#include "parallel_hashmap/phmap.h"
+#include "parallel_hashmap/phmap_dump.h"
+
+namespace phmap {
+namespace priv {
+namespace {
+
+TEST(SeededHash, HashDependsOnSeed) {
+    EXPECT_NE(ProcessHashSeed(), 0u);
+
+    phmap::flat_hash_set<uint64_t> s;
+    phmap::parallel_flat_hash_set<uint64_t> ps;
+    size_t num_same = 0;
+    for (uint64_t k = 0; k < 1000; ++k) {
+        size_t unseeded = phmap_mix<sizeof(size_t)>()(phmap::Hash<uint64_t>()(k));
+        num_same += (s.hash(k) == unseeded);
+        EXPECT_EQ(s.hash(k), ps.hash(k));
+    }
+    EXPECT_LT(num_same, 10u);
+
+    for (uint64_t k = 0; k < 10000; ++k) {
+        s.insert(k);
+        ps.insert(k);
+    }
+    for (uint64_t k = 0; k < 10000; k += 2) {
+        EXPECT_EQ(s.erase(k), 1u);
+        EXPECT_EQ(ps.erase(k), 1u);
+    }
+    EXPECT_EQ(s.size(), 5000u);
+    EXPECT_EQ(ps.size(), 5000u);
+    for (uint64_t k = 0; k < 10000; ++k) {
+        EXPECT_EQ(s.count(k), k & 1);
+        EXPECT_EQ(ps.count(k), k & 1);
+    }
+}
+
+template <class Map>
+void DumpLoadWithSeeds(size_t dump_seed, size_t load_seed) {
+    const size_t process_seed = ProcessHashSeed();
+    std::stringstream ss;
+    {
+        ProcessHashSeed() = dump_seed;
+        Map m;
+        for (uint32_t k = 0; k < 5000; ++k)
+            m.emplace(k, k * 3);
+        phmap::BinaryOutputArchive ar_out(ss);
+        EXPECT_TRUE(m.phmap_dump(ar_out));
+    }
+    {
+        ProcessHashSeed() = load_seed;
+        Map m;
+        phmap::BinaryInputArchive ar_in(ss);
+        EXPECT_TRUE(m.phmap_load(ar_in));
+        EXPECT_EQ(m.size(), 5000u);
+        for (uint32_t k = 0; k < 5000; ++k) {
+            auto it = m.find(k);
+            ASSERT_TRUE(it != m.end()) << k;
+            EXPECT_EQ(it->second, k * 3);
+        }
+        m.emplace(5000, 0);
+        EXPECT_EQ(m.size(), 5001u);
+    }
+    ProcessHashSeed() = process_seed;
+}
+
+TEST(SeededHash, DumpLoadSameSeed) {
+    DumpLoadWithSeeds<phmap::flat_hash_map<uint32_t, uint32_t>>(17, 17);
+    DumpLoadWithSeeds<phmap::parallel_flat_hash_map<uint32_t, uint32_t>>(17, 17);
+}
+
+// the dump is rehashed when loaded by a process with another seed
+TEST(SeededHash, DumpLoadOtherSeed) {
+    DumpLoadWithSeeds<phmap::flat_hash_map<uint32_t, uint32_t>>(17, 0x9e3779b97f4a7c15ULL);
+    DumpLoadWithSeeds<phmap::cached_hash_flat_hash_map<uint32_t, uint32_t>>(17, 0x9e3779b97f4a7c15ULL);
+    DumpLoadWithSeeds<phmap::parallel_flat_hash_map<uint32_t, uint32_t>>(17, 0x9e3779b97f4a7c15ULL);
+}
+
+// dumps from unseeded builds (seed 0) can be loaded
+TEST(SeededHash, DumpLoadUnseeded) {
+    DumpLoadWithSeeds<phmap::flat_hash_map<uint32_t, uint32_t>>(0, 17);
+    DumpLoadWithSeeds<phmap::parallel_flat_hash_map<uint32_t, uint32_t>>(0, 17);
+}
+
+// tables created before and after a change of seed can be moved, swapped
+// and copied into each other
+template <class Map>
+void MoveSwapAcrossSeeds() {
+    const size_t process_seed = ProcessHashSeed();
+    auto check = [](const Map& m, uint32_t first) {
+        EXPECT_EQ(m.size(), 1000u);
+        for (uint32_t k = first; k < first + 1000; ++k) {
+            auto it = m.find(k);
+            ASSERT_TRUE(it != m.end()) << k;
+            EXPECT_EQ(it->second, k * 3);
+        }
+    };
+    auto fill = [](Map& m, uint32_t first) {
+        for (uint32_t k = first; k < first + 1000; ++k)
+            m.emplace(k, k * 3);
+    };
+
+    ProcessHashSeed() = 17;
+    Map a;
+    fill(a, 0);
+    ProcessHashSeed() = 0x9e3779b97f4a7c15ULL;
+    Map b;
+    fill(b, 1000);
+
+    a.swap(b);
+    check(a, 1000);
+    check(b, 0);
+
+    Map c(std::move(a));
+    check(c, 1000);
+    b = std::move(c);
+    check(b, 1000);
+
+    ProcessHashSeed() = 23;
+    Map d(b);
+    check(d, 1000);
+    Map e;
+    e = d;
+    check(e, 1000);
+    e.emplace(5000, 15000);
+    EXPECT_EQ(e.size(), 1001u);
+
+    ProcessHashSeed() = process_seed;
+}
+
+TEST(SeededHash, MoveSwapAcrossSeeds) {
+    MoveSwapAcrossSeeds<phmap::flat_hash_map<uint32_t, uint32_t>>();
+    MoveSwapAcrossSeeds<phmap::cached_hash_flat_hash_map<uint32_t, uint32_t>>();
+    MoveSwapAcrossSeeds<phmap::parallel_flat_hash_map<uint32_t, uint32_t>>();
+}
+
+// loading into a table created before a change of seed
+TEST(SeededHash, LoadIntoOlderTable) {
+    const size_t process_seed = ProcessHashSeed();
+    ProcessHashSeed() = 5;
+    phmap::flat_hash_map<uint32_t, uint32_t> m;
+    std::stringstream ss;
+    {
+        ProcessHashSeed() = 17;
+        phmap::flat_hash_map<uint32_t, uint32_t> src;
+        for (uint32_t k = 0; k < 1000; ++k)
+            src.emplace(k, k * 3);
+        phmap::BinaryOutputArchive ar_out(ss);
+        EXPECT_TRUE(src.phmap_dump(ar_out));
+    }
+    ProcessHashSeed() = 0x9e3779b97f4a7c15ULL;
+    phmap::BinaryInputArchive ar_in(ss);
+    EXPECT_TRUE(m.phmap_load(ar_in));
+    EXPECT_EQ(m.size(), 1000u);
+    for (uint32_t k = 0; k < 1000; ++k)
+        EXPECT_EQ(m.count(k), 1u) << k;
+    ProcessHashSeed() = process_seed;
+}
+
+// merge, set algebra and == between parallel containers created before and
+// after a change of seed, whose keys are in different submaps
+TEST(SeededHash, ParallelOpsAcrossSeeds) {
+    using Set = phmap::parallel_flat_hash_set<uint32_t>;
+    const size_t process_seed = ProcessHashSeed();
+    auto make = [](size_t seed, uint32_t first, uint32_t last) {
+        ProcessHashSeed() = seed;
+        Set s;
+        for (uint32_t k = first; k < last; ++k)
+            s.insert(k);
+        return s;
+    };
+    auto check = [](const Set& s, uint32_t first, uint32_t last) {
+        EXPECT_EQ(s.size(), size_t(last - first));
+        for (uint32_t k = first; k < last; ++k)
+            EXPECT_EQ(s.count(k), 1u) << k;
+    };
+    const size_t seed_a = 17, seed_b = 0x9e3779b97f4a7c15ULL;
+
+    Set a = make(seed_a, 0, 1000);
+    Set b = make(seed_b, 500, 1500);
+    EXPECT_NE(a.hash(1), b.hash(1));
+    a.set_union(b);
+    check(a, 0, 1500);
+
+    a = make(seed_a, 0, 1000);
+    a.set_intersection(b);
+    check(a, 500, 1000);
+
+    a = make(seed_a, 0, 1000);
+    a.set_difference(b);
+    check(a, 0, 500);
+
+    a = make(seed_a, 0, 1000);
+    Set src = make(seed_b, 500, 1500);
+    a.merge(src);
+    check(a, 0, 1500);
+    check(src, 500, 1000);   // already in a
+
+    a = make(seed_a, 0, 1000);
+    src = make(seed_b, 500, 1500);
+    a.parallel_merge(src);
+    check(a, 0, 1500);
+    check(src, 500, 1000);
+
+    a = make(seed_a, 0, 1000);
+    b = make(seed_b, 0, 1000);
+    EXPECT_TRUE(a == b);
+    b.erase(3);
+    b.insert(5000);
+    EXPECT_FALSE(a == b);
+
+    ProcessHashSeed() = process_seed;
+}
+
+}  // namespace
+}  // namespace priv
+}  // namespace phmap
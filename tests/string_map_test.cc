@@ -0,0 +1,195 @@
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "parallel_hashmap/phmap_string.h"
+
+namespace phmap {
+namespace priv {
+namespace {
+
+TEST(StringInterner, Basic) {
+    phmap::string_interner words;
+    EXPECT_TRUE(words.empty());
+    EXPECT_EQ(words.find("abc").data(), nullptr);
+
+    std::string s = "abc";
+    std::string_view a = words.intern(s);
+    EXPECT_EQ(a, "abc");
+    EXPECT_NE(a.data(), s.data());
+    EXPECT_EQ(words.intern("abc").data(), a.data());
+    EXPECT_EQ(words.intern(std::string_view("xabcx").substr(1, 3)).data(), a.data());
+    EXPECT_EQ(words.find("abc").data(), a.data());
+    EXPECT_TRUE(words.contains("abc"));
+    EXPECT_FALSE(words.contains("ab"));
+
+    auto res = words.insert("abd");
+    EXPECT_TRUE(res.second);
+    EXPECT_FALSE(words.insert("abd").second);
+    EXPECT_EQ(words.size(), 2u);
+    EXPECT_STREQ(res.first.data(), "abd");   // followed by a '\0'
+
+    // the empty string has its own address too
+    std::string_view e = words.intern("");
+    EXPECT_TRUE(e.empty());
+    EXPECT_NE(e.data(), nullptr);
+    EXPECT_TRUE(words.contains(""));
+    EXPECT_EQ(words.size(), 3u);
+
+    size_t n = 0;
+    for (std::string_view w : words)
+        n += w.size();
+    EXPECT_EQ(n, 6u);
+
+    words.clear();
+    EXPECT_TRUE(words.empty());
+    EXPECT_EQ(words.key_bytes(), 0u);
+    EXPECT_FALSE(words.contains("abc"));
+}
+
+// the views don't move when the table grows, including for keys larger
+// than the chunks
+TEST(StringInterner, Stability) {
+    phmap::string_interner words;
+    std::vector<std::string_view> views;
+    for (int i = 0; i < 100000; ++i)
+        views.push_back(words.intern("key_" + std::to_string(i)));
+    std::string big(100000, 'x');
+    std::string_view big_view = words.intern(big);
+
+    EXPECT_EQ(words.size(), 100001u);
+    for (int i = 0; i < 100000; ++i) {
+        ASSERT_EQ(views[i], "key_" + std::to_string(i));
+        ASSERT_EQ(words.intern("key_" + std::to_string(i)).data(), views[i].data());
+    }
+    EXPECT_EQ(big_view, big);
+    EXPECT_GE(words.key_bytes_reserved(), words.key_bytes());
+}
+
+TEST(FlatStringMap, Basic) {
+    phmap::flat_string_map<int> m;
+    EXPECT_TRUE(m.empty());
+    EXPECT_TRUE(m.begin() == m.end());
+    EXPECT_TRUE(m.find("a") == m.end());
+
+    EXPECT_TRUE(m.insert({"a", 1}).second);
+    EXPECT_TRUE(m.emplace("b", 2).second);
+    EXPECT_FALSE(m.emplace("b", 3).second);
+    EXPECT_TRUE(m.try_emplace(std::string("c"), 3).second);
+    EXPECT_FALSE(m.try_emplace("c", 4).second);
+    m["d"] = 4;
+    EXPECT_FALSE(m.insert_or_assign("a", 10).second);
+
+    EXPECT_EQ(m.size(), 4u);
+    EXPECT_EQ(m.at("a"), 10);
+    EXPECT_EQ(m["b"], 2);
+    EXPECT_EQ(m.count(std::string("c")), 1u);
+    EXPECT_FALSE(m.contains("e"));
+#ifdef PHMAP_HAVE_EXCEPTIONS
+    EXPECT_THROW(m.at("e"), std::out_of_range);
+#endif
+
+    int sum = 0;
+    for (auto& p : m)
+        sum += p.second;
+    EXPECT_EQ(sum, 19);
+
+    const auto& cm = m;
+    auto it = cm.find("d");
+    ASSERT_TRUE(it != cm.end());
+    EXPECT_EQ(it->first, "d");
+
+    EXPECT_EQ(m.erase("a"), 1u);
+    EXPECT_EQ(m.erase("a"), 0u);
+    EXPECT_EQ(m.size(), 3u);
+
+    m.clear();
+    EXPECT_TRUE(m.empty());
+    m["x"] = 1;
+    EXPECT_EQ(m.size(), 1u);
+}
+
+// keys which only differ after the stored prefix, or by their length
+TEST(FlatStringMap, SamePrefix) {
+    phmap::flat_string_map<int> m;
+    const char* keys[] = {"abcdefgh", "abcdefgh1", "abcdefgh2", "abcdefghij1", "abc",
+                          "abcdefg", ""};
+    int i = 0;
+    for (const char* k : keys)
+        EXPECT_TRUE(m.try_emplace(k, i++).second) << k;
+    m.try_emplace(std::string_view("abc\0", 4), i);
+    EXPECT_EQ(m.size(), 8u);
+
+    i = 0;
+    for (const char* k : keys)
+        EXPECT_EQ(m.at(k), i++) << k;
+    EXPECT_EQ(m.at(std::string_view("abc\0", 4)), i);
+    EXPECT_FALSE(m.contains("abcdefgh3"));
+    EXPECT_FALSE(m.contains("abcdefghij2"));
+}
+
+TEST(FlatStringMap, GrowAndErase) {
+    phmap::flat_string_map<size_t> m;
+    for (size_t i = 0; i < 50000; ++i)
+        m[std::to_string(i) + "_a_longer_suffix"] = i;
+    for (size_t i = 0; i < 50000; i += 2)
+        EXPECT_EQ(m.erase(std::to_string(i) + "_a_longer_suffix"), 1u);
+    EXPECT_EQ(m.size(), 25000u);
+    for (size_t i = 0; i < 50000; ++i) {
+        auto it = m.find(std::to_string(i) + "_a_longer_suffix");
+        if (i & 1) {
+            ASSERT_TRUE(it != m.end()) << i;
+            EXPECT_EQ(it->second, i);
+        } else {
+            EXPECT_TRUE(it == m.end()) << i;
+        }
+    }
+
+    // erasing while iterating
+    for (auto it = m.begin(); it != m.end();) {
+        if (it->second % 3 == 0)
+            it = m.erase(it);
+        else
+            ++it;
+    }
+    for (const auto& p : m)
+        EXPECT_NE(p.second % 3, 0u);
+}
+
+TEST(FlatStringMap, CopyAndMove) {
+    phmap::flat_string_map<std::string> m;
+    for (int i = 0; i < 1000; ++i)
+        m[std::to_string(i)] = std::string(20, char('a' + i % 26));
+
+    phmap::flat_string_map<std::string> c(m);
+    EXPECT_TRUE(c == m);
+    EXPECT_NE(c.find("7")->first.data(), m.find("7")->first.data());   // own copy of the keys
+    c["7"] = "changed";
+    EXPECT_TRUE(c != m);
+
+    phmap::flat_string_map<std::string> mv(std::move(c));
+    EXPECT_EQ(mv.size(), 1000u);
+    EXPECT_EQ(mv["7"], "changed");
+
+    c = m;
+    EXPECT_TRUE(c == m);
+    swap(c, mv);
+    EXPECT_EQ(c["7"], "changed");
+}
+
+TEST(FlatStringMap, MoveOnlyValues) {
+    phmap::flat_string_map<std::unique_ptr<int>> m;
+    for (int i = 0; i < 1000; ++i)
+        m.try_emplace(std::to_string(i), new int(i));
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_EQ(*m.at(std::to_string(i)), i);
+}
+
+}  // namespace
+}  // namespace priv
+}  // namespace phmap